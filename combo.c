@@ -0,0 +1,55 @@
+#include "combo.h"
+#include "report_stream.h"
+
+static uint16_t pressed_keys;
+// Combos that fired and wait for one of their keys to be released
+static uint16_t fired_combos;
+static uint16_t press_times[COMBO_KEYS_MAX];
+
+static int8_t find_combo_key(uint16_t keycode) {
+  for (uint8_t i = 0; i < combo_key_count; i++) {
+    if (pgm_read_word(&combo_keys[i]) == keycode) return i;
+  }
+  return -1;
+}
+
+// Time from the first to the last key of the chord, which is down now
+static bool within_term(uint16_t keys, uint16_t now, uint16_t term) {
+  for (uint8_t i = 0; i < combo_key_count; i++) {
+    if ((keys & COMBO_BIT(i)) && (uint16_t)(now - press_times[i]) > term) return false;
+  }
+  return true;
+}
+
+void process_combo(uint16_t keycode, keyrecord_t *record) {
+  int8_t index = find_combo_key(keycode);
+
+  if (index < 0) {
+    return;
+  }
+
+  if (!record->event.pressed) {
+    pressed_keys &= ~COMBO_BIT(index);
+    for (uint8_t c = 0; c < combo_count; c++) {
+      if (pgm_read_word(&combos[c].keys) & COMBO_BIT(index)) fired_combos &= ~(1 << c);
+    }
+    return;
+  }
+
+  pressed_keys |= COMBO_BIT(index);
+  press_times[index] = record->event.time;
+
+  for (uint8_t c = 0; c < combo_count; c++) {
+    uint16_t keys = pgm_read_word(&combos[c].keys);
+    uint16_t term = pgm_read_word(&combos[c].term);
+
+    if (!(keys & COMBO_BIT(index)) || (pressed_keys & keys) != keys || (fired_combos & (1 << c))) {
+      continue;
+    }
+    if (term && !within_term(keys, record->event.time, term)) {
+      continue;
+    }
+    fired_combos |= (1 << c);
+    send_keycode_tap(pgm_read_word(&combos[c].keycode));
+  }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "quantum.h"
+
+// Chords of keys that tap a keycode once all of them are down. Keys that
+// take part in a chord are listed in combo_keys[]; a chord is the bitset of
+// their indices. Pressed chord keys are tracked in a bitset as well, so an
+// event costs one look up of its keycode and one mask test per chord.
+//
+// The keys keep doing what they do on their own. A chord fires once when
+// its last key goes down, and again only after one of its keys was released.
+//
+// The bitsets are 16 bits wide: combo_keys[] and combos[] hold at most
+// COMBO_KEYS_MAX and COMBOS_MAX entries, COMBO_CHECK_TABLES() makes sure.
+#define COMBO_KEYS_MAX  16
+#define COMBOS_MAX      16
+#define COMBO_BIT(index) (1 << (index))
+
+// Put after the keymap's tables
+#define COMBO_CHECK_TABLES() \
+  _Static_assert(sizeof(combo_keys) / sizeof(combo_keys[0]) <= COMBO_KEYS_MAX, "combo_keys[] has too many keys"); \
+  _Static_assert(sizeof(combos) / sizeof(combos[0]) <= COMBOS_MAX, "combos[] has too many chords")
+
+typedef struct {
+  uint16_t keys;        // COMBO_BIT()s of combo_keys[]
+  uint16_t keycode;     // basic or mod-wrapped keycode to tap
+  uint16_t term;        // ms between the first and the last key, 0 for no limit
+} combo_t;
+
+// Defined by the keymap, in PROGMEM
+extern const uint16_t combo_keys[];
+extern const uint8_t combo_key_count;
+extern const combo_t combos[];
+extern const uint8_t combo_count;
+
+// Run in process_record_user, after any engine that holds events back.
+// Never consumes the event.
+void process_combo(uint16_t keycode, keyrecord_t *record);
@@ -0,0 +1,138 @@
+#include "compose.h"
+
+// Windows-1252 characters 0x80 .. 0x9F
+static const uint16_t PROGMEM cp1252_high[32] = {
+  0x20AC, 0,      0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+  0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0,      0x017D, 0,
+  0,      0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+  0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0,      0x017E, 0x0178,
+};
+
+static void stream_add(report_stream_t *stream, uint8_t modifiers, uint8_t key) {
+  if (stream->length == REPORT_STREAM_MAX) {
+    return;
+  }
+  stream->reports[stream->length][0] = modifiers;
+  stream->reports[stream->length][1] = key;
+  stream->length++;
+}
+
+// Press a key that is held with the keys before it. A key pressed twice in
+// a row needs a report without it in between, the host only sees newly
+// pressed keys.
+static void stream_press(report_stream_t *stream, uint8_t modifiers, uint8_t key) {
+  if (stream->length && stream->reports[stream->length - 1][1] == key) {
+    stream_add(stream, modifiers, KC_NO);
+  }
+  stream_add(stream, modifiers, key);
+}
+
+static void stream_tap(report_stream_t *stream, uint8_t modifiers, uint8_t key, bool modifiers_first) {
+  if (modifiers && modifiers_first) {
+    stream_add(stream, modifiers, KC_NO);
+  }
+  stream_add(stream, modifiers, key);
+  stream_add(stream, 0, KC_NO);
+}
+
+static uint8_t hex_key(uint8_t digit) {
+  if (digit == 0) return KC_0;
+  return digit < 10 ? KC_1 + digit - 1 : KC_A + digit - 10;
+}
+
+static uint8_t keypad_key(uint8_t digit) {
+  return digit == 0 ? KC_KP_0 : KC_KP_1 + digit - 1;
+}
+
+static uint8_t cp1252(uint16_t codepoint) {
+  if (codepoint >= 0xA0 && codepoint <= 0xFF) {
+    return codepoint;
+  }
+  for (uint8_t i = 0; i < 32; i++) {
+    if (pgm_read_word(&cp1252_high[i]) == codepoint) return 0x80 + i;
+  }
+  return 0;
+}
+
+static void hex_stream(uint8_t hex, uint16_t codepoint, report_stream_t *stream) {
+  switch (hex) {
+    case HEX_OPTION:
+      // Option held over all four digits
+      stream_add(stream, RS_ALT, KC_NO);
+      for (int8_t shift = 12; shift >= 0; shift -= 4) {
+        stream_press(stream, RS_ALT, hex_key((codepoint >> shift) & 0xF));
+      }
+      stream_add(stream, 0, KC_NO);
+      break;
+    case HEX_CTRL_SHIFT_U: {
+      bool leading = true;
+
+      stream_add(stream, MOD_BIT(KC_LCTRL) | RS_SHIFT, KC_U);
+      for (int8_t shift = 12; shift >= 0; shift -= 4) {
+        uint8_t digit = (codepoint >> shift) & 0xF;
+
+        if (leading && digit == 0 && shift) continue;
+        leading = false;
+        stream_press(stream, 0, hex_key(digit));
+      }
+      stream_tap(stream, 0, KC_SPACE, false);
+      break;
+    }
+    case HEX_ALT_NUMPAD: {
+      uint8_t code = cp1252(codepoint);
+
+      if (!code) return;
+      stream_add(stream, RS_ALT, KC_NO);
+      stream_press(stream, RS_ALT, KC_KP_0);
+      stream_press(stream, RS_ALT, keypad_key(code / 100));
+      stream_press(stream, RS_ALT, keypad_key(code / 10 % 10));
+      stream_press(stream, RS_ALT, keypad_key(code % 10));
+      stream_add(stream, 0, KC_NO);
+      break;
+    }
+  }
+}
+
+void compose_stream(const host_profile_t *profile, uint16_t form, uint16_t codepoint, report_stream_t *stream) {
+  uint8_t prefix = form >> COMPOSE_PREFIX_OFFSET;
+  uint8_t modifiers = ((form & COMPOSE_SHIFT) ? RS_SHIFT : 0) |
+                      ((form & COMPOSE_OPTION) ? pgm_read_byte(&profile->option) : 0);
+
+  stream->length = 0;
+  if (form == COMPOSE_NONE) {
+    return;
+  }
+  if (form == COMPOSE_HEX) {
+    hex_stream(pgm_read_byte(&profile->hex), codepoint, stream);
+    return;
+  }
+  if (prefix && prefix <= HOST_PREFIXES) {
+    bool modifiers_first = pgm_read_byte(&profile->modifiers_first);
+
+    for (uint8_t i = 0; i < HOST_PREFIX_TAPS; i++) {
+      uint8_t key = pgm_read_byte(&profile->prefixes[prefix - 1][i][1]);
+
+      if (key == KC_NO) break;
+      stream_tap(stream, pgm_read_byte(&profile->prefixes[prefix - 1][i][0]), key, modifiers_first);
+    }
+  }
+  stream_tap(stream, modifiers, form & 0xFF, false);
+}
+
+void glyph_stream(uint8_t glyph, bool upper, report_stream_t *stream) {
+  if (glyph >= glyph_count) {
+    stream->length = 0;
+    return;
+  }
+  compose_stream(host_profile, pgm_read_word(&host_glyph_forms[glyph][upper ? 1 : 0]),
+                 pgm_read_word(&glyph_codepoints[glyph][upper ? 1 : 0]), stream);
+}
+
+void emit_glyph(uint8_t glyph, bool upper) {
+  report_stream_t stream;
+
+  glyph_stream(glyph, upper, &stream);
+  if (stream.length) {
+    send_report_stream_ram(&stream, GLYPH_HIDDEN_MODIFIERS);
+  }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "quantum.h"
+#include "report_stream.h"
+#include "host_profile.h"
+
+// Characters outside the base layer of the U.S. layout, typed for the active
+// host profile (host_profile.h) as a chord, after a prefix of dead keys or a
+// Compose sequence, or through the hex input of the host.
+//
+// The keymap gives the code point of every glyph, unshifted and shifted.
+// How each code point is typed on a profile is its form, two bytes: the
+// base key with its modifiers and the prefix typed before it. `make -C sim
+// glyphs` plays every candidate form into the host models and keeps the one
+// with the fewest reports in glyph_forms.h.
+#define COMPOSE_SHIFT                   0x0100
+#define COMPOSE_OPTION                  0x0200    // Option, AltGr, see host_profile_t
+#define COMPOSE_PREFIX_OFFSET           12
+// The code point through the hex input of the host
+#define COMPOSE_HEX                     0xF000
+// Not reachable on the host, types nothing
+#define COMPOSE_NONE                    0x0000
+
+// prefix is 1 .. HOST_PREFIXES, an index into host_profile_t.prefixes plus one
+#define COMPOSE_PREFIX(prefix, key)     (((prefix) << COMPOSE_PREFIX_OFFSET) | (key))
+
+// Defined by the keymap, in PROGMEM: unshifted and shifted code point per glyph
+extern const uint16_t glyph_codepoints[][2];
+extern const uint8_t glyph_count;
+
+// Shift is hidden from the host while the reports of a glyph are sent, the
+// form brings its own.
+#define GLYPH_HIDDEN_MODIFIERS          (MOD_BIT(KC_LSHIFT) | MOD_BIT(KC_RSHIFT))
+
+// Queue the reports of a glyph.
+void emit_glyph(uint8_t glyph, bool upper);
+// Report stream of a glyph on the active profile, as emit_glyph sends it
+void glyph_stream(uint8_t glyph, bool upper, report_stream_t *stream);
+// Report stream of a form for a code point on a profile, as emit_glyph
+// sends it
+void compose_stream(const host_profile_t *profile, uint16_t form, uint16_t codepoint, report_stream_t *stream);
@@ -0,0 +1,5 @@
+#pragma once
+
+// Releases resolve on the layer their press did. tap_hold.c reads and sets
+// the source layer cache of QMK, which is only built with this.
+#define PREVENT_STUCK_MODIFIERS
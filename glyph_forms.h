@@ -0,0 +1,436 @@
+// Forms of the glyphs in glyph_codepoints[] in keymap.c per host profile,
+// see compose.h. Generated by `make -C sim glyphs` from the host models in sim/.
+#pragma once
+
+#define GLYPH_FORMS 104
+
+static const uint16_t PROGMEM glyph_forms[HOST_PROFILES][GLYPH_FORMS][2] = {
+  // macOS, ABC Extended
+  {
+    { 0x001e, 0x0325 },  //  0: 1 1 2, ° Opt-* 2
+    { 0x001f, 0x0223 },  //  1: 2 2 2, § Opt-6 2
+    { 0x0020, 0x0000 },  //  2: 3 3 2, ℓ none 0
+    { 0x0021, 0x0331 },  //  3: 4 4 2, » Opt-| 2
+    { 0x0022, 0x0231 },  //  4: 5 5 2, « Opt-\ 2
+    { 0x0023, 0x0121 },  //  5: 6 6 2, $ $ 2
+    { 0x0024, 0x031f },  //  6: 7 7 2, € Opt-@ 2
+    { 0x0025, 0x031a },  //  7: 8 8 2, „ Opt-W 2
+    { 0x0026, 0x022f },  //  8: 9 9 2, “ Opt-[ 2
+    { 0x0027, 0x032f },  //  9: 0 0 2, ” Opt-{ 2
+    { 0x002d, 0x032d },  // 10: - - 2, — Opt-_ 2
+    { 0x0036, 0x022d },  // 11: , , 2, – Opt-- 2
+    { 0x0037, 0x0225 },  // 12: . . 2, • Opt-8 2
+    { 0x0216, 0x0216 },  // 13: ß Opt-s 2, ß Opt-s 2
+    { 0x0000, 0x0000 },  // 14: ¹ none 0, ¹ none 0
+    { 0x0000, 0x0000 },  // 15: ² none 0, ² none 0
+    { 0x0000, 0x0000 },  // 16: ³ none 0, ³ none 0
+    { 0x0321, 0x0321 },  // 17: › Opt-$ 2, › Opt-$ 2
+    { 0x0320, 0x0320 },  // 18: ‹ Opt-# 2, ‹ Opt-# 2
+    { 0x0221, 0x0221 },  // 19: ¢ Opt-4 2, ¢ Opt-4 2
+    { 0x021c, 0x021c },  // 20: ¥ Opt-y 2, ¥ Opt-y 2
+    { 0x0327, 0x0327 },  // 21: ‚ Opt-) 2, ‚ Opt-) 2
+    { 0x0230, 0x0230 },  // 22: ‘ Opt-] 2, ‘ Opt-] 2
+    { 0x0330, 0x0330 },  // 23: ’ Opt-} 2, ’ Opt-} 2
+    { 0x0233, 0x0233 },  // 24: … Opt-; 2, … Opt-; 2
+    { 0x0000, 0x0000 },  // 25: ſ none 0, ſ none 0
+    { 0x0123, 0x0123 },  // 26: ^ ^ 2, ^ ^ 2
+    { 0x0135, 0x0135 },  // 27: ~ ~ 2, ~ ~ 2
+    { 0x0035, 0x0035 },  // 28: ` ` 2, ` ` 2
+    { 0x0134, 0x0134 },  // 29: " " 2, " " 2
+    { 0x0034, 0x0034 },  // 30: ' ' 2, ' ' 2
+    { 0x0226, 0x0226 },  // 31: ª Opt-9 2, ª Opt-9 2
+    { 0x0227, 0x0227 },  // 32: º Opt-0 2, º Opt-0 2
+    { 0x0000, 0x0000 },  // 33: № none 0, № none 0
+    { 0x0326, 0x0326 },  // 34: · Opt-( 2, · Opt-( 2
+    { 0x0220, 0x0220 },  // 35: £ Opt-3 2, £ Opt-3 2
+    { 0x0000, 0x0000 },  // 36: ¤ none 0, ¤ none 0
+    { 0x021e, 0x021e },  // 37: ¡ Opt-1 2, ¡ Opt-1 2
+    { 0x0338, 0x0338 },  // 38: ¿ Opt-? 2, ¿ Opt-? 2
+    { 0x032d, 0x032d },  // 39: — Opt-_ 2, — Opt-_ 2
+    { 0x1004, 0x1104 },  // 40: à Opt-` a 5, À Opt-` A 5
+    { 0x1008, 0x1108 },  // 41: è Opt-` e 5, È Opt-` E 5
+    { 0x100c, 0x110c },  // 42: ì Opt-` i 5, Ì Opt-` I 5
+    { 0x1012, 0x030f },  // 43: ò Opt-` o 5, Ò Opt-L 2
+    { 0x1018, 0x1118 },  // 44: ù Opt-` u 5, Ù Opt-` U 5
+    { 0x2004, 0x031c },  // 45: á Opt-e a 5, Á Opt-Y 2
+    { 0x2008, 0x2108 },  // 46: é Opt-e e 5, É Opt-e E 5
+    { 0x200c, 0x0316 },  // 47: í Opt-e i 5, Í Opt-S 2
+    { 0x2012, 0x030b },  // 48: ó Opt-e o 5, Ó Opt-H 2
+    { 0x2018, 0x0333 },  // 49: ú Opt-e u 5, Ú Opt-: 2
+    { 0x4004, 0x0310 },  // 50: â Opt-i a 5, Â Opt-M 2
+    { 0x4008, 0x4108 },  // 51: ê Opt-i e 5, Ê Opt-i E 5
+    { 0x400c, 0x0307 },  // 52: î Opt-i i 5, Î Opt-D 2
+    { 0x4012, 0x030d },  // 53: ô Opt-i o 5, Ô Opt-J 2
+    { 0x4018, 0x4118 },  // 54: û Opt-i u 5, Û Opt-i U 5
+    { 0x3004, 0x3104 },  // 55: ä Opt-u a 5, Ä Opt-u A 5
+    { 0x3008, 0x3108 },  // 56: ë Opt-u e 5, Ë Opt-u E 5
+    { 0x300c, 0x0309 },  // 57: ï Opt-u i 5, Ï Opt-F 2
+    { 0x3012, 0x3112 },  // 58: ö Opt-u o 5, Ö Opt-u O 5
+    { 0x3018, 0x3118 },  // 59: ü Opt-u u 5, Ü Opt-u U 5
+    { 0x301c, 0x311c },  // 60: ÿ Opt-u y 5, Ÿ Opt-u Y 5
+    { 0x5004, 0x5104 },  // 61: ã Opt-n a 5, Ã Opt-n A 5
+    { 0x5011, 0x5111 },  // 62: ñ Opt-n n 5, Ñ Opt-n N 5
+    { 0x5012, 0x5112 },  // 63: õ Opt-n o 5, Õ Opt-n O 5
+    { 0x0204, 0x0304 },  // 64: å Opt-a 2, Å Opt-A 2
+    { 0x0234, 0x0334 },  // 65: æ Opt-' 2, Æ Opt-" 2
+    { 0x0206, 0x0306 },  // 66: ç Opt-c 2, Ç Opt-C 2
+    { 0x0212, 0x0312 },  // 67: ø Opt-o 2, Ø Opt-O 2
+    { 0x0214, 0x0314 },  // 68: œ Opt-q 2, Œ Opt-Q 2
+    { 0x020f, 0x020f },  // 69: ¬ Opt-l 2, ¬ Opt-l 2
+    { 0x0000, 0x0000 },  // 70: ∨ none 0, ∨ none 0
+    { 0x0000, 0x0000 },  // 71: ∧ none 0, ∧ none 0
+    { 0x0000, 0x0000 },  // 72: ⊥ none 0, ⊥ none 0
+    { 0x0000, 0x0000 },  // 73: ∡ none 0, ∡ none 0
+    { 0x0000, 0x0000 },  // 74: ∥ none 0, ∥ none 0
+    { 0x0000, 0x0000 },  // 75: → none 0, → none 0
+    { 0x0222, 0x0222 },  // 76: ∞ Opt-5 2, ∞ Opt-5 2
+    { 0x0000, 0x0000 },  // 77: ∝ none 0, ∝ none 0
+    { 0x0000, 0x0000 },  // 78: ∅ none 0, ∅ none 0
+    { 0x0219, 0x0219 },  // 79: √ Opt-v 2, √ Opt-v 2
+    { 0x0000, 0x0000 },  // 80: ℂ none 0, ℂ none 0
+    { 0x0000, 0x0000 },  // 81: × none 0, × none 0
+    { 0x0000, 0x0000 },  // 82: ℚ none 0, ℚ none 0
+    { 0x0000, 0x0000 },  // 83: ∘ none 0, ∘ none 0
+    { 0x0000, 0x0000 },  // 84: ⊂ none 0, ⊂ none 0
+    { 0x0205, 0x0205 },  // 85: ∫ Opt-b 2, ∫ Opt-b 2
+    { 0x0000, 0x0000 },  // 86: ∀ none 0, ∀ none 0
+    { 0x0000, 0x0000 },  // 87: ∃ none 0, ∃ none 0
+    { 0x0000, 0x0000 },  // 88: ∈ none 0, ∈ none 0
+    { 0x021a, 0x021a },  // 89: ∑ Opt-w 2, ∑ Opt-w 2
+    { 0x0000, 0x0000 },  // 90: ℕ none 0, ℕ none 0
+    { 0x0000, 0x0000 },  // 91: ℝ none 0, ℝ none 0
+    { 0x0207, 0x0207 },  // 92: ∂ Opt-d 2, ∂ Opt-d 2
+    { 0x020d, 0x020d },  // 93: ∆ Opt-j 2, ∆ Opt-j 2
+    { 0x0000, 0x0000 },  // 94: ∪ none 0, ∪ none 0
+    { 0x0000, 0x0000 },  // 95: ∩ none 0, ∩ none 0
+    { 0x0000, 0x0000 },  // 96: ℵ none 0, ℵ none 0
+    { 0x0313, 0x0313 },  // 97: ∏ Opt-P 2, ∏ Opt-P 2
+    { 0x0000, 0x0000 },  // 98: ℤ none 0, ℤ none 0
+    { 0x0000, 0x0000 },  // 99: ⇐ none 0, ⇐ none 0
+    { 0x0000, 0x0000 },  // 100: ⇔ none 0, ⇔ none 0
+    { 0x0000, 0x0000 },  // 101: ⇒ none 0, ⇒ none 0
+    { 0x0000, 0x0000 },  // 102: ↦ none 0, ↦ none 0
+    { 0x0000, 0x0000 },  // 103: ∇ none 0, ∇ none 0
+  },
+  // macOS, Unicode Hex Input
+  {
+    { 0x001e, 0xf000 },  //  0: 1 1 2, ° hex 7
+    { 0x001f, 0xf000 },  //  1: 2 2 2, § hex 7
+    { 0x0020, 0xf000 },  //  2: 3 3 2, ℓ hex 7
+    { 0x0021, 0x0331 },  //  3: 4 4 2, » Opt-| 2
+    { 0x0022, 0x0231 },  //  4: 5 5 2, « Opt-\ 2
+    { 0x0023, 0x0121 },  //  5: 6 6 2, $ $ 2
+    { 0x0024, 0xf000 },  //  6: 7 7 2, € hex 6
+    { 0x0025, 0x031a },  //  7: 8 8 2, „ Opt-W 2
+    { 0x0026, 0x022f },  //  8: 9 9 2, “ Opt-[ 2
+    { 0x0027, 0x032f },  //  9: 0 0 2, ” Opt-{ 2
+    { 0x002d, 0x032d },  // 10: - - 2, — Opt-_ 2
+    { 0x0036, 0x022d },  // 11: , , 2, – Opt-- 2
+    { 0x0037, 0xf000 },  // 12: . . 2, • hex 7
+    { 0x0216, 0x0216 },  // 13: ß Opt-s 2, ß Opt-s 2
+    { 0xf000, 0xf000 },  // 14: ¹ hex 7, ¹ hex 7
+    { 0xf000, 0xf000 },  // 15: ² hex 7, ² hex 7
+    { 0xf000, 0xf000 },  // 16: ³ hex 7, ³ hex 7
+    { 0xf000, 0xf000 },  // 17: › hex 6, › hex 6
+    { 0xf000, 0xf000 },  // 18: ‹ hex 6, ‹ hex 6
+    { 0xf000, 0xf000 },  // 19: ¢ hex 7, ¢ hex 7
+    { 0x021c, 0x021c },  // 20: ¥ Opt-y 2, ¥ Opt-y 2
+    { 0xf000, 0xf000 },  // 21: ‚ hex 6, ‚ hex 6
+    { 0x0230, 0x0230 },  // 22: ‘ Opt-] 2, ‘ Opt-] 2
+    { 0x0330, 0x0330 },  // 23: ’ Opt-} 2, ’ Opt-} 2
+    { 0x0233, 0x0233 },  // 24: … Opt-; 2, … Opt-; 2
+    { 0xf000, 0xf000 },  // 25: ſ hex 6, ſ hex 6
+    { 0x0123, 0x0123 },  // 26: ^ ^ 2, ^ ^ 2
+    { 0x0135, 0x0135 },  // 27: ~ ~ 2, ~ ~ 2
+    { 0x0035, 0x0035 },  // 28: ` ` 2, ` ` 2
+    { 0x0134, 0x0134 },  // 29: " " 2, " " 2
+    { 0x0034, 0x0034 },  // 30: ' ' 2, ' ' 2
+    { 0xf000, 0xf000 },  // 31: ª hex 8, ª hex 8
+    { 0xf000, 0xf000 },  // 32: º hex 7, º hex 7
+    { 0xf000, 0xf000 },  // 33: № hex 7, № hex 7
+    { 0xf000, 0xf000 },  // 34: · hex 7, · hex 7
+    { 0xf000, 0xf000 },  // 35: £ hex 7, £ hex 7
+    { 0xf000, 0xf000 },  // 36: ¤ hex 7, ¤ hex 7
+    { 0xf000, 0xf000 },  // 37: ¡ hex 7, ¡ hex 7
+    { 0x0338, 0x0338 },  // 38: ¿ Opt-? 2, ¿ Opt-? 2
+    { 0x032d, 0x032d },  // 39: — Opt-_ 2, — Opt-_ 2
+    { 0x1004, 0x1104 },  // 40: à Opt-` a 5, À Opt-` A 5
+    { 0x1008, 0x1108 },  // 41: è Opt-` e 5, È Opt-` E 5
+    { 0x100c, 0x110c },  // 42: ì Opt-` i 5, Ì Opt-` I 5
+    { 0x1012, 0x030f },  // 43: ò Opt-` o 5, Ò Opt-L 2
+    { 0x1018, 0x1118 },  // 44: ù Opt-` u 5, Ù Opt-` U 5
+    { 0xf000, 0x031c },  // 45: á hex 7, Á Opt-Y 2
+    { 0xf000, 0xf000 },  // 46: é hex 7, É hex 7
+    { 0xf000, 0x0316 },  // 47: í hex 7, Í Opt-S 2
+    { 0xf000, 0x030b },  // 48: ó hex 7, Ó Opt-H 2
+    { 0xf000, 0x0333 },  // 49: ú hex 7, Ú Opt-: 2
+    { 0x4004, 0x0310 },  // 50: â Opt-i a 5, Â Opt-M 2
+    { 0x4008, 0x4108 },  // 51: ê Opt-i e 5, Ê Opt-i E 5
+    { 0x400c, 0x410c },  // 52: î Opt-i i 5, Î Opt-i I 5
+    { 0x4012, 0x030d },  // 53: ô Opt-i o 5, Ô Opt-J 2
+    { 0x4018, 0x4118 },  // 54: û Opt-i u 5, Û Opt-i U 5
+    { 0x3004, 0x3104 },  // 55: ä Opt-u a 5, Ä Opt-u A 5
+    { 0x3008, 0x3108 },  // 56: ë Opt-u e 5, Ë Opt-u E 5
+    { 0x300c, 0x310c },  // 57: ï Opt-u i 5, Ï Opt-u I 5
+    { 0x3012, 0x3112 },  // 58: ö Opt-u o 5, Ö Opt-u O 5
+    { 0x3018, 0x3118 },  // 59: ü Opt-u u 5, Ü Opt-u U 5
+    { 0x301c, 0x311c },  // 60: ÿ Opt-u y 5, Ÿ Opt-u Y 5
+    { 0x5004, 0x5104 },  // 61: ã Opt-n a 5, Ã Opt-n A 5
+    { 0x5011, 0x5111 },  // 62: ñ Opt-n n 5, Ñ Opt-n N 5
+    { 0x5012, 0x5112 },  // 63: õ Opt-n o 5, Õ Opt-n O 5
+    { 0xf000, 0xf000 },  // 64: å hex 7, Å hex 7
+    { 0x0234, 0x0334 },  // 65: æ Opt-' 2, Æ Opt-" 2
+    { 0xf000, 0xf000 },  // 66: ç hex 7, Ç hex 7
+    { 0x0212, 0x0312 },  // 67: ø Opt-o 2, Ø Opt-O 2
+    { 0x0214, 0x0314 },  // 68: œ Opt-q 2, Œ Opt-Q 2
+    { 0x020f, 0x020f },  // 69: ¬ Opt-l 2, ¬ Opt-l 2
+    { 0xf000, 0xf000 },  // 70: ∨ hex 8, ∨ hex 8
+    { 0xf000, 0xf000 },  // 71: ∧ hex 8, ∧ hex 8
+    { 0xf000, 0xf000 },  // 72: ⊥ hex 7, ⊥ hex 7
+    { 0xf000, 0xf000 },  // 73: ∡ hex 8, ∡ hex 8
+    { 0xf000, 0xf000 },  // 74: ∥ hex 8, ∥ hex 8
+    { 0xf000, 0xf000 },  // 75: → hex 6, → hex 6
+    { 0xf000, 0xf000 },  // 76: ∞ hex 7, ∞ hex 7
+    { 0xf000, 0xf000 },  // 77: ∝ hex 7, ∝ hex 7
+    { 0xf000, 0xf000 },  // 78: ∅ hex 7, ∅ hex 7
+    { 0x0219, 0x0219 },  // 79: √ Opt-v 2, √ Opt-v 2
+    { 0xf000, 0xf000 },  // 80: ℂ hex 6, ℂ hex 6
+    { 0xf000, 0xf000 },  // 81: × hex 7, × hex 7
+    { 0xf000, 0xf000 },  // 82: ℚ hex 7, ℚ hex 7
+    { 0xf000, 0xf000 },  // 83: ∘ hex 7, ∘ hex 7
+    { 0xf000, 0xf000 },  // 84: ⊂ hex 7, ⊂ hex 7
+    { 0xf000, 0xf000 },  // 85: ∫ hex 8, ∫ hex 8
+    { 0xf000, 0xf000 },  // 86: ∀ hex 8, ∀ hex 8
+    { 0xf000, 0xf000 },  // 87: ∃ hex 7, ∃ hex 7
+    { 0xf000, 0xf000 },  // 88: ∈ hex 7, ∈ hex 7
+    { 0x021a, 0x021a },  // 89: ∑ Opt-w 2, ∑ Opt-w 2
+    { 0xf000, 0xf000 },  // 90: ℕ hex 7, ℕ hex 7
+    { 0xf000, 0xf000 },  // 91: ℝ hex 7, ℝ hex 7
+    { 0xf000, 0xf000 },  // 92: ∂ hex 7, ∂ hex 7
+    { 0x020d, 0x020d },  // 93: ∆ Opt-j 2, ∆ Opt-j 2
+    { 0xf000, 0xf000 },  // 94: ∪ hex 8, ∪ hex 8
+    { 0xf000, 0xf000 },  // 95: ∩ hex 8, ∩ hex 8
+    { 0xf000, 0xf000 },  // 96: ℵ hex 6, ℵ hex 6
+    { 0x0313, 0x0313 },  // 97: ∏ Opt-P 2, ∏ Opt-P 2
+    { 0xf000, 0xf000 },  // 98: ℤ hex 6, ℤ hex 6
+    { 0xf000, 0xf000 },  // 99: ⇐ hex 6, ⇐ hex 6
+    { 0xf000, 0xf000 },  // 100: ⇔ hex 6, ⇔ hex 6
+    { 0xf000, 0xf000 },  // 101: ⇒ hex 6, ⇒ hex 6
+    { 0xf000, 0xf000 },  // 102: ↦ hex 6, ↦ hex 6
+    { 0xf000, 0xf000 },  // 103: ∇ hex 7, ∇ hex 7
+  },
+  // Linux, U.S. with Compose
+  {
+    { 0x001e, 0xf000 },  //  0: 1 1 2, ° hex 5
+    { 0x001f, 0xf000 },  //  1: 2 2 2, § hex 5
+    { 0x0020, 0xf000 },  //  2: 3 3 2, ℓ hex 8
+    { 0x0021, 0x9137 },  //  3: 4 4 2, » Compose > > 6
+    { 0x0022, 0xf000 },  //  4: 5 5 2, « hex 5
+    { 0x0023, 0x0121 },  //  5: 6 6 2, $ $ 2
+    { 0x0024, 0xf000 },  //  6: 7 7 2, € hex 7
+    { 0x0025, 0x6134 },  //  7: 8 8 2, „ Compose , " 6
+    { 0x0026, 0x8134 },  //  8: 9 9 2, “ Compose < " 6
+    { 0x0027, 0x9134 },  //  9: 0 0 2, ” Compose > " 6
+    { 0x002d, 0xf000 },  // 10: - - 2, — hex 7
+    { 0x0036, 0xf000 },  // 11: , , 2, – hex 7
+    { 0x0037, 0xa02e },  // 12: . . 2, • Compose . = 6
+    { 0xf000, 0xf000 },  // 13: ß hex 5, ß hex 5
+    { 0xf000, 0xf000 },  // 14: ¹ hex 5, ¹ hex 5
+    { 0xf000, 0xf000 },  // 15: ² hex 5, ² hex 5
+    { 0xf000, 0xf000 },  // 16: ³ hex 5, ³ hex 5
+    { 0xa137, 0xa137 },  // 17: › Compose . > 6, › Compose . > 6
+    { 0xa136, 0xa136 },  // 18: ‹ Compose . < 6, ‹ Compose . < 6
+    { 0xf000, 0xf000 },  // 19: ¢ hex 5, ¢ hex 5
+    { 0xf000, 0xf000 },  // 20: ¥ hex 5, ¥ hex 5
+    { 0x6034, 0x6034 },  // 21: ‚ Compose , ' 6, ‚ Compose , ' 6
+    { 0x8034, 0x8034 },  // 22: ‘ Compose < ' 6, ‘ Compose < ' 6
+    { 0x9034, 0x9034 },  // 23: ’ Compose > ' 6, ’ Compose > ' 6
+    { 0xa037, 0xa037 },  // 24: … Compose . . 6, … Compose . . 6
+    { 0xf000, 0xf000 },  // 25: ſ hex 6, ſ hex 6
+    { 0x0123, 0x0123 },  // 26: ^ ^ 2, ^ ^ 2
+    { 0x0135, 0x0135 },  // 27: ~ ~ 2, ~ ~ 2
+    { 0x0035, 0x0035 },  // 28: ` ` 2, ` ` 2
+    { 0x0134, 0x0134 },  // 29: " " 2, " " 2
+    { 0x0034, 0x0034 },  // 30: ' ' 2, ' ' 2
+    { 0xf000, 0xf000 },  // 31: ª hex 6, ª hex 6
+    { 0xf000, 0xf000 },  // 32: º hex 5, º hex 5
+    { 0xf000, 0xf000 },  // 33: № hex 8, № hex 8
+    { 0xf000, 0xf000 },  // 34: · hex 5, · hex 5
+    { 0xf000, 0xf000 },  // 35: £ hex 5, £ hex 5
+    { 0xf000, 0xf000 },  // 36: ¤ hex 5, ¤ hex 5
+    { 0xf000, 0xf000 },  // 37: ¡ hex 5, ¡ hex 5
+    { 0xf000, 0xf000 },  // 38: ¿ hex 5, ¿ hex 5
+    { 0xf000, 0xf000 },  // 39: — hex 7, — hex 7
+    { 0xf000, 0xf000 },  // 40: à hex 5, À hex 5
+    { 0xf000, 0xf000 },  // 41: è hex 5, È hex 5
+    { 0xf000, 0x110c },  // 42: ì hex 5, Ì Compose ` I 6
+    { 0xf000, 0xf000 },  // 43: ò hex 5, Ò hex 5
+    { 0xf000, 0xf000 },  // 44: ù hex 5, Ù hex 5
+    { 0xf000, 0xf000 },  // 45: á hex 5, Á hex 5
+    { 0xf000, 0xf000 },  // 46: é hex 5, É hex 5
+    { 0xf000, 0xf000 },  // 47: í hex 5, Í hex 5
+    { 0xf000, 0xf000 },  // 48: ó hex 5, Ó hex 5
+    { 0xf000, 0xf000 },  // 49: ú hex 5, Ú hex 5
+    { 0xf000, 0xf000 },  // 50: â hex 5, Â hex 5
+    { 0xf000, 0xf000 },  // 51: ê hex 5, Ê hex 5
+    { 0x400c, 0xf000 },  // 52: î Compose ^ i 6, Î hex 5
+    { 0xf000, 0xf000 },  // 53: ô hex 5, Ô hex 5
+    { 0xf000, 0xf000 },  // 54: û hex 5, Û hex 5
+    { 0xf000, 0xf000 },  // 55: ä hex 5, Ä hex 5
+    { 0xf000, 0xf000 },  // 56: ë hex 5, Ë hex 5
+    { 0xf000, 0xf000 },  // 57: ï hex 5, Ï hex 5
+    { 0xf000, 0xf000 },  // 58: ö hex 5, Ö hex 5
+    { 0xf000, 0xf000 },  // 59: ü hex 5, Ü hex 5
+    { 0x301c, 0x311c },  // 60: ÿ Compose " y 6, Ÿ Compose " Y 6
+    { 0xf000, 0xf000 },  // 61: ã hex 5, Ã hex 5
+    { 0xf000, 0xf000 },  // 62: ñ hex 5, Ñ hex 5
+    { 0xf000, 0xf000 },  // 63: õ hex 5, Õ hex 5
+    { 0xf000, 0xf000 },  // 64: å hex 5, Å hex 5
+    { 0xf000, 0xf000 },  // 65: æ hex 5, Æ hex 5
+    { 0xf000, 0xf000 },  // 66: ç hex 5, Ç hex 5
+    { 0xf000, 0xf000 },  // 67: ø hex 5, Ø hex 5
+    { 0x7008, 0xf000 },  // 68: œ Compose o e 6, Œ hex 6
+    { 0xf000, 0xf000 },  // 69: ¬ hex 5, ¬ hex 5
+    { 0xf000, 0xf000 },  // 70: ∨ hex 9, ∨ hex 9
+    { 0xf000, 0xf000 },  // 71: ∧ hex 9, ∧ hex 9
+    { 0xf000, 0xf000 },  // 72: ⊥ hex 8, ⊥ hex 8
+    { 0xf000, 0xf000 },  // 73: ∡ hex 9, ∡ hex 9
+    { 0xf000, 0xf000 },  // 74: ∥ hex 9, ∥ hex 9
+    { 0xf000, 0xf000 },  // 75: → hex 7, → hex 7
+    { 0xf000, 0xf000 },  // 76: ∞ hex 8, ∞ hex 8
+    { 0xf000, 0xf000 },  // 77: ∝ hex 8, ∝ hex 8
+    { 0xf000, 0xf000 },  // 78: ∅ hex 8, ∅ hex 8
+    { 0xf000, 0xf000 },  // 79: √ hex 8, √ hex 8
+    { 0xf000, 0xf000 },  // 80: ℂ hex 7, ℂ hex 7
+    { 0xf000, 0xf000 },  // 81: × hex 5, × hex 5
+    { 0xf000, 0xf000 },  // 82: ℚ hex 8, ℚ hex 8
+    { 0xf000, 0xf000 },  // 83: ∘ hex 8, ∘ hex 8
+    { 0xf000, 0xf000 },  // 84: ⊂ hex 8, ⊂ hex 8
+    { 0xf000, 0xf000 },  // 85: ∫ hex 9, ∫ hex 9
+    { 0xf000, 0xf000 },  // 86: ∀ hex 9, ∀ hex 9
+    { 0xf000, 0xf000 },  // 87: ∃ hex 8, ∃ hex 8
+    { 0xf000, 0xf000 },  // 88: ∈ hex 8, ∈ hex 8
+    { 0xf000, 0xf000 },  // 89: ∑ hex 9, ∑ hex 9
+    { 0xf000, 0xf000 },  // 90: ℕ hex 8, ℕ hex 8
+    { 0xf000, 0xf000 },  // 91: ℝ hex 8, ℝ hex 8
+    { 0xf000, 0xf000 },  // 92: ∂ hex 8, ∂ hex 8
+    { 0xf000, 0xf000 },  // 93: ∆ hex 8, ∆ hex 8
+    { 0xf000, 0xf000 },  // 94: ∪ hex 9, ∪ hex 9
+    { 0xf000, 0xf000 },  // 95: ∩ hex 9, ∩ hex 9
+    { 0xf000, 0xf000 },  // 96: ℵ hex 7, ℵ hex 7
+    { 0xf000, 0xf000 },  // 97: ∏ hex 8, ∏ hex 8
+    { 0xf000, 0xf000 },  // 98: ℤ hex 7, ℤ hex 7
+    { 0xf000, 0xf000 },  // 99: ⇐ hex 7, ⇐ hex 7
+    { 0xf000, 0xf000 },  // 100: ⇔ hex 7, ⇔ hex 7
+    { 0xf000, 0xf000 },  // 101: ⇒ hex 7, ⇒ hex 7
+    { 0xf000, 0xf000 },  // 102: ↦ hex 7, ↦ hex 7
+    { 0xf000, 0xf000 },  // 103: ∇ hex 8, ∇ hex 8
+  },
+  // Windows, U.S.-International
+  {
+    { 0x001e, 0x0333 },  //  0: 1 1 2, ° AltGr-: 2
+    { 0x001f, 0x0316 },  //  1: 2 2 2, § AltGr-S 2
+    { 0x0020, 0x0000 },  //  2: 3 3 2, ℓ none 0
+    { 0x0021, 0x0230 },  //  3: 4 4 2, » AltGr-] 2
+    { 0x0022, 0x022f },  //  4: 5 5 2, « AltGr-[ 2
+    { 0x0023, 0x0121 },  //  5: 6 6 2, $ $ 2
+    { 0x0024, 0x0222 },  //  6: 7 7 2, € AltGr-5 2
+    { 0x0025, 0xf000 },  //  7: 8 8 2, „ hex 6
+    { 0x0026, 0xf000 },  //  8: 9 9 2, “ hex 6
+    { 0x0027, 0xf000 },  //  9: 0 0 2, ” hex 6
+    { 0x002d, 0xf000 },  // 10: - - 2, — hex 6
+    { 0x0036, 0xf000 },  // 11: , , 2, – hex 6
+    { 0x0037, 0xf000 },  // 12: . . 2, • hex 6
+    { 0x0216, 0x0216 },  // 13: ß AltGr-s 2, ß AltGr-s 2
+    { 0x031e, 0x031e },  // 14: ¹ AltGr-! 2, ¹ AltGr-! 2
+    { 0x021f, 0x021f },  // 15: ² AltGr-2 2, ² AltGr-2 2
+    { 0x0220, 0x0220 },  // 16: ³ AltGr-3 2, ³ AltGr-3 2
+    { 0xf000, 0xf000 },  // 17: › hex 7, › hex 7
+    { 0xf000, 0xf000 },  // 18: ‹ hex 6, ‹ hex 6
+    { 0x0306, 0x0306 },  // 19: ¢ AltGr-C 2, ¢ AltGr-C 2
+    { 0x022d, 0x022d },  // 20: ¥ AltGr-- 2, ¥ AltGr-- 2
+    { 0xf000, 0xf000 },  // 21: ‚ hex 6, ‚ hex 6
+    { 0x0226, 0x0226 },  // 22: ‘ AltGr-9 2, ‘ AltGr-9 2
+    { 0x0227, 0x0227 },  // 23: ’ AltGr-0 2, ’ AltGr-0 2
+    { 0xf000, 0xf000 },  // 24: … hex 7, … hex 7
+    { 0x0000, 0x0000 },  // 25: ſ none 0, ſ none 0
+    { 0x502c, 0x502c },  // 26: ^ ^   4, ^ ^   4
+    { 0x402c, 0x402c },  // 27: ~ ~   4, ~ ~   4
+    { 0x302c, 0x302c },  // 28: ` `   4, ` `   4
+    { 0x202c, 0x202c },  // 29: " "   4, " "   4
+    { 0x102c, 0x102c },  // 30: ' '   4, ' '   4
+    { 0xf000, 0xf000 },  // 31: ª hex 6, ª hex 6
+    { 0xf000, 0xf000 },  // 32: º hex 6, º hex 6
+    { 0x0000, 0x0000 },  // 33: № none 0, № none 0
+    { 0xf000, 0xf000 },  // 34: · hex 6, · hex 6
+    { 0x0321, 0x0321 },  // 35: £ AltGr-$ 2, £ AltGr-$ 2
+    { 0x0221, 0x0221 },  // 36: ¤ AltGr-4 2, ¤ AltGr-4 2
+    { 0x021e, 0x021e },  // 37: ¡ AltGr-1 2, ¡ AltGr-1 2
+    { 0x0238, 0x0238 },  // 38: ¿ AltGr-/ 2, ¿ AltGr-/ 2
+    { 0xf000, 0xf000 },  // 39: — hex 6, — hex 6
+    { 0x3004, 0x3104 },  // 40: à ` a 4, À ` A 4
+    { 0x3008, 0x3108 },  // 41: è ` e 4, È ` E 4
+    { 0x300c, 0x310c },  // 42: ì ` i 4, Ì ` I 4
+    { 0x3012, 0x3112 },  // 43: ò ` o 4, Ò ` O 4
+    { 0x3018, 0x3118 },  // 44: ù ` u 4, Ù ` U 4
+    { 0x0204, 0x0304 },  // 45: á AltGr-a 2, Á AltGr-A 2
+    { 0x0208, 0x0308 },  // 46: é AltGr-e 2, É AltGr-E 2
+    { 0x020c, 0x030c },  // 47: í AltGr-i 2, Í AltGr-I 2
+    { 0x0212, 0x0312 },  // 48: ó AltGr-o 2, Ó AltGr-O 2
+    { 0x0218, 0x0318 },  // 49: ú AltGr-u 2, Ú AltGr-U 2
+    { 0x5004, 0x5104 },  // 50: â ^ a 4, Â ^ A 4
+    { 0x5008, 0x5108 },  // 51: ê ^ e 4, Ê ^ E 4
+    { 0x500c, 0x510c },  // 52: î ^ i 4, Î ^ I 4
+    { 0x5012, 0x5112 },  // 53: ô ^ o 4, Ô ^ O 4
+    { 0x5018, 0x5118 },  // 54: û ^ u 4, Û ^ U 4
+    { 0x0214, 0x0314 },  // 55: ä AltGr-q 2, Ä AltGr-Q 2
+    { 0x2008, 0x2108 },  // 56: ë " e 4, Ë " E 4
+    { 0x200c, 0x210c },  // 57: ï " i 4, Ï " I 4
+    { 0x0213, 0x0313 },  // 58: ö AltGr-p 2, Ö AltGr-P 2
+    { 0x021c, 0x031c },  // 59: ü AltGr-y 2, Ü AltGr-Y 2
+    { 0x201c, 0xf000 },  // 60: ÿ " y 4, Ÿ hex 6
+    { 0x4004, 0x4104 },  // 61: ã ~ a 4, Ã ~ A 4
+    { 0x0211, 0x0311 },  // 62: ñ AltGr-n 2, Ñ AltGr-N 2
+    { 0x4012, 0x4112 },  // 63: õ ~ o 4, Õ ~ O 4
+    { 0x021a, 0x031a },  // 64: å AltGr-w 2, Å AltGr-W 2
+    { 0x021d, 0x031d },  // 65: æ AltGr-z 2, Æ AltGr-Z 2
+    { 0x0236, 0x0336 },  // 66: ç AltGr-, 2, Ç AltGr-< 2
+    { 0x020f, 0x030f },  // 67: ø AltGr-l 2, Ø AltGr-L 2
+    { 0xf000, 0xf000 },  // 68: œ hex 6, Œ hex 6
+    { 0x0231, 0x0231 },  // 69: ¬ AltGr-\ 2, ¬ AltGr-\ 2
+    { 0x0000, 0x0000 },  // 70: ∨ none 0, ∨ none 0
+    { 0x0000, 0x0000 },  // 71: ∧ none 0, ∧ none 0
+    { 0x0000, 0x0000 },  // 72: ⊥ none 0, ⊥ none 0
+    { 0x0000, 0x0000 },  // 73: ∡ none 0, ∡ none 0
+    { 0x0000, 0x0000 },  // 74: ∥ none 0, ∥ none 0
+    { 0x0000, 0x0000 },  // 75: → none 0, → none 0
+    { 0x0000, 0x0000 },  // 76: ∞ none 0, ∞ none 0
+    { 0x0000, 0x0000 },  // 77: ∝ none 0, ∝ none 0
+    { 0x0000, 0x0000 },  // 78: ∅ none 0, ∅ none 0
+    { 0x0000, 0x0000 },  // 79: √ none 0, √ none 0
+    { 0x0000, 0x0000 },  // 80: ℂ none 0, ℂ none 0
+    { 0x022e, 0x022e },  // 81: × AltGr-= 2, × AltGr-= 2
+    { 0x0000, 0x0000 },  // 82: ℚ none 0, ℚ none 0
+    { 0x0000, 0x0000 },  // 83: ∘ none 0, ∘ none 0
+    { 0x0000, 0x0000 },  // 84: ⊂ none 0, ⊂ none 0
+    { 0x0000, 0x0000 },  // 85: ∫ none 0, ∫ none 0
+    { 0x0000, 0x0000 },  // 86: ∀ none 0, ∀ none 0
+    { 0x0000, 0x0000 },  // 87: ∃ none 0, ∃ none 0
+    { 0x0000, 0x0000 },  // 88: ∈ none 0, ∈ none 0
+    { 0x0000, 0x0000 },  // 89: ∑ none 0, ∑ none 0
+    { 0x0000, 0x0000 },  // 90: ℕ none 0, ℕ none 0
+    { 0x0000, 0x0000 },  // 91: ℝ none 0, ℝ none 0
+    { 0x0000, 0x0000 },  // 92: ∂ none 0, ∂ none 0
+    { 0x0000, 0x0000 },  // 93: ∆ none 0, ∆ none 0
+    { 0x0000, 0x0000 },  // 94: ∪ none 0, ∪ none 0
+    { 0x0000, 0x0000 },  // 95: ∩ none 0, ∩ none 0
+    { 0x0000, 0x0000 },  // 96: ℵ none 0, ℵ none 0
+    { 0x0000, 0x0000 },  // 97: ∏ none 0, ∏ none 0
+    { 0x0000, 0x0000 },  // 98: ℤ none 0, ℤ none 0
+    { 0x0000, 0x0000 },  // 99: ⇐ none 0, ⇐ none 0
+    { 0x0000, 0x0000 },  // 100: ⇔ none 0, ⇔ none 0
+    { 0x0000, 0x0000 },  // 101: ⇒ none 0, ⇒ none 0
+    { 0x0000, 0x0000 },  // 102: ↦ none 0, ↦ none 0
+    { 0x0000, 0x0000 },  // 103: ∇ none 0, ∇ none 0
+  },
+};
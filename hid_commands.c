@@ -0,0 +1,109 @@
+#include <string.h>
+#include "hid_commands.h"
+#include "raw_hid.h"
+#include "latency_stats.h"
+#include "usage_stats.h"
+
+#if defined(LATENCY_STATS_ENABLE) || defined(USAGE_STATS_ENABLE)
+static uint8_t put_word(uint8_t *data, uint8_t offset, uint16_t value) {
+  data[offset] = value & 0xFF;
+  data[offset + 1] = value >> 8;
+  return offset + 2;
+}
+#endif
+
+#ifdef LATENCY_STATS_ENABLE
+static bool latency_read(uint8_t *reply, const uint8_t *request) {
+  uint8_t latency_class = request[1];
+  uint8_t offset = 2;
+
+  if (latency_class >= LATENCY_CLASSES) {
+    return false;
+  }
+
+  const latency_histogram_t *histogram = &latency_histograms[latency_class];
+  reply[1] = latency_class;
+  offset = put_word(reply, offset, histogram->count);
+  offset = put_word(reply, offset, histogram->max);
+  for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+    offset = put_word(reply, offset, histogram->buckets[i]);
+  }
+  return true;
+}
+#endif
+
+#ifdef USAGE_STATS_ENABLE
+// Copy up to HID_USAGE_WORDS counters from first on, after a header of
+// offset bytes that ends with their number.
+static void put_counters(uint8_t *reply, uint8_t offset, const uint16_t *counters, uint16_t total, uint8_t first) {
+  uint8_t count = first < total ? total - first : 0;
+
+  if (count > HID_USAGE_WORDS) count = HID_USAGE_WORDS;
+  reply[offset - 1] = count;
+  for (uint8_t i = 0; i < count; i++) {
+    offset = put_word(reply, offset, counters[first + i]);
+  }
+}
+
+static bool usage_read(uint8_t *reply, const uint8_t *request) {
+  switch (request[0]) {
+    case HID_USAGE_KEYS:
+      if (request[1] >= LAYER_COUNT) return false;
+      reply[1] = request[1];
+      reply[2] = request[2];
+      put_counters(reply, 4, &usage_keys[request[1]][0][0], MATRIX_ROWS * MATRIX_COLS, request[2]);
+      return true;
+    case HID_USAGE_MACROS:
+      reply[1] = request[1];
+      put_counters(reply, 3, usage_macros, USAGE_MACROS, request[1]);
+      return true;
+    case HID_USAGE_LAYER: {
+      uint32_t dwell;
+
+      if (request[1] >= LAYER_COUNT) return false;
+      dwell = usage_layer_dwell(request[1]);
+      reply[1] = request[1];
+      put_word(reply, 2, usage_layers[request[1]].activations);
+      put_word(reply, 4, dwell & 0xFFFF);
+      put_word(reply, 6, dwell >> 16);
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
+void raw_hid_receive(uint8_t *data, uint8_t length) {
+  uint8_t reply[RAW_EPSIZE] = { 0 };
+  bool ok = false;
+
+  reply[0] = data[0];
+  switch (data[0]) {
+#ifdef LATENCY_STATS_ENABLE
+    case HID_LATENCY_READ:
+      ok = length >= 2 && latency_read(reply, data);
+      break;
+    case HID_LATENCY_RESET:
+      latency_reset();
+      ok = true;
+      break;
+#endif
+#ifdef USAGE_STATS_ENABLE
+    case HID_USAGE_KEYS:
+    case HID_USAGE_MACROS:
+    case HID_USAGE_LAYER:
+      ok = length >= 3 && usage_read(reply, data);
+      break;
+    case HID_USAGE_RESET:
+      usage_reset();
+      ok = true;
+      break;
+#endif
+  }
+
+  if (!ok) {
+    memset(reply, 0, sizeof(reply));
+    reply[0] = HID_ERROR;
+  }
+  raw_hid_send(reply, sizeof(reply));
+}
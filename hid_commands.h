@@ -0,0 +1,31 @@
+#pragma once
+
+#include "quantum.h"
+
+// Requests from the host over raw HID. The first byte of a request is the
+// command, the reply starts with the same byte, or HID_ERROR for a command
+// that is unknown or not built in. Multi-byte values are little endian.
+enum hid_commands {
+  HID_ERROR = 0xFF,
+  // [cmd, class] -> [cmd, class, count, max ms, buckets...] as 16 bit values,
+  // see latency_stats.h
+  HID_LATENCY_READ = 0x01,
+  // [cmd] -> [cmd]
+  HID_LATENCY_RESET = 0x02,
+  // [cmd, layer, first] -> [cmd, layer, first, n, n counters] of the key
+  // presses on layer, matrix positions in row-major order, see usage_stats.h
+  HID_USAGE_KEYS = 0x03,
+  // [cmd, first] -> [cmd, first, n, n counters] of the macro invocations
+  HID_USAGE_MACROS = 0x04,
+  // [cmd, layer] -> [cmd, layer, activations, dwell ms as 32 bit value]
+  HID_USAGE_LAYER = 0x05,
+  // [cmd] -> [cmd]
+  HID_USAGE_RESET = 0x06,
+};
+
+#ifndef RAW_EPSIZE
+#define RAW_EPSIZE 32
+#endif
+
+// Counters per HID_USAGE_KEYS or HID_USAGE_MACROS reply
+#define HID_USAGE_WORDS 14
@@ -0,0 +1,89 @@
+#include "host_profile.h"
+#include "compose.h"
+#include "glyph_forms.h"
+
+#define SHIFT   MOD_BIT(KC_LSHIFT)
+#define OPTION  MOD_BIT(KC_LALT)
+
+// Compose key tap followed by the taps of a sequence
+#define COMPOSE(...)  { { 0, KC_APPLICATION }, __VA_ARGS__ }
+
+const host_profile_t PROGMEM host_profiles[HOST_PROFILES] = {
+  [HOST_MACOS] = {
+    .option = OPTION,
+    .modifiers_first = true,      // macOS drops the dead key state otherwise
+    .prefixes = {
+      { { OPTION, KC_GRAVE } },   // grave
+      { { OPTION, KC_E } },       // acute
+      { { OPTION, KC_U } },       // diaeresis
+      { { OPTION, KC_I } },       // circumflex
+      { { OPTION, KC_N } },       // tilde
+    },
+  },
+  [HOST_MACOS_HEX] = {
+    .option = OPTION,
+    .hex = HEX_OPTION,
+    .modifiers_first = true,
+    .prefixes = {
+      { { OPTION, KC_GRAVE } },   // grave
+      { { OPTION, KC_E } },       // acute, a hex digit on this input source
+      { { OPTION, KC_U } },       // diaeresis
+      { { OPTION, KC_I } },       // circumflex
+      { { OPTION, KC_N } },       // tilde
+    },
+  },
+  [HOST_LINUX] = {
+    .hex = HEX_CTRL_SHIFT_U,
+    .prefixes = {
+      COMPOSE({ 0, KC_GRAVE }),
+      COMPOSE({ 0, KC_QUOTE }),
+      COMPOSE({ SHIFT, KC_QUOTE }),
+      COMPOSE({ SHIFT, KC_6 }),
+      COMPOSE({ SHIFT, KC_GRAVE }),
+      COMPOSE({ 0, KC_COMMA }),
+      COMPOSE({ 0, KC_O }),
+      COMPOSE({ SHIFT, KC_COMMA }),
+      COMPOSE({ SHIFT, KC_DOT }),
+      COMPOSE({ 0, KC_DOT }),
+      COMPOSE({ 0, KC_S }),
+      COMPOSE({ SHIFT, KC_1 }),
+      COMPOSE({ SHIFT, KC_SLASH }),
+      COMPOSE({ 0, KC_MINUS }, { 0, KC_MINUS }),
+    },
+  },
+  [HOST_WINDOWS] = {
+    .option = MOD_BIT(KC_RALT),   // AltGr
+    .hex = HEX_ALT_NUMPAD,
+    .prefixes = {
+      { { 0, KC_QUOTE } },        // acute
+      { { SHIFT, KC_QUOTE } },    // diaeresis
+      { { 0, KC_GRAVE } },        // grave
+      { { SHIFT, KC_GRAVE } },    // tilde
+      { { SHIFT, KC_6 } },        // circumflex
+    },
+  },
+};
+
+const host_profile_t *host_profile = &host_profiles[HOST_MACOS];
+const uint16_t (*host_glyph_forms)[2] = glyph_forms[HOST_MACOS];
+
+void host_profile_set(uint8_t profile) {
+  if (profile >= HOST_PROFILES) {
+    return;
+  }
+  host_profile = &host_profiles[profile];
+  host_glyph_forms = glyph_forms[profile];
+  if ((eeconfig_read_user() & 0xFF) != profile) {
+    eeconfig_update_user((eeconfig_read_user() & ~0xFFUL) | profile);
+  }
+}
+
+uint8_t host_profile_get(void) {
+  return host_profile - host_profiles;
+}
+
+void host_profile_init(void) {
+  uint8_t profile = eeconfig_read_user() & 0xFF;
+
+  host_profile_set(profile < HOST_PROFILES ? profile : HOST_MACOS);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "quantum.h"
+
+// Input sources the glyphs are typed for, see compose.h. One is active at a
+// time; the NEO2_HOST keys on the FKEYS layer switch it and the choice is
+// kept in EEPROM. Switching swaps two pointers, typing a glyph costs the
+// same whichever profile is active.
+enum host_profiles {
+  HOST_MACOS,         // macOS, U.S. or ABC Extended
+  HOST_MACOS_HEX,     // macOS, Unicode Hex Input
+  HOST_LINUX,         // Linux, U.S. with Compose on the Menu key
+  HOST_WINDOWS,       // Windows, U.S.-International
+  HOST_PROFILES
+};
+
+// How a COMPOSE_HEX form types its code point
+enum host_hex_inputs {
+  HEX_NONE,
+  HEX_OPTION,         // four hex digits with Option held
+  HEX_CTRL_SHIFT_U,   // Ctrl+Shift+U, the hex digits, Space (IBus and GTK)
+  HEX_ALT_NUMPAD,     // Alt held over 0 and the Windows-1252 code on the keypad
+};
+
+#define HOST_PREFIXES       14
+#define HOST_PREFIX_TAPS    3
+
+typedef struct {
+  uint8_t option;                 // modifier of COMPOSE_OPTION forms
+  uint8_t hex;                    // enum host_hex_inputs
+  bool    modifiers_first;        // prefix taps press their modifiers in a report of their own
+  // Key taps typed before the base key of a prefixed form, { modifiers, key }.
+  // Dead keys or a Compose sequence, KC_NO ends a prefix early.
+  uint8_t prefixes[HOST_PREFIXES][HOST_PREFIX_TAPS][2];
+} host_profile_t;
+
+extern const host_profile_t host_profiles[HOST_PROFILES];
+
+// The active profile and the forms of every glyph on it
+extern const host_profile_t *host_profile;
+extern const uint16_t (*host_glyph_forms)[2];
+
+// Select the profile stored in EEPROM, HOST_MACOS if there is none
+void host_profile_init(void);
+void host_profile_set(uint8_t profile);
+uint8_t host_profile_get(void);
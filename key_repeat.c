@@ -0,0 +1,65 @@
+#include "key_repeat.h"
+
+key_repeat_stats_t key_repeat_stats;
+
+static struct {
+  bool active;
+  bool late;              // counted once per repeat
+  keypos_t key;
+  uint8_t hidden_modifiers;
+  uint16_t timer;         // when the stream was queued last
+  uint16_t wait;          // until the next repeat
+  report_stream_t stream;
+} repeat;
+
+void key_repeat_start(keypos_t key, const report_stream_t *stream, uint8_t hidden_modifiers) {
+  repeat.active = stream->length > 0;
+  repeat.late = false;
+  repeat.key = key;
+  repeat.hidden_modifiers = hidden_modifiers;
+  repeat.timer = timer_read();
+  repeat.wait = REPEAT_DELAY;
+  repeat.stream = *stream;
+}
+
+void process_key_repeat(uint16_t keycode, keyrecord_t *record) {
+  if (!repeat.active) {
+    return;
+  }
+  if (record->event.pressed) {
+    if (!IS_MOD(keycode)) repeat.active = false;
+  } else if (record->event.key.row == repeat.key.row && record->event.key.col == repeat.key.col) {
+    repeat.active = false;
+  }
+}
+
+void key_repeat_task(void) {
+  if (!repeat.active) {
+    return;
+  }
+
+  uint16_t elapsed = timer_elapsed(repeat.timer);
+
+  if (elapsed < repeat.wait) {
+    return;
+  }
+  // The previous stream, or a key typed meanwhile, is still going out.
+  // Queueing behind it would only build up a backlog the host types after
+  // the key is released.
+  if (report_queue_busy()) {
+    if (!repeat.late) key_repeat_stats.late++;
+    repeat.late = true;
+    return;
+  }
+
+  send_report_stream_ram(&repeat.stream, repeat.hidden_modifiers);
+  key_repeat_stats.repeats++;
+  // Keep the rate when on time, start over from now when held back
+  repeat.timer = repeat.late || elapsed - repeat.wait >= REPEAT_INTERVAL ? timer_read() : repeat.timer + repeat.wait;
+  repeat.wait = REPEAT_INTERVAL;
+  repeat.late = false;
+}
+
+bool key_repeat_active(void) {
+  return repeat.active;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "quantum.h"
+#include "report_stream.h"
+
+// Auto-repeat for keys whose output is a report stream, such as the glyph
+// keys. The host repeats a held plain key itself, but a stream ends in a
+// release, so it would type once only.
+//
+// The stream a key sent is kept. Held past REPEAT_DELAY, it is queued again
+// every REPEAT_INTERVAL from matrix_scan_user, once the report queue has
+// drained from the previous one. Releasing the key or pressing any other
+// key but a modifier ends the repeat, as on the host.
+#ifndef REPEAT_DELAY
+#define REPEAT_DELAY 400      // ms until the first repeat
+#endif
+#ifndef REPEAT_INTERVAL
+#define REPEAT_INTERVAL 33    // ms between repeats, 30 per second
+#endif
+
+typedef struct {
+  uint32_t repeats;       // streams queued again
+  uint16_t late;          // repeats held back by a busy report queue
+} key_repeat_stats_t;
+
+extern key_repeat_stats_t key_repeat_stats;
+
+// Repeat a stream, just sent with send_report_stream_ram(), while key is
+// held.
+void key_repeat_start(keypos_t key, const report_stream_t *stream, uint8_t hidden_modifiers);
+// Run in process_record_user before the key is handled. Ends the repeat,
+// never consumes the event.
+void process_key_repeat(uint16_t keycode, keyrecord_t *record);
+// Queue the next repeat when it is due, from matrix_scan_user.
+void key_repeat_task(void);
+// Whether a held key repeats
+bool key_repeat_active(void);
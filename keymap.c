@@ -3,13 +3,18 @@
 #include "action_layer.h"
 #include "version.h"
 #include "layers.h"
-
-// Timer to detect tap/hold on NEO_RMOD3 key
-static uint16_t neo3_timer;
-// State bitmap to track which key(s) enabled NEO_3 layer
-static uint8_t neo3_state = 0;
-// State bitmap to track key combo for CAPSLOCK
-static uint8_t capslock_state = 0;
+#include "report_stream.h"
+#include "tap_hold.h"
+#include "layer_hold.h"
+#include "combo.h"
+#include "compose.h"
+#include "host_profile.h"
+#include "visualizer.h"
+#include "key_repeat.h"
+#include "snippets.h"
+#include "recorder.h"
+#include "latency_stats.h"
+#include "usage_stats.h"
 
 // bitmasks for modifier keys
 #define MODS_NONE   0
@@ -18,6 +23,38 @@ static uint8_t capslock_state = 0;
 #define MODS_ALT    (MOD_BIT(KC_LALT)|MOD_BIT(KC_RALT))
 #define MODS_GUI    (MOD_BIT(KC_LGUI)|MOD_BIT(KC_RGUI))
 
+// Characters typed through compose.c, see glyph_codepoints[]
+enum neo2_glyphs {
+  // NEO_1, unshifted and shifted
+  GLYPH_1, GLYPH_2, GLYPH_3, GLYPH_4, GLYPH_5, GLYPH_6, GLYPH_7, GLYPH_8, GLYPH_9, GLYPH_0,
+  GLYPH_MINUS, GLYPH_COMMA, GLYPH_DOT, GLYPH_SHARP_S,
+  // NEO_3
+  GLYPH_SUPERSCRIPT_1, GLYPH_SUPERSCRIPT_2, GLYPH_SUPERSCRIPT_3, GLYPH_RSAQUO, GLYPH_LSAQUO,
+  GLYPH_CENT, GLYPH_YEN, GLYPH_SBQUO, GLYPH_LEFT_SINGLE_QUOTE, GLYPH_RIGHT_SINGLE_QUOTE,
+  GLYPH_ELLIPSIS, GLYPH_SMALL_LONG_S, GLYPH_CIRCUMFLEX, GLYPH_TILDE, GLYPH_BACKTICK,
+  GLYPH_DOUBLE_QUOTE, GLYPH_SINGLE_QUOTE,
+  // NEO_4
+  GLYPH_FEMININE_ORDINAL, GLYPH_MASCULINE_ORDINAL, GLYPH_NUMERO_SIGN, GLYPH_MIDDLE_DOT,
+  GLYPH_BRITISH_POUND, GLYPH_CURRENCY_SIGN, GLYPH_INV_EXCLAMATION, GLYPH_INV_QUESTIONMARK,
+  GLYPH_EM_DASH,
+  // NEO_5, lowercase and uppercase
+  GLYPH_A_GRAVE, GLYPH_E_GRAVE, GLYPH_I_GRAVE, GLYPH_O_GRAVE, GLYPH_U_GRAVE,
+  GLYPH_A_ACUTE, GLYPH_E_ACUTE, GLYPH_I_ACUTE, GLYPH_O_ACUTE, GLYPH_U_ACUTE,
+  GLYPH_A_CIRCUMFLEX, GLYPH_E_CIRCUMFLEX, GLYPH_I_CIRCUMFLEX, GLYPH_O_CIRCUMFLEX, GLYPH_U_CIRCUMFLEX,
+  GLYPH_A_DIAERESIS, GLYPH_E_DIAERESIS, GLYPH_I_DIAERESIS, GLYPH_O_DIAERESIS, GLYPH_U_DIAERESIS, GLYPH_Y_DIAERESIS,
+  GLYPH_A_TILDE, GLYPH_N_TILDE, GLYPH_O_TILDE,
+  GLYPH_A_RING, GLYPH_AE, GLYPH_C_CEDILLA, GLYPH_O_STROKE, GLYPH_OE,
+  // NEO_6
+  GLYPH_NOT, GLYPH_OR, GLYPH_AND, GLYPH_UP_TACK, GLYPH_ANGLE,
+  GLYPH_PARALLEL, GLYPH_ARROW, GLYPH_INFINITY, GLYPH_PROPORTIONAL, GLYPH_EMPTY_SET,
+  GLYPH_SQUARE_ROOT, GLYPH_COMPLEX, GLYPH_TIMES, GLYPH_RATIONAL, GLYPH_RING_OPERATOR,
+  GLYPH_SUBSET, GLYPH_INTEGRAL, GLYPH_FOR_ALL, GLYPH_EXISTS, GLYPH_ELEMENT_OF,
+  GLYPH_SUM, GLYPH_NATURAL, GLYPH_REAL, GLYPH_PARTIAL, GLYPH_INCREMENT,
+  GLYPH_UNION, GLYPH_INTERSECTION, GLYPH_ALEF, GLYPH_PRODUCT, GLYPH_INTEGERS,
+  GLYPH_IMPLIED_BY, GLYPH_EQUIVALENT, GLYPH_IMPLIES, GLYPH_MAPS_TO, GLYPH_NABLA,
+  GLYPH_COUNT
+};
+
 // Used to trigger macros / sequences of keypresses
 enum custom_keycodes {
   PLACEHOLDER = SAFE_RANGE,     // can always be here
@@ -27,88 +64,159 @@ enum custom_keycodes {
   US_OSX_CAPITAL_UE,
   US_OSX_CAPITAL_AE,
   US_OSX_CAPITAL_OE,
-  NEO2_LMOD3,
   NEO2_RMOD3,
-  NEO2_1,
-  NEO2_2,
-  NEO2_3,
-  NEO2_4,
-  NEO2_5,
-  NEO2_6,
-  NEO2_7,
-  NEO2_8,
-  NEO2_9,
-  NEO2_0,
-  NEO2_MINUS,
-  NEO2_UE,
-  NEO2_AE,
-  NEO2_OE,
-  NEO2_COMMA,
-  NEO2_DOT,
-  NEO2_SHARP_S
+  NEO2_HOLD_FIRST,
+  NEO2_HOLD_LAST = NEO2_HOLD_FIRST + LAYER_COUNT - 1,
+  NEO2_TT_FIRST,
+  NEO2_TT_LAST = NEO2_TT_FIRST + LAYER_COUNT - 1,
+  NEO2_GLYPH_FIRST,
+  NEO2_GLYPH_LAST = NEO2_GLYPH_FIRST + GLYPH_COUNT - 1,
+  NEO2_HOST_FIRST,
+  NEO2_HOST_LAST = NEO2_HOST_FIRST + HOST_PROFILES - 1,
+  NEO2_LEADER,
+  NEO2_RECORD,
+  NEO2_REPLAY
 };
 
-#define NEO2_LMOD4                  TT(NEO_4)
+// Hold a layer while the key is down, counted with every other key holding
+// the same layer, see layer_hold.h
+#define NEO2_HOLD(layer)            (NEO2_HOLD_FIRST + (layer))
+// TT(layer) on top of the counted hold
+#define NEO2_TT(layer)              (NEO2_TT_FIRST + (layer))
+
+#define NEO2_LMOD3                  NEO2_HOLD(NEO_3)
+#define NEO2_LMOD4                  NEO2_TT(NEO_4)
 #define NEO2_RMOD4                  NEO2_LMOD4
+// MO(FKEYS), counted
+#define NEO2_FKEYS                  NEO2_HOLD(FKEYS)
+
+// Type glyphs for a host profile from now on, see host_profile.h
+#define NEO2_HOST(profile)          (NEO2_HOST_FIRST + (profile))
+
+#define NEO2_MACOS                  NEO2_HOST(HOST_MACOS)
+#define NEO2_MACOS_HEX              NEO2_HOST(HOST_MACOS_HEX)
+#define NEO2_LINUX                  NEO2_HOST(HOST_LINUX)
+#define NEO2_WINDOWS                NEO2_HOST(HOST_WINDOWS)
+
+// Type a glyph, the shifted one with Shift held
+#define NEO2_GLYPH(glyph)           (NEO2_GLYPH_FIRST + (glyph))
+
+#define NEO2_1                      NEO2_GLYPH(GLYPH_1)
+#define NEO2_2                      NEO2_GLYPH(GLYPH_2)
+#define NEO2_3                      NEO2_GLYPH(GLYPH_3)
+#define NEO2_4                      NEO2_GLYPH(GLYPH_4)
+#define NEO2_5                      NEO2_GLYPH(GLYPH_5)
+#define NEO2_6                      NEO2_GLYPH(GLYPH_6)
+#define NEO2_7                      NEO2_GLYPH(GLYPH_7)
+#define NEO2_8                      NEO2_GLYPH(GLYPH_8)
+#define NEO2_9                      NEO2_GLYPH(GLYPH_9)
+#define NEO2_0                      NEO2_GLYPH(GLYPH_0)
+#define NEO2_MINUS                  NEO2_GLYPH(GLYPH_MINUS)
+#define NEO2_COMMA                  NEO2_GLYPH(GLYPH_COMMA)
+#define NEO2_DOT                    NEO2_GLYPH(GLYPH_DOT)
+#define NEO2_SHARP_S                NEO2_GLYPH(GLYPH_SHARP_S)
+#define NEO2_UE                     NEO2_GLYPH(GLYPH_U_DIAERESIS)
+#define NEO2_AE                     NEO2_GLYPH(GLYPH_A_DIAERESIS)
+#define NEO2_OE                     NEO2_GLYPH(GLYPH_O_DIAERESIS)
 
 // Use _______ to indicate a key that is transparent / falling through to a lower level
 #define _______ KC_TRNS
 
 // NEO_3 special characters
-#define US_OSX_SUPERSCRIPT_1        KC_NO                       // ¹
-#define US_OSX_SUPERSCRIPT_2        KC_NO                       // ²
-#define US_OSX_SUPERSCRIPT_3        KC_NO                       // ³
-#define US_OSX_RSAQUO               LALT(LSFT(KC_4))            // ›
-#define US_OSX_LSAQUO               LALT(LSFT(KC_3))            // ‹
-#define US_OSX_CENT                 LALT(KC_4)                  // ¢
-#define US_OSX_YEN                  LALT(KC_Y)                  // ¥
-#define US_OSX_SBQUO                LALT(LSFT(KC_0))            // ‚
-#define US_OSX_LEFT_SINGLE_QUOTE    LALT(KC_RBRACKET)           // ‘
-#define US_OSX_RIGHT_SINGLE_QUOTE   LALT(LSFT(KC_RBRACKET))     // ’
-#define US_OSX_ELLIPSIS             LALT(KC_SCOLON)             // …
-#define US_OSX_UNDERSCORE           LSFT(KC_MINUS)              // _
-#define US_OSX_LBRACKET             KC_LBRACKET                 // [
-#define US_OSX_RBRACKET             KC_RBRACKET                 // ]
-#define US_OSX_CIRCUMFLEX           LSFT(KC_6)                  // ^
-#define US_OSX_EXCLAMATION          LSFT(KC_1)                  // !
-#define US_OSX_LESSTHAN             LSFT(KC_COMMA)              // <
-#define US_OSX_GREATERTHAN          LSFT(KC_DOT)                // >
-#define US_OSX_EQUAL                KC_EQUAL                    // =
-#define US_OSX_AMPERSAND            LSFT(KC_7)                  // &
-#define US_OSX_SMALL_LONG_S         KC_NO                       // ſ
+#define US_OSX_SUPERSCRIPT_1        NEO2_GLYPH(GLYPH_SUPERSCRIPT_1)       // ¹
+#define US_OSX_SUPERSCRIPT_2        NEO2_GLYPH(GLYPH_SUPERSCRIPT_2)       // ²
+#define US_OSX_SUPERSCRIPT_3        NEO2_GLYPH(GLYPH_SUPERSCRIPT_3)       // ³
+#define US_OSX_RSAQUO               NEO2_GLYPH(GLYPH_RSAQUO)              // ›
+#define US_OSX_LSAQUO               NEO2_GLYPH(GLYPH_LSAQUO)              // ‹
+#define US_OSX_CENT                 NEO2_GLYPH(GLYPH_CENT)                // ¢
+#define US_OSX_YEN                  NEO2_GLYPH(GLYPH_YEN)                 // ¥
+#define US_OSX_SBQUO                NEO2_GLYPH(GLYPH_SBQUO)               // ‚
+#define US_OSX_LEFT_SINGLE_QUOTE    NEO2_GLYPH(GLYPH_LEFT_SINGLE_QUOTE)   // ‘
+#define US_OSX_RIGHT_SINGLE_QUOTE   NEO2_GLYPH(GLYPH_RIGHT_SINGLE_QUOTE)  // ’
+#define US_OSX_ELLIPSIS             NEO2_GLYPH(GLYPH_ELLIPSIS)            // …
+#define US_OSX_UNDERSCORE           LSFT(KC_MINUS)                        // _
+#define US_OSX_LBRACKET             KC_LBRACKET                           // [
+#define US_OSX_RBRACKET             KC_RBRACKET                           // ]
+#define US_OSX_CIRCUMFLEX           NEO2_GLYPH(GLYPH_CIRCUMFLEX)          // ^
+#define US_OSX_EXCLAMATION          LSFT(KC_1)                            // !
+#define US_OSX_LESSTHAN             LSFT(KC_COMMA)                        // <
+#define US_OSX_GREATERTHAN          LSFT(KC_DOT)                          // >
+#define US_OSX_EQUAL                KC_EQUAL                              // =
+#define US_OSX_AMPERSAND            LSFT(KC_7)                            // &
+#define US_OSX_SMALL_LONG_S         NEO2_GLYPH(GLYPH_SMALL_LONG_S)        // ſ
 #define US_OSX_BSLASH               KC_BSLASH
-#define US_OSX_SLASH                KC_SLASH                    // /
-#define US_OSX_CLBRACKET            LSFT(KC_LBRACKET)           // {
-#define US_OSX_CRBRACKET            LSFT(KC_RBRACKET)           // }
-#define US_OSX_ASTERISK             LSFT(KC_8)                  // *
-#define US_OSX_QUESTIONMARK         LSFT(KC_SLASH)              // ?
-#define US_OSX_LPARENTHESES         LSFT(KC_9)                  // (
-#define US_OSX_RPARENTHESES         LSFT(KC_0)                  // )
-#define US_OSX_HYPHEN_MINUS         KC_MINUS                    // -
-#define US_OSX_COLON                LSFT(KC_SCOLON)             // :
-#define US_OSX_AT                   LSFT(KC_2)                  // @
-#define US_OSX_HASH                 LSFT(KC_3)                  // #
-#define US_OSX_PIPE                 LSFT(KC_BSLASH)             // |
-#define US_OSX_TILDE                LSFT(KC_GRAVE)              // ~
-#define US_OSX_BACKTICK             KC_GRAVE                    // `
-#define US_OSX_PLUS                 LSFT(KC_EQUAL)              // +
-#define US_OSX_PERCENT              LSFT(KC_5)                  // %
-#define US_OSX_DOUBLE_QUOTE         LSFT(KC_QUOTE)              // "
-#define US_OSX_SINGLE_QUOTE         KC_QUOTE                    // '
-#define US_OSX_SEMICOLON            KC_SCOLON                   // ;
+#define US_OSX_SLASH                KC_SLASH                              // /
+#define US_OSX_CLBRACKET            LSFT(KC_LBRACKET)                     // {
+#define US_OSX_CRBRACKET            LSFT(KC_RBRACKET)                     // }
+#define US_OSX_ASTERISK             LSFT(KC_8)                            // *
+#define US_OSX_QUESTIONMARK         LSFT(KC_SLASH)                        // ?
+#define US_OSX_LPARENTHESES         LSFT(KC_9)                            // (
+#define US_OSX_RPARENTHESES         LSFT(KC_0)                            // )
+#define US_OSX_HYPHEN_MINUS         KC_MINUS                              // -
+#define US_OSX_COLON                LSFT(KC_SCOLON)                       // :
+#define US_OSX_AT                   LSFT(KC_2)                            // @
+#define US_OSX_HASH                 LSFT(KC_3)                            // #
+#define US_OSX_PIPE                 LSFT(KC_BSLASH)                       // |
+#define US_OSX_TILDE                NEO2_GLYPH(GLYPH_TILDE)               // ~
+#define US_OSX_BACKTICK             NEO2_GLYPH(GLYPH_BACKTICK)            // `
+#define US_OSX_PLUS                 LSFT(KC_EQUAL)                        // +
+#define US_OSX_PERCENT              LSFT(KC_5)                            // %
+#define US_OSX_DOUBLE_QUOTE         NEO2_GLYPH(GLYPH_DOUBLE_QUOTE)        // "
+#define US_OSX_SINGLE_QUOTE         NEO2_GLYPH(GLYPH_SINGLE_QUOTE)        // '
+#define US_OSX_SEMICOLON            KC_SCOLON                             // ;
 
 // NEO_4 special characters
-#define US_OSX_FEMININE_ORDINAL     LALT(KC_9)                  // ª
-#define US_OSX_MASCULINE_ORDINAL    LALT(KC_0)                  // º
-#define US_OSX_NUMERO_SIGN          KC_NO                       // №
-#define US_OSX_MIDDLE_DOT           LALT(LSFT(KC_9))            // ·
-#define US_OSX_BRITISH_POUND        LALT(KC_3)                  // £
-#define US_OSX_CURRENCY_SIGN        KC_NO                       // ¤
-#define US_OSX_INV_EXCLAMATION      LALT(KC_1)                  // ¡
-#define US_OSX_INV_QUESTIONMARK     LALT(LSFT(KC_SLASH))        // ¿
-#define US_OSX_DOLLAR               KC_DOLLAR                   // $
-#define US_OSX_EM_DASH              LALT(LSFT(KC_MINUS))        // —
-
+#define US_OSX_FEMININE_ORDINAL     NEO2_GLYPH(GLYPH_FEMININE_ORDINAL)    // ª
+#define US_OSX_MASCULINE_ORDINAL    NEO2_GLYPH(GLYPH_MASCULINE_ORDINAL)   // º
+#define US_OSX_NUMERO_SIGN          NEO2_GLYPH(GLYPH_NUMERO_SIGN)         // №
+#define US_OSX_MIDDLE_DOT           NEO2_GLYPH(GLYPH_MIDDLE_DOT)          // ·
+#define US_OSX_BRITISH_POUND        NEO2_GLYPH(GLYPH_BRITISH_POUND)       // £
+#define US_OSX_CURRENCY_SIGN        NEO2_GLYPH(GLYPH_CURRENCY_SIGN)       // ¤
+#define US_OSX_INV_EXCLAMATION      NEO2_GLYPH(GLYPH_INV_EXCLAMATION)     // ¡
+#define US_OSX_INV_QUESTIONMARK     NEO2_GLYPH(GLYPH_INV_QUESTIONMARK)    // ¿
+#define US_OSX_DOLLAR               KC_DOLLAR                             // $
+#define US_OSX_EM_DASH              NEO2_GLYPH(GLYPH_EM_DASH)             // —
+
+// NEO_6 mathematical symbols
+#define US_OSX_NOT                  NEO2_GLYPH(GLYPH_NOT)                 // ¬
+#define US_OSX_OR                   NEO2_GLYPH(GLYPH_OR)                  // ∨
+#define US_OSX_AND                  NEO2_GLYPH(GLYPH_AND)                 // ∧
+#define US_OSX_UP_TACK              NEO2_GLYPH(GLYPH_UP_TACK)             // ⊥
+#define US_OSX_ANGLE                NEO2_GLYPH(GLYPH_ANGLE)               // ∡
+#define US_OSX_PARALLEL             NEO2_GLYPH(GLYPH_PARALLEL)            // ∥
+#define US_OSX_ARROW                NEO2_GLYPH(GLYPH_ARROW)               // →
+#define US_OSX_INFINITY             NEO2_GLYPH(GLYPH_INFINITY)            // ∞
+#define US_OSX_PROPORTIONAL         NEO2_GLYPH(GLYPH_PROPORTIONAL)        // ∝
+#define US_OSX_EMPTY_SET            NEO2_GLYPH(GLYPH_EMPTY_SET)           // ∅
+#define US_OSX_SQUARE_ROOT          NEO2_GLYPH(GLYPH_SQUARE_ROOT)         // √
+#define US_OSX_COMPLEX              NEO2_GLYPH(GLYPH_COMPLEX)             // ℂ
+#define US_OSX_TIMES                NEO2_GLYPH(GLYPH_TIMES)               // ×
+#define US_OSX_RATIONAL             NEO2_GLYPH(GLYPH_RATIONAL)            // ℚ
+#define US_OSX_RING_OPERATOR        NEO2_GLYPH(GLYPH_RING_OPERATOR)       // ∘
+#define US_OSX_SUBSET               NEO2_GLYPH(GLYPH_SUBSET)              // ⊂
+#define US_OSX_INTEGRAL             NEO2_GLYPH(GLYPH_INTEGRAL)            // ∫
+#define US_OSX_FOR_ALL              NEO2_GLYPH(GLYPH_FOR_ALL)             // ∀
+#define US_OSX_EXISTS               NEO2_GLYPH(GLYPH_EXISTS)              // ∃
+#define US_OSX_ELEMENT_OF           NEO2_GLYPH(GLYPH_ELEMENT_OF)          // ∈
+#define US_OSX_SUM                  NEO2_GLYPH(GLYPH_SUM)                 // ∑
+#define US_OSX_NATURAL              NEO2_GLYPH(GLYPH_NATURAL)             // ℕ
+#define US_OSX_REAL                 NEO2_GLYPH(GLYPH_REAL)                // ℝ
+#define US_OSX_PARTIAL              NEO2_GLYPH(GLYPH_PARTIAL)             // ∂
+#define US_OSX_INCREMENT            NEO2_GLYPH(GLYPH_INCREMENT)           // ∆
+#define US_OSX_UNION                NEO2_GLYPH(GLYPH_UNION)               // ∪
+#define US_OSX_INTERSECTION         NEO2_GLYPH(GLYPH_INTERSECTION)        // ∩
+#define US_OSX_ALEF                 NEO2_GLYPH(GLYPH_ALEF)                // ℵ
+#define US_OSX_PRODUCT              NEO2_GLYPH(GLYPH_PRODUCT)             // ∏
+#define US_OSX_INTEGERS             NEO2_GLYPH(GLYPH_INTEGERS)            // ℤ
+#define US_OSX_IMPLIED_BY           NEO2_GLYPH(GLYPH_IMPLIED_BY)          // ⇐
+#define US_OSX_EQUIVALENT           NEO2_GLYPH(GLYPH_EQUIVALENT)          // ⇔
+#define US_OSX_IMPLIES              NEO2_GLYPH(GLYPH_IMPLIES)             // ⇒
+#define US_OSX_MAPS_TO              NEO2_GLYPH(GLYPH_MAPS_TO)             // ↦
+#define US_OSX_NABLA                NEO2_GLYPH(GLYPH_NABLA)               // ∇
+
+// With SPARSE_LAYERS_ENABLE only the dense layers are compiled into
+// keymaps[], at KEYMAP_SLOT(layer); the others come from sparse_layers.h.
+// Run `make -C sim layers` after changing one of them.
 const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
   /* NEO_1: Basic layer
    *
@@ -131,7 +239,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
    *                                 |      |      | NEO_4|       | NEO_4|      |      |
    *                                 `--------------------'       `--------------------'
    */
-  [NEO_1] = LAYOUT_ergodox(
+  [KEYMAP_SLOT(NEO_1)] = LAYOUT_ergodox(
     // left hand side - main
     KC_NO /* NOOP */, NEO2_1,                   NEO2_2,                   NEO2_3,                   NEO2_4,           NEO2_5,           KC_ESCAPE,
     KC_TAB,           KC_X,                     KC_V,                     KC_L,                     KC_C,             KC_W,             KC_LCTRL,
@@ -140,7 +248,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
     KC_NO /* NOOP */, KC_NO /* NOOP */,         KC_LCTRL,                 KC_LALT,                  KC_LGUI,          /* --- */         /* --- */
 
     // left hand side - thumb cluster
-    /* --- */         MO(FKEYS),        KC_HOME,
+    /* --- */         NEO2_FKEYS,       KC_HOME,
     /* KC_BSPACE */   /* KC_DELETE */   KC_END,
     KC_BSPACE,        KC_DELETE,        NEO2_LMOD4,
 
@@ -152,7 +260,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
     /* --- */         /* --- */         KC_RGUI,          KC_LEFT,          KC_DOWN,          KC_UP,            KC_RIGHT,
 
     // right hand side - thumb cluster
-    KC_PGUP,          MO(FKEYS),        /* --- */
+    KC_PGUP,          NEO2_FKEYS,       /* --- */
     KC_PGDOWN,        /* --- */         /* --- */
     NEO2_RMOD4,       KC_ENTER,         KC_SPACE
   ),
@@ -162,7 +270,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
    * ,--------------------------------------------------.           ,--------------------------------------------------.
    * |  ----  | ---- | ---- | ---- |   ›  |   ‹  |      |           |      |   ¢ 	|   ¥  |   ‚  |   ‘  |   ’  |  ----  |
    * |--------+------+------+------+------+-------------|           |------+------+------+------+------+------+--------|
-   * |  ----  |   …  |   _  |   [  |   ]  |   ^  |      |           |      |   !  |   <  |   >  |   =  |   &  |  ----  |
+   * | Leader |   …  |   _  |   [  |   ]  |   ^  |      |           |      |   !  |   <  |   >  |   =  |   &  |  ----  |
    * |--------+------+------+------+------+------|      |           |      |------+------+------+------+------+--------|
    * |        |   \  |   /  |   {  |   }  |   *  |------|           |------|   ?  |   (  |   )  |   -  |   :  |   @    |
    * |--------+------+------+------+------+------|      |           |      |------+------+------+------+------+--------|
@@ -178,10 +286,10 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
    *                                 |      |      |      |       |      |      |      |
    *                                 `--------------------'       `--------------------'
    */
-  [NEO_3] = LAYOUT_ergodox(
+  [KEYMAP_SLOT(NEO_3)] = LAYOUT_ergodox(
     // left hand side - main
     KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,     KC_NO /* NOOP */,     US_OSX_RSAQUO,            US_OSX_LSAQUO,                _______,
-    KC_NO /* NOOP */,   US_OSX_ELLIPSIS,      US_OSX_UNDERSCORE,    US_OSX_LBRACKET,      US_OSX_RBRACKET,          US_OSX_CIRCUMFLEX,            _______,
+    NEO2_LEADER,        US_OSX_ELLIPSIS,      US_OSX_UNDERSCORE,    US_OSX_LBRACKET,      US_OSX_RBRACKET,          US_OSX_CIRCUMFLEX,            _______,
     _______,            US_OSX_BSLASH,        US_OSX_SLASH,         US_OSX_CLBRACKET,     US_OSX_CRBRACKET,         US_OSX_ASTERISK,              /* --- */
     _______,            US_OSX_HASH,          US_OSX_DOLLAR,        US_OSX_PIPE,          US_OSX_TILDE,             US_OSX_BACKTICK,              _______,
     _______,            _______,              _______,              _______,              _______,                  /* --- */                     /* --- */
@@ -225,7 +333,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
    *                                 |      |      |      |       |      |      |      |
    *                                 `--------------------'       `--------------------'
    */
-  [NEO_4] = LAYOUT_ergodox(
+  [KEYMAP_SLOT(NEO_4)] = LAYOUT_ergodox(
     // left hand side - main
     KC_NO /* NOOP */,   US_OSX_FEMININE_ORDINAL,  US_OSX_MASCULINE_ORDINAL, KC_NO /* NOOP */,     US_OSX_MIDDLE_DOT,  US_OSX_BRITISH_POUND, _______,
     _______,            KC_PGUP,                  KC_BSPACE,                KC_UP,                KC_DELETE,          KC_PGDOWN,            _______,
@@ -251,16 +359,19 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
     _______,            _______,                  _______
   ),
 
-  /* NEO_5: Greek
+#if !defined(SPARSE_LAYERS_ENABLE) || defined(SPARSE_LAYERS_SOURCE)
+  /* NEO_5: Accented capitals, Shift and MOD3
+   *
+   * Typed in uppercase as Shift is held.
    *
    * ,--------------------------------------------------.           ,--------------------------------------------------.
-   * |  ----  | ---- | ---- | ---- | ---- | ---- |      |           |      | ---- | ---- | ---- | ---- | ---- |  ----  |
+   * |  ----  |   Ü  |   Ï  |   Ä  |   Ë  |   Ö  |      |           |      | ---- | ---- | ---- | ---- | ---- |  ----  |
    * |--------+------+------+------+------+-------------|           |------+------+------+------+------+------+--------|
-   * |  ----  | ---- | ---- | ---- | ---- | ---- |      |           |      | ---- | ---- | ---- | ---- | ---- |  ----  |
+   * |  ----  |   Û  |   Î  |   Â  |   Ê  |   Ô  |      |           |      |   Æ  |   Œ  |   Ø  |   Å  |   Ÿ  |  ----  |
    * |--------+------+------+------+------+------|      |           |      |------+------+------+------+------+--------|
-   * |        | ---- |  ----| ---- | ---- | ---- |------|           |------| ---- | ---- | ---- | ---- | ---- |  ----  |
+   * |        |   Ú  |   Í  |   Á  |   É  |   Ó  |------|           |------|   Ç  |   Ñ  |   Ã  |   Õ  | ---- |        |
    * |--------+------+------+------+------+------|      |           |      |------+------+------+------+------+--------|
-   * |        | ---- |  ----| ---- | ---- | ---- |      |           |      | ---- | ---- | ---- | ---- | ---- |        |
+   * |        |   Ù  |   Ì  |   À  |   È  |   Ò  |      |           |      | ---- | ---- | ---- | ---- | ---- |        |
    * `--------+------+------+------+------+-------------'           `-------------+------+------+------+------+--------'
    *   |      |      |      |      |      |                                       |      |      |      |      |      |
    *   `----------------------------------'                                       `----------------------------------'
@@ -272,42 +383,42 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
    *                                 |      |      |      |       |      |      |      |
    *                                 `--------------------'       `--------------------'
    */
-  [NEO_5] = LAYOUT_ergodox(
+  [KEYMAP_SLOT(NEO_5)] = LAYOUT_ergodox(
     // left hand side - main
-    KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   _______,
-    KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   _______,
-    _______,            KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   /* --- */
-    _______,            KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   _______,
-    _______,            _______,            _______,            _______,              _______,            /* --- */           /* --- */
+    KC_NO /* NOOP */,               NEO2_GLYPH(GLYPH_U_DIAERESIS),  NEO2_GLYPH(GLYPH_I_DIAERESIS),  NEO2_GLYPH(GLYPH_A_DIAERESIS),  NEO2_GLYPH(GLYPH_E_DIAERESIS),  NEO2_GLYPH(GLYPH_O_DIAERESIS),  _______,
+    KC_NO /* NOOP */,               NEO2_GLYPH(GLYPH_U_CIRCUMFLEX), NEO2_GLYPH(GLYPH_I_CIRCUMFLEX), NEO2_GLYPH(GLYPH_A_CIRCUMFLEX), NEO2_GLYPH(GLYPH_E_CIRCUMFLEX), NEO2_GLYPH(GLYPH_O_CIRCUMFLEX), _______,
+    _______,                        NEO2_GLYPH(GLYPH_U_ACUTE),      NEO2_GLYPH(GLYPH_I_ACUTE),      NEO2_GLYPH(GLYPH_A_ACUTE),      NEO2_GLYPH(GLYPH_E_ACUTE),      NEO2_GLYPH(GLYPH_O_ACUTE),      /* --- */
+    _______,                        NEO2_GLYPH(GLYPH_U_GRAVE),      NEO2_GLYPH(GLYPH_I_GRAVE),      NEO2_GLYPH(GLYPH_A_GRAVE),      NEO2_GLYPH(GLYPH_E_GRAVE),      NEO2_GLYPH(GLYPH_O_GRAVE),      _______,
+    _______,                        _______,                        _______,                        _______,                        _______,                        /* --- */                       /* --- */
 
     // left hand side - thumb cluster
-    /* --- */           _______,            _______,
-    /* --- */           /* --- */           _______,
-    _______,            _______,            _______,
+    /* --- */                       _______,                        _______,
+    /* --- */                       /* --- */                       _______,
+    _______,                        _______,                        _______,
 
     // right hand side - main
-    _______,            KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,
-    _______,            KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,
-    /* --- */           KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,
-    _______,            KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   _______,
-    /* --- */           /* --- */           _______,            _______,              _______,            _______,            _______,
+    _______,                        KC_NO /* NOOP */,               KC_NO /* NOOP */,               KC_NO /* NOOP */,               KC_NO /* NOOP */,               KC_NO /* NOOP */,               KC_NO /* NOOP */,
+    _______,                        NEO2_GLYPH(GLYPH_AE),           NEO2_GLYPH(GLYPH_OE),           NEO2_GLYPH(GLYPH_O_STROKE),     NEO2_GLYPH(GLYPH_A_RING),       NEO2_GLYPH(GLYPH_Y_DIAERESIS),  KC_NO /* NOOP */,
+    /* --- */                       NEO2_GLYPH(GLYPH_C_CEDILLA),    NEO2_GLYPH(GLYPH_N_TILDE),      NEO2_GLYPH(GLYPH_A_TILDE),      NEO2_GLYPH(GLYPH_O_TILDE),      KC_NO /* NOOP */,               _______,
+    _______,                        KC_NO /* NOOP */,               KC_NO /* NOOP */,               KC_NO /* NOOP */,               KC_NO /* NOOP */,               KC_NO /* NOOP */,               _______,
+    /* --- */                       /* --- */                       _______,                        _______,                        _______,                        _______,                        _______,
 
     // right hand side - thumb cluster
-    _______,            _______,            /* --- */
-    _______,            /* --- */           /* --- */
-    _______,            _______,            _______
+    _______,                        _______,                        /* --- */
+    _______,                        /* --- */                       /* --- */
+    _______,                        _______,                        _______
   ),
 
-  /* NEO_6: Math symbols
+  /* NEO_6: Mathematical symbols, MOD3 and MOD4
    *
    * ,--------------------------------------------------.           ,--------------------------------------------------.
-   * |  ----  | ---- | ---- | ---- | ---- | ---- |      |           |      | ---- | ---- | ---- | ---- | ---- |  ----  |
+   * |  ----  |   ¬  |   ∨  |   ∧  |   ⊥  |   ∡  |      |           |      |   ∥  |   →  |   ∞  |   ∝  |   ∅  |  ----  |
    * |--------+------+------+------+------+-------------|           |------+------+------+------+------+------+--------|
-   * |  ----  | ---- | ---- | ---- | ---- | ---- |      |           |      | ---- | ---- | ---- | ---- | ---- |  ----  |
+   * |  ----  | ---- |   √  | ---- |   ℂ  | ---- |      |           |      |   ×  | ---- | ---- | ---- |   ℚ  |   ∘    |
    * |--------+------+------+------+------+------|      |           |      |------+------+------+------+------+--------|
-   * |        | ---- |  ----| ---- | ---- | ---- |------|           |------| ---- | ---- | ---- | ---- | ---- |  ----  |
+   * |        |   ⊂  |   ∫  |   ∀  |   ∃  |   ∈  |------|           |------|   ∑  |   ℕ  |   ℝ  |   ∂  |   ∆  |        |
    * |--------+------+------+------+------+------|      |           |      |------+------+------+------+------+--------|
-   * |        | ---- |  ----| ---- | ---- | ---- |      |           |      | ---- | ---- | ---- | ---- | ---- |        |
+   * |        |   ∪  |   ∩  |   ℵ  |   ∏  |   ℤ  |      |           |      |   ⇐  |   ⇔  |   ⇒  |   ↦  |   ∇  |        |
    * `--------+------+------+------+------+-------------'           `-------------+------+------+------+------+--------'
    *   |      |      |      |      |      |                                       |      |      |      |      |      |
    *   `----------------------------------'                                       `----------------------------------'
@@ -319,31 +430,32 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
    *                                 |      |      |      |       |      |      |      |
    *                                 `--------------------'       `--------------------'
    */
-  [NEO_6] = LAYOUT_ergodox(
+  [KEYMAP_SLOT(NEO_6)] = LAYOUT_ergodox(
     // left hand side - main
-    KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   _______,
-    KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   _______,
-    _______,            KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   /* --- */
-    _______,            KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   _______,
-    _______,            _______,            _______,            _______,              _______,            /* --- */           /* --- */
+    KC_NO /* NOOP */,               US_OSX_NOT,                     US_OSX_OR,                      US_OSX_AND,                     US_OSX_UP_TACK,                 US_OSX_ANGLE,                   _______,
+    KC_NO /* NOOP */,               KC_NO /* NOOP */,               US_OSX_SQUARE_ROOT,             KC_NO /* NOOP */,               US_OSX_COMPLEX,                 KC_NO /* NOOP */,               _______,
+    _______,                        US_OSX_SUBSET,                  US_OSX_INTEGRAL,                US_OSX_FOR_ALL,                 US_OSX_EXISTS,                  US_OSX_ELEMENT_OF,              /* --- */
+    _______,                        US_OSX_UNION,                   US_OSX_INTERSECTION,            US_OSX_ALEF,                    US_OSX_PRODUCT,                 US_OSX_INTEGERS,                _______,
+    _______,                        _______,                        _______,                        _______,                        _______,                        /* --- */                       /* --- */
 
     // left hand side - thumb cluster
-    /* --- */           _______,            _______,
-    /* --- */           /* --- */           _______,
-    _______,            _______,            _______,
+    /* --- */                       _______,                        _______,
+    /* --- */                       /* --- */                       _______,
+    _______,                        _______,                        _______,
 
     // right hand side - main
-    _______,            KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,
-    _______,            KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,
-    /* --- */           KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,
-    _______,            KC_NO /* NOOP */,   KC_NO /* NOOP */,   KC_NO /* NOOP */,     KC_NO /* NOOP */,   KC_NO /* NOOP */,   _______,
-    /* --- */           /* --- */           _______,            _______,              _______,            _______,            _______,
+    _______,                        US_OSX_PARALLEL,                US_OSX_ARROW,                   US_OSX_INFINITY,                US_OSX_PROPORTIONAL,            US_OSX_EMPTY_SET,               KC_NO /* NOOP */,
+    _______,                        US_OSX_TIMES,                   KC_NO /* NOOP */,               KC_NO /* NOOP */,               KC_NO /* NOOP */,               US_OSX_RATIONAL,                US_OSX_RING_OPERATOR,
+    /* --- */                       US_OSX_SUM,                     US_OSX_NATURAL,                 US_OSX_REAL,                    US_OSX_PARTIAL,                 US_OSX_INCREMENT,               _______,
+    _______,                        US_OSX_IMPLIED_BY,              US_OSX_EQUIVALENT,              US_OSX_IMPLIES,                 US_OSX_MAPS_TO,                 US_OSX_NABLA,                   _______,
+    /* --- */                       /* --- */                       _______,                        _______,                        _______,                        _______,                        _______,
 
     // right hand side - thumb cluster
-    _______,            _______,            /* --- */
-    _______,            /* --- */           /* --- */
-    _______,            _______,            _______
+    _______,                        _______,                        /* --- */
+    _______,                        /* --- */                       /* --- */
+    _______,                        _______,                        _______
   ),
+#endif
 
   /* US_1: US QWERTY
    *
@@ -366,13 +478,13 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
    *                                 |      |      | END  |       | PGDN |      |      |
    *                                 `--------------------'       `--------------------'
    */
-  [US_1] = LAYOUT_ergodox(
+  [KEYMAP_SLOT(US_1)] = LAYOUT_ergodox(
     // left hand side - main
     KC_EQUAL,         KC_1,         KC_2,       KC_3,       KC_4,       KC_5,       KC_ESCAPE,
     KC_BSLASH,        KC_Q,         KC_W,       KC_E,       KC_R,       KC_T,       KC_NO /* NOOP */,
     KC_TAB,           KC_A,         KC_S,       KC_D,       KC_F,       KC_G,       /* --- */
     KC_LSHIFT,        KC_Z,         KC_X,       KC_C,       KC_V,       KC_B,       KC_NO /* NOOP */,
-    KC_LGUI,          KC_GRAVE,     KC_NO,      KC_NO,      MO(FKEYS),  /* --- */   /* --- */
+    KC_LGUI,          KC_GRAVE,     KC_NO,      KC_NO,      NEO2_FKEYS, /* --- */   /* --- */
 
     // left hand side - thumb cluster
     /* --- */         KC_LCTRL,     KC_LALT,
@@ -392,14 +504,15 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
     KC_PGDOWN,        KC_ENTER,     KC_SPACE
   ),
 
+#if !defined(SPARSE_LAYERS_ENABLE) || defined(SPARSE_LAYERS_SOURCE)
   /* FKEYS: Function keys
    *
    * ,--------------------------------------------------.           ,--------------------------------------------------.
    * |  Prev  |  F1  |  F2  |  F3  |  F4  |  F5  |  F11 |           |  F12 |  F6  |  F7  |  F8  |  F9  |  F10 |  VolUp |
    * |--------+------+------+------+------+-------------|           |------+------+------+------+------+------+--------|
-   * |  Play  |      |      |      |      |      |      |           |      |      |      |      |      |      |  VolDn |
+   * |  Play  | macOS|MacHex| Linux|  Win |      |      |           |      |      |      |      |      |      |  VolDn |
    * |--------+------+------+------+------+------|      |           |      |------+------+------+------+------+--------|
-   * |  Next  |      |      |      |      |      |------|           |------|      |      |      |      |      |  Mute  |
+   * |  Next  |Record|Replay|      |      |      |------|           |------|      |      |      |      |      |  Mute  |
    * |--------+------+------+------+------+------|      |           |      |------+------+------+------+------+--------|
    * |        |      |      |      |      |      |      |           |      |      |      |      |      |      |        |
    * `--------+------+------+------+------+-------------'           `-------------+------+------+------+------+--------'
@@ -413,11 +526,11 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
    *                                 |      |      |      |       |      |      |      |
    *                                 `--------------------'       `--------------------'
    */
-  [FKEYS] = LAYOUT_ergodox(
+  [KEYMAP_SLOT(FKEYS)] = LAYOUT_ergodox(
     // left hand side - main
     KC_MEDIA_REWIND,        KC_F1,              KC_F2,              KC_F3,                KC_F4,              KC_F5,              KC_F11,
-    KC_MEDIA_PLAY_PAUSE,    _______,            _______,            _______,              _______,            _______,            _______,
-    KC_MEDIA_FAST_FORWARD,  _______,            _______,            _______,              _______,            _______,            /* --- */
+    KC_MEDIA_PLAY_PAUSE,    NEO2_MACOS,         NEO2_MACOS_HEX,     NEO2_LINUX,           NEO2_WINDOWS,       _______,            _______,
+    KC_MEDIA_FAST_FORWARD,  NEO2_RECORD,        NEO2_REPLAY,        _______,              _______,            _______,            /* --- */
     _______,                _______,            _______,            _______,              _______,            _______,            _______,
     _______,                _______,            _______,            _______,              _______,            /* --- */           /* --- */
 
@@ -438,268 +551,452 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
     _______,                /* --- */           /* --- */
     _______,                _______,            _______
   ),
+#endif
 };
 
 // Send a key tap with a optional set of modifiers.
+// Modifiers and key go out in the same report and are released together.
 void tap_with_modifiers(uint16_t keycode, uint8_t force_modifiers) {
-  uint8_t active_modifiers = get_mods();
+  uint8_t active_modifiers = report_queue_mods();
+  uint8_t extra_modifiers = 0;
 
-  if ((force_modifiers & MODS_SHIFT) && !(active_modifiers & MODS_SHIFT)) register_code(KC_LSFT);
-  if ((force_modifiers & MODS_CTRL) && !(active_modifiers & MODS_CTRL)) register_code(KC_LCTRL);
-  if ((force_modifiers & MODS_ALT) && !(active_modifiers & MODS_ALT)) register_code(KC_LALT);
-  if ((force_modifiers & MODS_GUI) && !(active_modifiers & MODS_GUI)) register_code(KC_LGUI);
+  if ((force_modifiers & MODS_SHIFT) && !(active_modifiers & MODS_SHIFT)) extra_modifiers |= MOD_BIT(KC_LSFT);
+  if ((force_modifiers & MODS_CTRL) && !(active_modifiers & MODS_CTRL)) extra_modifiers |= MOD_BIT(KC_LCTRL);
+  if ((force_modifiers & MODS_ALT) && !(active_modifiers & MODS_ALT)) extra_modifiers |= MOD_BIT(KC_LALT);
+  if ((force_modifiers & MODS_GUI) && !(active_modifiers & MODS_GUI)) extra_modifiers |= MOD_BIT(KC_LGUI);
 
-  register_code(keycode);
-  unregister_code(keycode);
-
-  if ((force_modifiers & MODS_SHIFT) && !(active_modifiers & MODS_SHIFT)) unregister_code(KC_LSFT);
-  if ((force_modifiers & MODS_CTRL) && !(active_modifiers & MODS_CTRL)) unregister_code(KC_LCTRL);
-  if ((force_modifiers & MODS_ALT) && !(active_modifiers & MODS_ALT)) unregister_code(KC_LALT);
-  if ((force_modifiers & MODS_GUI) && !(active_modifiers & MODS_GUI)) unregister_code(KC_LGUI);
+  send_modified_tap(keycode, extra_modifiers);
 }
 
+// Unshifted and shifted code point of every glyph. How each one is typed
+// is generated for the host input source, see compose.h.
+const uint16_t PROGMEM glyph_codepoints[][2] = {
+  [GLYPH_1]                    = { '1',     0x00B0  },  // 1 °
+  [GLYPH_2]                    = { '2',     0x00A7  },  // 2 §
+  [GLYPH_3]                    = { '3',     0x2113  },  // 3 ℓ
+  [GLYPH_4]                    = { '4',     0x00BB  },  // 4 »
+  [GLYPH_5]                    = { '5',     0x00AB  },  // 5 «
+  [GLYPH_6]                    = { '6',     '$'     },  // 6 $
+  [GLYPH_7]                    = { '7',     0x20AC  },  // 7 €
+  [GLYPH_8]                    = { '8',     0x201E  },  // 8 „
+  [GLYPH_9]                    = { '9',     0x201C  },  // 9 “
+  [GLYPH_0]                    = { '0',     0x201D  },  // 0 ”
+  [GLYPH_MINUS]                = { '-',     0x2014  },  // - —
+  [GLYPH_COMMA]                = { ',',     0x2013  },  // , –
+  [GLYPH_DOT]                  = { '.',     0x2022  },  // . •
+  [GLYPH_SHARP_S]              = { 0x00DF,  0x00DF  },  // ß
+  [GLYPH_SUPERSCRIPT_1]        = { 0x00B9,  0x00B9  },  // ¹
+  [GLYPH_SUPERSCRIPT_2]        = { 0x00B2,  0x00B2  },  // ²
+  [GLYPH_SUPERSCRIPT_3]        = { 0x00B3,  0x00B3  },  // ³
+  [GLYPH_RSAQUO]               = { 0x203A,  0x203A  },  // ›
+  [GLYPH_LSAQUO]               = { 0x2039,  0x2039  },  // ‹
+  [GLYPH_CENT]                 = { 0x00A2,  0x00A2  },  // ¢
+  [GLYPH_YEN]                  = { 0x00A5,  0x00A5  },  // ¥
+  [GLYPH_SBQUO]                = { 0x201A,  0x201A  },  // ‚
+  [GLYPH_LEFT_SINGLE_QUOTE]    = { 0x2018,  0x2018  },  // ‘
+  [GLYPH_RIGHT_SINGLE_QUOTE]   = { 0x2019,  0x2019  },  // ’
+  [GLYPH_ELLIPSIS]             = { 0x2026,  0x2026  },  // …
+  [GLYPH_SMALL_LONG_S]         = { 0x017F,  0x017F  },  // ſ
+  [GLYPH_CIRCUMFLEX]           = { '^',     '^'     },  // ^, dead keys on U.S.-International
+  [GLYPH_TILDE]                = { '~',     '~'     },  // ~
+  [GLYPH_BACKTICK]             = { '`',     '`'     },  // `
+  [GLYPH_DOUBLE_QUOTE]         = { '"',     '"'     },  // "
+  [GLYPH_SINGLE_QUOTE]         = { '\'',    '\''    },  // '
+  [GLYPH_FEMININE_ORDINAL]     = { 0x00AA,  0x00AA  },  // ª
+  [GLYPH_MASCULINE_ORDINAL]    = { 0x00BA,  0x00BA  },  // º
+  [GLYPH_NUMERO_SIGN]          = { 0x2116,  0x2116  },  // №
+  [GLYPH_MIDDLE_DOT]           = { 0x00B7,  0x00B7  },  // ·
+  [GLYPH_BRITISH_POUND]        = { 0x00A3,  0x00A3  },  // £
+  [GLYPH_CURRENCY_SIGN]        = { 0x00A4,  0x00A4  },  // ¤
+  [GLYPH_INV_EXCLAMATION]      = { 0x00A1,  0x00A1  },  // ¡
+  [GLYPH_INV_QUESTIONMARK]     = { 0x00BF,  0x00BF  },  // ¿
+  [GLYPH_EM_DASH]              = { 0x2014,  0x2014  },  // —
+  [GLYPH_A_GRAVE]              = { 0x00E0,  0x00C0  },  // à À
+  [GLYPH_E_GRAVE]              = { 0x00E8,  0x00C8  },  // è È
+  [GLYPH_I_GRAVE]              = { 0x00EC,  0x00CC  },  // ì Ì
+  [GLYPH_O_GRAVE]              = { 0x00F2,  0x00D2  },  // ò Ò
+  [GLYPH_U_GRAVE]              = { 0x00F9,  0x00D9  },  // ù Ù
+  [GLYPH_A_ACUTE]              = { 0x00E1,  0x00C1  },  // á Á
+  [GLYPH_E_ACUTE]              = { 0x00E9,  0x00C9  },  // é É
+  [GLYPH_I_ACUTE]              = { 0x00ED,  0x00CD  },  // í Í
+  [GLYPH_O_ACUTE]              = { 0x00F3,  0x00D3  },  // ó Ó
+  [GLYPH_U_ACUTE]              = { 0x00FA,  0x00DA  },  // ú Ú
+  [GLYPH_A_CIRCUMFLEX]         = { 0x00E2,  0x00C2  },  // â Â
+  [GLYPH_E_CIRCUMFLEX]         = { 0x00EA,  0x00CA  },  // ê Ê
+  [GLYPH_I_CIRCUMFLEX]         = { 0x00EE,  0x00CE  },  // î Î
+  [GLYPH_O_CIRCUMFLEX]         = { 0x00F4,  0x00D4  },  // ô Ô
+  [GLYPH_U_CIRCUMFLEX]         = { 0x00FB,  0x00DB  },  // û Û
+  [GLYPH_A_DIAERESIS]          = { 0x00E4,  0x00C4  },  // ä Ä
+  [GLYPH_E_DIAERESIS]          = { 0x00EB,  0x00CB  },  // ë Ë
+  [GLYPH_I_DIAERESIS]          = { 0x00EF,  0x00CF  },  // ï Ï
+  [GLYPH_O_DIAERESIS]          = { 0x00F6,  0x00D6  },  // ö Ö
+  [GLYPH_U_DIAERESIS]          = { 0x00FC,  0x00DC  },  // ü Ü
+  [GLYPH_Y_DIAERESIS]          = { 0x00FF,  0x0178  },  // ÿ Ÿ
+  [GLYPH_A_TILDE]              = { 0x00E3,  0x00C3  },  // ã Ã
+  [GLYPH_N_TILDE]              = { 0x00F1,  0x00D1  },  // ñ Ñ
+  [GLYPH_O_TILDE]              = { 0x00F5,  0x00D5  },  // õ Õ
+  [GLYPH_A_RING]               = { 0x00E5,  0x00C5  },  // å Å
+  [GLYPH_AE]                   = { 0x00E6,  0x00C6  },  // æ Æ
+  [GLYPH_C_CEDILLA]            = { 0x00E7,  0x00C7  },  // ç Ç
+  [GLYPH_O_STROKE]             = { 0x00F8,  0x00D8  },  // ø Ø
+  [GLYPH_OE]                   = { 0x0153,  0x0152  },  // œ Œ
+  [GLYPH_NOT]                  = { 0x00AC,  0x00AC  },  // ¬
+  [GLYPH_OR]                   = { 0x2228,  0x2228  },  // ∨
+  [GLYPH_AND]                  = { 0x2227,  0x2227  },  // ∧
+  [GLYPH_UP_TACK]              = { 0x22A5,  0x22A5  },  // ⊥
+  [GLYPH_ANGLE]                = { 0x2221,  0x2221  },  // ∡
+  [GLYPH_PARALLEL]             = { 0x2225,  0x2225  },  // ∥
+  [GLYPH_ARROW]                = { 0x2192,  0x2192  },  // →
+  [GLYPH_INFINITY]             = { 0x221E,  0x221E  },  // ∞
+  [GLYPH_PROPORTIONAL]         = { 0x221D,  0x221D  },  // ∝
+  [GLYPH_EMPTY_SET]            = { 0x2205,  0x2205  },  // ∅
+  [GLYPH_SQUARE_ROOT]          = { 0x221A,  0x221A  },  // √
+  [GLYPH_COMPLEX]              = { 0x2102,  0x2102  },  // ℂ
+  [GLYPH_TIMES]                = { 0x00D7,  0x00D7  },  // ×
+  [GLYPH_RATIONAL]             = { 0x211A,  0x211A  },  // ℚ
+  [GLYPH_RING_OPERATOR]        = { 0x2218,  0x2218  },  // ∘
+  [GLYPH_SUBSET]               = { 0x2282,  0x2282  },  // ⊂
+  [GLYPH_INTEGRAL]             = { 0x222B,  0x222B  },  // ∫
+  [GLYPH_FOR_ALL]              = { 0x2200,  0x2200  },  // ∀
+  [GLYPH_EXISTS]               = { 0x2203,  0x2203  },  // ∃
+  [GLYPH_ELEMENT_OF]           = { 0x2208,  0x2208  },  // ∈
+  [GLYPH_SUM]                  = { 0x2211,  0x2211  },  // ∑
+  [GLYPH_NATURAL]              = { 0x2115,  0x2115  },  // ℕ
+  [GLYPH_REAL]                 = { 0x211D,  0x211D  },  // ℝ
+  [GLYPH_PARTIAL]              = { 0x2202,  0x2202  },  // ∂
+  [GLYPH_INCREMENT]            = { 0x2206,  0x2206  },  // ∆
+  [GLYPH_UNION]                = { 0x222A,  0x222A  },  // ∪
+  [GLYPH_INTERSECTION]         = { 0x2229,  0x2229  },  // ∩
+  [GLYPH_ALEF]                 = { 0x2135,  0x2135  },  // ℵ
+  [GLYPH_PRODUCT]              = { 0x220F,  0x220F  },  // ∏
+  [GLYPH_INTEGERS]             = { 0x2124,  0x2124  },  // ℤ
+  [GLYPH_IMPLIED_BY]           = { 0x21D0,  0x21D0  },  // ⇐
+  [GLYPH_EQUIVALENT]           = { 0x21D4,  0x21D4  },  // ⇔
+  [GLYPH_IMPLIES]              = { 0x21D2,  0x21D2  },  // ⇒
+  [GLYPH_MAPS_TO]              = { 0x21A6,  0x21A6  },  // ↦
+  [GLYPH_NABLA]                = { 0x2207,  0x2207  },  // ∇
+};
+const uint8_t glyph_count = sizeof(glyph_codepoints) / sizeof(glyph_codepoints[0]);
+
 // Special remapping for keys with different keycodes/macros when used with shift modifiers.
 bool process_record_user_shifted(uint16_t keycode, keyrecord_t *record) {
-  uint8_t active_modifiers = get_mods();
-  uint8_t shifted = active_modifiers & MODS_SHIFT;
+  uint8_t shifted = (report_queue_mods() & MODS_SHIFT) ? 1 : 0;
 
   // Early return on key release
   if(!record->event.pressed) {
     return true;
   }
 
-  if(shifted) {
-    clear_mods();
-
-    switch(keycode) {
-      case NEO2_1:
-        // degree symbol
-        SEND_STRING(SS_DOWN(X_LALT) SS_DOWN(X_LSHIFT) SS_TAP(X_8) SS_UP(X_LSHIFT) SS_UP(X_LALT));
-        break;
-      case NEO2_2:
-        // section symbol
-        SEND_STRING(SS_DOWN(X_LALT) SS_TAP(X_6) SS_UP(X_LALT));
-        break;
-      case NEO2_3:
-        // There is no OSX key combination for the script small l character
-        break;
-      case NEO2_4:
-        // right angled quote
-        SEND_STRING(SS_DOWN(X_LALT) SS_DOWN(X_LSHIFT) SS_TAP(X_BSLASH) SS_UP(X_LSHIFT) SS_UP(X_LALT));
-        break;
-      case NEO2_5:
-        // left angled quote
-        SEND_STRING(SS_DOWN(X_LALT) SS_TAP(X_BSLASH) SS_UP(X_LALT));
-        break;
-      case NEO2_6:
-        // dollar sign
-        SEND_STRING(SS_DOWN(X_LSHIFT) SS_TAP(X_4) SS_UP(X_LSHIFT));
-        break;
-      case NEO2_7:
-        // euro sign
-        SEND_STRING(SS_DOWN(X_LALT) SS_DOWN(X_LSHIFT) SS_TAP(X_2) SS_UP(X_LSHIFT) SS_UP(X_LALT));
-        break;
-      case NEO2_8:
-        // low9 double quote
-        SEND_STRING(SS_DOWN(X_LALT) SS_DOWN(X_LSHIFT) SS_TAP(X_W) SS_UP(X_LSHIFT) SS_UP(X_LALT));
-        break;
-      case NEO2_9:
-        // left double quote
-        SEND_STRING(SS_DOWN(X_LALT) SS_TAP(X_LBRACKET) SS_UP(X_LALT));
-        break;
-      case NEO2_0:
-        // right double quote
-        SEND_STRING(SS_DOWN(X_LALT) SS_DOWN(X_LSHIFT) SS_TAP(X_LBRACKET) SS_UP(X_LSHIFT) SS_UP(X_LALT));
-        break;
-      case NEO2_MINUS:
-        // em dash
-        SEND_STRING(SS_DOWN(X_LALT) SS_DOWN(X_LSHIFT) SS_TAP(X_MINUS) SS_UP(X_LSHIFT) SS_UP(X_LALT));
-        break;
-      case NEO2_COMMA:
-        // en dash
-        SEND_STRING(SS_DOWN(X_LALT) SS_TAP(X_MINUS) SS_UP(X_LALT));
-        break;
-      case NEO2_DOT:
-        // bullet
-        SEND_STRING(SS_DOWN(X_LALT) SS_TAP(X_8) SS_UP(X_LALT));
-        break;
-      case NEO2_SHARP_S:
-        // german sharp s
-        SEND_STRING(SS_DOWN(X_LALT) SS_TAP(X_S) SS_UP(X_LALT));
-        break;
-      case NEO2_UE:
-        SEND_STRING(SS_DOWN(X_LALT) SS_DOWN(X_U) SS_UP(X_U) SS_UP(X_LALT) SS_DOWN(X_LSHIFT) SS_TAP(X_U) SS_UP(X_LSHIFT));
-        break;
-      case NEO2_OE:
-        SEND_STRING(SS_DOWN(X_LALT) SS_DOWN(X_U) SS_UP(X_U) SS_UP(X_LALT) SS_DOWN(X_LSHIFT) SS_TAP(X_O) SS_UP(X_LSHIFT));
-        break;
-      case NEO2_AE:
-        SEND_STRING(SS_DOWN(X_LALT) SS_DOWN(X_U) SS_UP(X_U) SS_UP(X_LALT) SS_DOWN(X_LSHIFT) SS_TAP(X_A) SS_UP(X_LSHIFT));
-        break;
-      default:
-        set_mods(active_modifiers);
-        return true;
+  if (keycode < NEO2_GLYPH_FIRST || keycode > NEO2_GLYPH_LAST) {
+    return true;
+  }
+
+  report_stream_t stream;
+
+  usage_macro((keycode - NEO2_GLYPH_FIRST) * 2 + shifted);
+  glyph_stream(keycode - NEO2_GLYPH_FIRST, shifted, &stream);
+  if (stream.length) {
+    send_report_stream_ram(&stream, GLYPH_HIDDEN_MODIFIERS);
+    // The host cannot repeat a stream, see key_repeat.h
+    key_repeat_start(record->event.key, &stream, GLYPH_HIDDEN_MODIFIERS);
+  }
+
+  return false;
+}
+
+// Text expansion, see snippets.h. Leader and the trigger type the text;
+// the triggers starting with ; also expand when typed as a word. After
+// changing a trigger, regenerate the trie with `make -C sim snippets`.
+const snippet_t PROGMEM snippets[] = {
+  { .trigger = "mfg",    .text = "Mit freundlichen Grüßen\n" },
+  { .trigger = "vg",     .text = "Viele Grüße\n" },
+  { .trigger = "br",     .text = "Best regards\n" },
+  { .trigger = "sgdh",   .text = "Sehr geehrte Damen und Herren,\n" },
+  { .trigger = ";zb",    .text = "z. B.", .flags = SNIPPET_TYPED },
+  { .trigger = ";dh",    .text = "d. h.", .flags = SNIPPET_TYPED },
+  { .trigger = ";usw",   .text = "usw.", .flags = SNIPPET_TYPED },
+  { .trigger = ";ca",    .text = "ca.", .flags = SNIPPET_TYPED },
+  { .trigger = ";gg",    .text = "ggf.", .flags = SNIPPET_TYPED },
+  { .trigger = ";mfg",   .text = "Mit freundlichen Grüßen", .flags = SNIPPET_TYPED },
+  { .trigger = "inc",    .text = "#include \"\"" },
+  { .trigger = "main",   .text = "int main(int argc, char **argv) {\n" },
+  { .trigger = "for",    .text = "for (int i = 0; i < n; i++) {\n" },
+  { .trigger = "todo",   .text = "// TODO: " },
+  { .trigger = "beg",    .text = "\\begin{}" },
+  { .trigger = "end",    .text = "\\end{}" },
+  { .trigger = "frac",   .text = "\\frac{}{}" },
+  { .trigger = "sum",    .text = "\\sum_{i=1}^{n} " },
+  { .trigger = "eq",     .text = "\\begin{equation}\n" },
+  { .trigger = "item",   .text = "\\begin{itemize}\n\\item " },
+  { .trigger = "al",     .text = "\\alpha" },
+  { .trigger = "be",     .text = "\\beta" },
+  { .trigger = "eur",    .text = "€" },
+  { .trigger = "deg",    .text = "°C" },
+  { .trigger = "quo",    .text = "„“" },
+};
+const uint8_t snippet_count = sizeof(snippets) / sizeof(snippets[0]);
+
+// Dual-role keys, see tap_hold.h. NEO2_RMOD3 is y on tap and holds NEO_3;
+// tapped while NEO2_LMOD3 holds NEO_3 it is @.
+const tap_hold_key_t PROGMEM tap_hold_keys[] = {
+  { .keycode = NEO2_RMOD3, .tap = KC_Y, .layer_tap = US_OSX_AT, .layer = NEO_3, .term = 150, .flags = TAP_HOLD_PERMISSIVE },
+};
+const uint8_t tap_hold_key_count = sizeof(tap_hold_keys) / sizeof(tap_hold_keys[0]);
+
+// Chords, see combo.h. Both Shift keys toggle Caps Lock, as in Neo 2.
+enum neo2_combo_keys {
+  COMBO_LSHIFT,
+  COMBO_RSHIFT
+};
+
+const uint16_t PROGMEM combo_keys[] = {
+  [COMBO_LSHIFT] = KC_LSHIFT,
+  [COMBO_RSHIFT] = KC_RSHIFT,
+};
+const uint8_t combo_key_count = sizeof(combo_keys) / sizeof(combo_keys[0]);
+
+const combo_t PROGMEM combos[] = {
+  { .keys = COMBO_BIT(COMBO_LSHIFT) | COMBO_BIT(COMBO_RSHIFT), .keycode = KC_CAPSLOCK, .term = 0 },
+};
+const uint8_t combo_count = sizeof(combos) / sizeof(combos[0]);
+COMBO_CHECK_TABLES();
+
+#ifdef LATENCY_STATS_ENABLE
+// Latency histogram a key press is counted in, see latency_stats.h
+static uint8_t latency_class(uint16_t keycode) {
+  switch (keycode) {
+    case NEO2_RMOD3:
+      return LATENCY_TAP_HOLD;
+    case NEO2_HOLD_FIRST ... NEO2_HOLD_LAST:
+    case NEO2_TT_FIRST ... NEO2_TT_LAST:
+    case QK_TO ... QK_TO_MAX:
+      return LATENCY_LAYER;
+    case NEO2_GLYPH_FIRST ... NEO2_GLYPH_LAST:
+    case QK_MODS ... QK_MODS_MAX:
+      return LATENCY_MACRO;
+  }
+  return (IS_KEY(keycode) || IS_MOD(keycode)) ? LATENCY_PLAIN : LATENCY_NONE;
+}
+#endif
+
+// Shift keys that are down. get_mods() only follows them once
+// process_record_user has returned.
+static uint8_t shift_keys;
+
+// Neo 2 reaches layer 5 with Shift and MOD3, layer 6 with MOD3 and MOD4.
+// Applied to every new layer_state.
+static uint32_t neo2_layers(uint32_t state) {
+  bool mod3 = state & (1UL << NEO_3);
+
+  state &= ~((1UL << NEO_5) | (1UL << NEO_6));
+  if (mod3 && shift_keys) state |= 1UL << NEO_5;
+  if (mod3 && (state & (1UL << NEO_4))) state |= 1UL << NEO_6;
+  return state;
+}
+
+// Character a key types for the snippet triggers, see snippets.h
+static uint8_t snippet_char(uint16_t keycode) {
+  uint8_t mods = report_queue_mods();
+  bool shifted = mods & MODS_SHIFT;
+
+  switch (keycode) {
+    case KC_NO:
+    case KC_LCTRL ... KC_RGUI:
+    case NEO2_RMOD3:
+    case NEO2_HOLD_FIRST ... NEO2_HOLD_LAST:
+    case NEO2_TT_FIRST ... NEO2_TT_LAST:
+    case NEO2_LEADER:
+    case NEO2_RECORD:
+    case NEO2_REPLAY:
+      return SNIPPET_MODIFIER;
+    case NEO2_GLYPH_FIRST ... NEO2_GLYPH_LAST: {
+      uint16_t codepoint = pgm_read_word(&glyph_codepoints[keycode - NEO2_GLYPH_FIRST][shifted ? 1 : 0]);
+      return codepoint < 0x80 ? codepoint : SNIPPET_OTHER_CHAR;
     }
+  }
+  // Shortcuts type nothing
+  if (mods & (MODS_CTRL | MODS_ALT | MODS_GUI)) {
+    return SNIPPET_NO_CHAR;
+  }
+  return snippet_keycode_char(keycode, shifted);
+}
+
+// Show the active host profile on the LCD, see status_screen.h
+static void show_host_profile(void) {
+  uint8_t profile = host_profile_get();
+
+  visualizer_set_user_data(&profile);
+}
 
-    set_mods(active_modifiers);
+static bool process_record_neo2(uint16_t keycode, keyrecord_t *record) {
+  // Replayed events were decided when they were recorded
+  if (!recorder_replaying() && !process_tap_hold(keycode, record)) {
     return false;
-  } else {
-    switch(keycode) {
-      case NEO2_1:
-        SEND_STRING(SS_TAP(X_1));
-        break;
-      case NEO2_2:
-        SEND_STRING(SS_TAP(X_2));
-        break;
-      case NEO2_3:
-        SEND_STRING(SS_TAP(X_3));
-        break;
-      case NEO2_4:
-        SEND_STRING(SS_TAP(X_4));
-        break;
-      case NEO2_5:
-        SEND_STRING(SS_TAP(X_5));
-        break;
-      case NEO2_6:
-        SEND_STRING(SS_TAP(X_6));
-        break;
-      case NEO2_7:
-        SEND_STRING(SS_TAP(X_7));
-        break;
-      case NEO2_8:
-        SEND_STRING(SS_TAP(X_8));
-        break;
-      case NEO2_9:
-        SEND_STRING(SS_TAP(X_9));
-        break;
-      case NEO2_0:
-        SEND_STRING(SS_TAP(X_0));
-        break;
-      case NEO2_MINUS:
-        SEND_STRING(SS_TAP(X_MINUS));
-        break;
-      case NEO2_COMMA:
-        SEND_STRING(SS_TAP(X_COMMA));
-        break;
-      case NEO2_DOT:
-        SEND_STRING(SS_TAP(X_DOT));
-        break;
-      case NEO2_SHARP_S:
-        // german sharp s
-        SEND_STRING(SS_DOWN(X_LALT) SS_TAP(X_S) SS_UP(X_LALT));
-        break;
-      case NEO2_UE:
-        SEND_STRING(SS_DOWN(X_LALT) SS_DOWN(X_U) SS_UP(X_U) SS_UP(X_LALT) SS_TAP(X_U));
-        break;
-      case NEO2_OE:
-        SEND_STRING(SS_DOWN(X_LALT) SS_DOWN(X_U) SS_UP(X_U) SS_UP(X_LALT) SS_TAP(X_O));
-        break;
-      case NEO2_AE:
-        SEND_STRING(SS_DOWN(X_LALT) SS_DOWN(X_U) SS_UP(X_U) SS_UP(X_LALT) SS_TAP(X_A));
-        break;
-      default:
-        return true;
-    }
+  }
+  // In the order the keys were decided, as dual-role taps are
+  if (record->event.pressed && (keycode < NEO2_TT_FIRST || keycode > NEO2_TT_LAST)) {
+    layer_hold_interrupt();
+  }
+
+  uint16_t held_back = snippet_stats.held_back;
+  bool typed = process_snippets(snippet_char(keycode), record);
 
+  // Events the snippets hold back are recorded once they are processed
+  if (snippet_stats.held_back == held_back && keycode != NEO2_RECORD && keycode != NEO2_REPLAY) {
+    recorder_event(record);
+  }
+  if (!typed) {
     return false;
   }
-}
+  if (record->event.pressed && !recorder_replaying()) {
+    usage_key_press(layer_switch_get_layer(record->event.key), record->event.key);
+  }
+  process_key_repeat(keycode, record);
+  process_combo(keycode, record);
 
-// Runs for each key down or up event.
-bool process_record_user(uint16_t keycode, keyrecord_t *record) {
   switch(keycode) {
-    case KC_LSHIFT:
+    case NEO2_RMOD3:
+      // Decided as hold by the tap-hold engine
       if (record->event.pressed) {
-        capslock_state |= (MOD_BIT(KC_LSHIFT));
+        layer_hold_press(NEO_3);
       } else {
-        capslock_state &= ~(MOD_BIT(KC_LSHIFT));
+        layer_hold_release(NEO_3);
       }
       break;
-    case KC_RSHIFT:
+    case NEO2_HOLD_FIRST ... NEO2_HOLD_LAST:
       if (record->event.pressed) {
-        capslock_state |= MOD_BIT(KC_RSHIFT);
+        layer_hold_press(keycode - NEO2_HOLD_FIRST);
       } else {
-        capslock_state &= ~(MOD_BIT(KC_RSHIFT));
+        layer_hold_release(keycode - NEO2_HOLD_FIRST);
       }
       break;
-    case NEO2_LMOD3:
-      if (record->event.pressed) {
-        layer_on(NEO_3);
-        neo3_state |= (1 << 1);
-      } else {
-        // Turn off NEO_3 layer unless it's enabled through NEO2_RMOD3 as well.
-        if ((neo3_state & ~(1 << 1)) == 0) {
-          layer_off(NEO_3);
-        }
-        neo3_state &= ~(1 << 1);
+    case NEO2_TT_FIRST ... NEO2_TT_LAST:
+      layer_hold_tap_toggle(keycode - NEO2_TT_FIRST, record);
+      // Both MOD4 keys at once lock NEO_4 as well, as in Neo 2
+      if (record->event.pressed && keycode == NEO2_TT(NEO_4) && layer_hold_count(NEO_4) == 2) {
+        layer_hold_lock(NEO_4);
       }
       break;
-    case NEO2_RMOD3:
+    case NEO2_HOST_FIRST ... NEO2_HOST_LAST:
+      if (record->event.pressed) {
+        host_profile_set(keycode - NEO2_HOST_FIRST);
+        show_host_profile();
+      }
+      return false;
+    case NEO2_LEADER:
+      if (record->event.pressed) {
+        snippet_leader();
+      }
+      return false;
+    case NEO2_RECORD:
+      if (record->event.pressed) {
+        recorder_toggle();
+      }
+      return false;
+    case NEO2_REPLAY:
+      if (record->event.pressed) {
+        recorder_replay();
+      }
+      return false;
+    case KC_LSHIFT:
+    case KC_RSHIFT:
       if (record->event.pressed) {
-        neo3_timer = timer_read();
-        neo3_state |= (1 << 2);
-        layer_on(NEO_3);
+        shift_keys |= MOD_BIT(keycode);
       } else {
-        // Turn off NEO_3 layer unless it's enabled through NEO2_LMOD3 as well.
-        if ((neo3_state & ~(1 << 2)) == 0) {
-          layer_off(NEO_3);
-        }
-        neo3_state &= ~(1 << 2);
-
-        // Was the NEO2_RMOD3 key TAPPED?
-        if (timer_elapsed(neo3_timer) <= 150) {
-          if (neo3_state > 0) {
-            // We are still in NEO_3 layer, send keycode and modifiers for @
-            tap_with_modifiers(KC_2, MODS_SHIFT);
-            return false;
-          } else {
-            // Do the normal key processing, send y
-            tap_with_modifiers(KC_Y, MODS_NONE);
-            return false;
-          }
-        }
+        shift_keys &= ~MOD_BIT(keycode);
+      }
+      if (neo2_layers(layer_state) != layer_state) {
+        layer_state_set(layer_state);
       }
       break;
   }
 
-  if ((capslock_state & MODS_SHIFT) == MODS_SHIFT) {
-    // CAPSLOCK is currently active, disable it
-    if (host_keyboard_leds() & (1<<USB_LED_CAPS_LOCK)) {
-      unregister_code(KC_LOCKING_CAPS);
-    } else {
-      register_code(KC_LOCKING_CAPS);
-    }
+  if (!process_report_queue(keycode, record)) {
+    return false;
+  }
+
+  if (!process_modified_key(keycode, record)) {
     return false;
   }
 
   return process_record_user_shifted(keycode, record);
+}
+
+// Runs for each key down or up event.
+bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+  if (record->event.pressed && !recorder_replaying()) {
+    latency_event(latency_class(keycode), record->event.time);
+  }
+
+  bool result = process_record_neo2(keycode, record);
+
+  // Whatever the core sends next is the output of this key. Otherwise the
+  // key has either sent or queued its output by now, or has none.
+  if (result) {
+    latency_output();
+  } else {
+    latency_discard();
+  }
+  return result;
 };
 
 
+// Indicator LEDs shown for each layer
+#define LEDS_BOARD  (1 << 0)
+#define LEDS_1      (1 << 1)
+#define LEDS_2      (1 << 2)
+#define LEDS_3      (1 << 3)
+
+static const uint8_t PROGMEM layer_leds[] = {
+  [NEO_1]   = 0,
+  [NEO_3]   = LEDS_1,
+  [NEO_4]   = LEDS_2,
+  [NEO_5]   = LEDS_1,
+  [NEO_6]   = LEDS_1 | LEDS_2,
+  [US_1]    = LEDS_3,
+  [FKEYS]   = LEDS_1 | LEDS_3,
+};
+
+// LEDs as last written to the hardware
+static uint8_t applied_leds;
+
+// Write the LEDs in the changed mask and remember the new state.
+static void apply_leds(uint8_t leds, uint8_t changed) {
+  if (changed & LEDS_BOARD) { if (leds & LEDS_BOARD) ergodox_board_led_on(); else ergodox_board_led_off(); }
+  if (changed & LEDS_1) { if (leds & LEDS_1) ergodox_right_led_1_on(); else ergodox_right_led_1_off(); }
+  if (changed & LEDS_2) { if (leds & LEDS_2) ergodox_right_led_2_on(); else ergodox_right_led_2_off(); }
+  if (changed & LEDS_3) { if (leds & LEDS_3) ergodox_right_led_3_on(); else ergodox_right_led_3_off(); }
+  applied_leds = leds;
+}
+
+// Runs on every layer change, updates the LEDs that differ for the new top layer.
+uint32_t layer_state_set_user(uint32_t state) {
+  state = neo2_layers(state);
+  latency_output();
+  usage_layer_state(state);
+
+  uint8_t leds = pgm_read_byte(&layer_leds[biton32(state)]);
+
+  if (leds != applied_leds) {
+    apply_leds(leds, leds ^ applied_leds);
+  }
+  return state;
+}
+
 // Runs just one time when the keyboard initializes.
 void matrix_init_user(void) {
-
+  host_profile_init();
+  show_host_profile();
+  usage_layer_state(layer_state);
+  apply_leds(pgm_read_byte(&layer_leds[NEO_1]), 0xFF);
 };
 
 
 // Runs constantly in the background, in a loop.
 void matrix_scan_user(void) {
-    uint8_t layer = biton32(layer_state);
-
-    ergodox_board_led_off();
-    ergodox_right_led_1_off();
-    ergodox_right_led_2_off();
-    ergodox_right_led_3_off();
-    switch (layer) {
-      // TODO: Make this relevant to the ErgoDox EZ.
-        case 1:
-            ergodox_right_led_1_on();
-            break;
-        case 2:
-            ergodox_right_led_2_on();
-            break;
-        default:
-            // none
-            break;
-    }
+  tap_hold_task();
+  report_queue_task();
+  key_repeat_task();
+  snippet_task();
+  recorder_task();
 };
@@ -0,0 +1,44 @@
+#include "keymap_sparse.h"
+#include "sparse_layers.h"
+
+extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
+
+#define LAYER_SLOT(layer) (LAYER_IS_SPARSE(layer) ? SPARSE_SLOT | SPARSE_LAYERS_BELOW(layer) : KEYMAP_SLOT(layer))
+
+// Where each layer is stored, so the layers keep their numbers
+static const uint8_t PROGMEM layer_slots[LAYER_COUNT] = {
+  [NEO_1] = LAYER_SLOT(NEO_1),
+  [NEO_3] = LAYER_SLOT(NEO_3),
+  [NEO_4] = LAYER_SLOT(NEO_4),
+  [NEO_5] = LAYER_SLOT(NEO_5),
+  [NEO_6] = LAYER_SLOT(NEO_6),
+  [US_1]  = LAYER_SLOT(US_1),
+  [FKEYS] = LAYER_SLOT(FKEYS),
+};
+
+// Number of set bits in a row of up to five columns
+static const uint8_t PROGMEM bit_count[32] = {
+  0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+  1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
+};
+
+uint16_t sparse_layer_keycode(const sparse_layer_t* layer, uint8_t row, uint8_t col) {
+  uint8_t columns = pgm_read_byte(&layer->columns[row]);
+
+  if (!(columns & (1 << col))) {
+    return pgm_read_word(&layer->fill);
+  }
+
+  uint16_t index = pgm_read_word(&layer->base) + pgm_read_byte(&layer->offsets[row]) +
+                   pgm_read_byte(&bit_count[columns & ((1 << col) - 1)]);
+  return pgm_read_word(&sparse_keycodes[index]);
+}
+
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
+  uint8_t slot = pgm_read_byte(&layer_slots[layer]);
+
+  if (!(slot & SPARSE_SLOT)) {
+    return pgm_read_word(&keymaps[slot][key.row][key.col]);
+  }
+  return sparse_layer_keycode(&sparse_layers[slot & ~SPARSE_SLOT], key.row, key.col);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include QMK_KEYBOARD_H
+#include "layers.h"
+
+// A layer that stores only the positions whose keycode differs from a fill
+// value. Bit c of columns[r] is set if (r, c) has its own keycode. Those
+// keycodes are packed row by row into sparse_keycodes[], starting at base;
+// offsets[r] is the index of the first one in row r, relative to base.
+typedef struct {
+  uint16_t fill;
+  uint16_t base;
+  uint8_t columns[MATRIX_ROWS];
+  uint8_t offsets[MATRIX_ROWS];
+} sparse_layer_t;
+
+uint16_t sparse_layer_keycode(const sparse_layer_t* layer, uint8_t row, uint8_t col);
+
+// Entry of a sparse layer in layer_slots[]: its index in sparse_layers[]
+// with this bit set. A dense layer has its index in keymaps[].
+#define SPARSE_SLOT 0x80
+
+// Dense lookup for the layers in keymaps[], sparse for the others
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key);
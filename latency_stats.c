@@ -0,0 +1,58 @@
+#include <string.h>
+#include "latency_stats.h"
+
+latency_histogram_t latency_histograms[LATENCY_CLASSES];
+
+static uint8_t open_class = LATENCY_NONE;
+static uint16_t open_time;
+
+static uint8_t latency_bucket(uint16_t ms) {
+  uint8_t bucket = 0;
+
+  while (ms > 0 && bucket < LATENCY_BUCKETS - 1) {
+    ms >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+void latency_event(uint8_t latency_class, uint16_t time) {
+  open_class = latency_class;
+  open_time = time;
+}
+
+// Event times have their lowest bit set, so that 0 means no event
+void latency_record(uint8_t latency_class, uint16_t time) {
+  uint16_t now = timer_read() | 1;
+  uint16_t ms = now - time;
+  latency_histogram_t *histogram = &latency_histograms[latency_class];
+  uint8_t bucket = latency_bucket(ms);
+
+  if (histogram->count < 0xFFFF) histogram->count++;
+  if (ms > histogram->max) histogram->max = ms;
+  if (histogram->buckets[bucket] < 0xFFFF) histogram->buckets[bucket]++;
+}
+
+void latency_output(void) {
+  if (open_class != LATENCY_NONE) {
+    latency_record(open_class, open_time);
+    open_class = LATENCY_NONE;
+  }
+}
+
+void latency_discard(void) {
+  open_class = LATENCY_NONE;
+}
+
+uint8_t latency_take(uint16_t *time) {
+  uint8_t latency_class = open_class;
+
+  *time = open_time;
+  open_class = LATENCY_NONE;
+  return latency_class;
+}
+
+void latency_reset(void) {
+  memset(latency_histograms, 0, sizeof(latency_histograms));
+  open_class = LATENCY_NONE;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "quantum.h"
+
+// Key-to-report latency, built with LATENCY_STATS_ENABLE (see rules.mk).
+//
+// A key press opens a measurement with the time the matrix saw it. The
+// measurement closes when the first HID report it causes is sent, directly
+// or from the report queue, or when it changes layer_state. The time in
+// between goes into a log2 histogram in ms for the class of the key. Keys
+// without output of their own, such as an undecided dual-role key, are not
+// counted.
+enum latency_classes {
+  LATENCY_PLAIN,        // basic keys and modifiers
+  LATENCY_MACRO,        // NEO2_* streams and mod-wrapped keycodes
+  LATENCY_TAP_HOLD,     // dual-role keys, from their press to the decision
+  LATENCY_LAYER,        // layer keys, to the layer change
+  LATENCY_CLASSES,
+  LATENCY_NONE = 0xFF
+};
+
+// Buckets 0, 1, 2-3, 4-7, ... 256 ms and more
+#define LATENCY_BUCKETS 10
+
+typedef struct {
+  uint16_t count;
+  uint16_t max;         // ms
+  uint16_t buckets[LATENCY_BUCKETS];   // saturating
+} latency_histogram_t;
+
+extern latency_histogram_t latency_histograms[LATENCY_CLASSES];
+
+#ifdef LATENCY_STATS_ENABLE
+// Open a measurement for the event at time, replacing any open one.
+void latency_event(uint8_t latency_class, uint16_t time);
+// The open event produced output now.
+void latency_output(void);
+// The open event has no output of its own.
+void latency_discard(void);
+// Hand the open measurement over to a queued report; returns LATENCY_NONE
+// if there is none.
+uint8_t latency_take(uint16_t *time);
+// Record a measurement handed over by latency_take().
+void latency_record(uint8_t latency_class, uint16_t time);
+void latency_reset(void);
+#else
+#define latency_event(latency_class, time)
+#define latency_output()
+#define latency_discard()
+#endif
@@ -0,0 +1,99 @@
+#include <string.h>
+#include "layer_hold.h"
+
+static uint8_t hold_counts[LAYER_COUNT];
+static uint8_t locked_layers;
+// Lock toggles waiting for the last key holding their layer to be released
+static uint8_t lock_toggles;
+
+// Taps of the last tap toggle key, counted per key as TT() counts them
+static struct {
+  keypos_t key;
+  uint8_t count;
+  uint16_t time;            // of its last press or release
+} taps;
+
+// A key holding a locked layer releases it, as TT() does
+static bool layer_held(uint8_t layer) {
+  if (locked_layers & (1 << layer)) {
+    return hold_counts[layer] == 0;
+  }
+  return hold_counts[layer] > 0;
+}
+
+// Change layer_state only when the layer goes from released to held or back.
+static void update_layer(uint8_t layer, bool was_held) {
+  bool held = layer_held(layer);
+
+  if (held && !was_held) {
+    layer_on(layer);
+  } else if (!held && was_held) {
+    layer_off(layer);
+  }
+}
+
+void layer_hold_press(uint8_t layer) {
+  bool was_held = layer_held(layer);
+
+  if (hold_counts[layer] < 0xFF) hold_counts[layer]++;
+  update_layer(layer, was_held);
+}
+
+void layer_hold_release(uint8_t layer) {
+  bool was_held = layer_held(layer);
+
+  if (hold_counts[layer] > 0) hold_counts[layer]--;
+  if (hold_counts[layer] == 0) {
+    locked_layers ^= lock_toggles & (1 << layer);
+    lock_toggles &= ~(1 << layer);
+  }
+  update_layer(layer, was_held);
+}
+
+void layer_hold_lock(uint8_t layer) {
+  bool was_held = layer_held(layer);
+
+  if (hold_counts[layer] > 0) {
+    lock_toggles ^= (1 << layer);
+    return;
+  }
+  locked_layers ^= (1 << layer);
+  update_layer(layer, was_held);
+}
+
+void layer_hold_tap_toggle(uint8_t layer, keyrecord_t *record) {
+  keypos_t key = record->event.key;
+  bool in_term = key.row == taps.key.row && key.col == taps.key.col &&
+    (uint16_t)(record->event.time - taps.time) < TAPPING_TERM;
+
+  taps.key = key;
+  taps.time = record->event.time;
+  if (record->event.pressed) {
+    if (!in_term) {
+      taps.count = 0;
+    }
+    layer_hold_press(layer);
+    return;
+  }
+  taps.count = in_term ? taps.count + 1 : 0;
+  if (taps.count == TAPPING_TOGGLE) {
+    taps.count = 0;
+    layer_hold_lock(layer);
+  }
+  layer_hold_release(layer);
+}
+
+void layer_hold_interrupt(void) {
+  taps.count = 0;
+}
+
+uint8_t layer_hold_count(uint8_t layer) {
+  return hold_counts[layer];
+}
+
+void layer_hold_reset(void) {
+  memset(hold_counts, 0, sizeof(hold_counts));
+  locked_layers = 0;
+  lock_toggles = 0;
+  memset(&taps, 0, sizeof(taps));
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "quantum.h"
+#include "layers.h"
+
+// Momentary layer holds, counted per layer. Any number of keys can hold the
+// same layer; it turns on with the first hold and off with the last release,
+// so rollover between them never changes layer_state in between. A locked
+// layer stays on without any key holding it, and is off while one does.
+//
+// Press and release have to be called in pairs for the same layer, which the
+// source layer cache of QMK guarantees for keycodes from the keymap.
+void layer_hold_press(uint8_t layer);
+void layer_hold_release(uint8_t layer);
+// Toggle the lock once the last key holding the layer is released, at once
+// if none does.
+void layer_hold_lock(uint8_t layer);
+// TT() on top of the holds: the key holds the layer, and TAPPING_TOGGLE taps
+// in a row of the same key, each within TAPPING_TERM, toggle the lock.
+void layer_hold_tap_toggle(uint8_t layer, keyrecord_t *record);
+// Another key went down, the taps of a tap toggle key start over. Called
+// with the keys in the order they are decided.
+void layer_hold_interrupt(void);
+// Keys currently holding the layer
+uint8_t layer_hold_count(uint8_t layer);
+// Forget every hold and lock, without touching layer_state
+void layer_hold_reset(void);
@@ -5,3 +5,20 @@
 #define NEO_6   4      // layer_4
 #define US_1    5      // layer_5
 #define FKEYS   6      // layer_6
+
+#define LAYER_COUNT 7
+
+// These layers are mostly transparent or empty and are stored in
+// sparse_layers.h when SPARSE_LAYERS_ENABLE is set, see keymap_sparse.h.
+#define LAYER_IS_SPARSE(layer)      ((layer) == NEO_5 || (layer) == NEO_6 || (layer) == FKEYS)
+#define SPARSE_LAYER_COUNT          3
+// Sparse layers below a layer
+#define SPARSE_LAYERS_BELOW(layer)  (((layer) > NEO_5) + ((layer) > NEO_6) + ((layer) > FKEYS))
+
+// Index of a layer in keymaps[]. Without the sparse layers in it, the dense
+// layers above them move down.
+#if defined(SPARSE_LAYERS_ENABLE) && !defined(SPARSE_LAYERS_SOURCE)
+#define KEYMAP_SLOT(layer)          ((layer) - SPARSE_LAYERS_BELOW(layer))
+#else
+#define KEYMAP_SLOT(layer)          (layer)
+#endif
@@ -0,0 +1,255 @@
+#include <string.h>
+#include QMK_KEYBOARD_H
+#include "recorder.h"
+#include "report_stream.h"
+#include "tap_hold.h"
+
+#define EVENT_RELEASE   0x80
+#define EVENT_LAYER     0x70
+#define EVENT_TAP       0x78
+
+#if MATRIX_ROWS * MATRIX_COLS > EVENT_LAYER
+#error "Matrix positions do not fit the recorder's event bytes"
+#endif
+
+recorder_stats_t recorder_stats;
+
+static uint8_t ring[RECORDER_SIZE];
+static uint16_t ring_head;
+static uint16_t ring_length;
+
+static bool recording;
+// Layer of the last press recorded
+static uint8_t record_layer;
+
+// Keys down in the recording, or in the replay, with the layer of their press
+typedef struct {
+  uint8_t position;
+  uint8_t layer;
+} held_key_t;
+
+static held_key_t held[RECORDER_KEYS];
+static uint8_t held_count;
+
+static bool playing;
+static bool replaying;
+// Bytes of the recording replayed so far
+static uint16_t play_offset;
+static uint8_t play_layer;
+// When the last replayed event had output
+static uint16_t play_timer;
+
+static uint8_t position_of(keypos_t key) {
+  return key.row * MATRIX_COLS + key.col;
+}
+
+static bool is_layer(uint8_t byte) {
+  return byte >= EVENT_LAYER && byte < EVENT_TAP;
+}
+
+static uint8_t ring_at(uint16_t offset) {
+  return ring[(ring_head + offset) % RECORDER_SIZE];
+}
+
+// Drop the oldest event. The layer byte before it stays, as it still
+// applies to the presses after it.
+static void drop_oldest(void) {
+  uint16_t offset = 0;
+  uint8_t layer = 0;
+
+  while (offset < ring_length && is_layer(ring_at(offset))) {
+    layer = ring_at(offset++);
+  }
+  if (offset < ring_length) {
+    offset += ring_at(offset) == EVENT_TAP ? 2 : 1;
+    recorder_stats.events--;
+    recorder_stats.dropped++;
+  }
+  if (layer) {
+    ring[(ring_head + --offset) % RECORDER_SIZE] = layer;
+  }
+  ring_head = (ring_head + offset) % RECORDER_SIZE;
+  ring_length -= offset;
+}
+
+static void ring_put(uint8_t byte) {
+  while (ring_length == RECORDER_SIZE) {
+    drop_oldest();
+  }
+  ring[(ring_head + ring_length++) % RECORDER_SIZE] = byte;
+  recorder_stats.bytes = ring_length;
+}
+
+static void put_layer(uint8_t layer) {
+  if (layer != record_layer) {
+    ring_put(EVENT_LAYER + layer);
+    record_layer = layer;
+  }
+}
+
+// Remove a key from the held keys, returns false if it is not one of them
+static bool held_remove(uint8_t position, uint8_t *layer) {
+  for (uint8_t i = 0; i < held_count; i++) {
+    if (held[i].position == position) {
+      if (layer) *layer = held[i].layer;
+      held[i] = held[--held_count];
+      return true;
+    }
+  }
+  return false;
+}
+
+void recorder_event(keyrecord_t *record) {
+  uint8_t position = position_of(record->event.key);
+
+  if (!recording) {
+    return;
+  }
+  if (record->event.pressed) {
+    uint8_t layer = layer_switch_get_layer(record->event.key);
+
+    // Neither the press nor its release are recorded
+    if (held_count == RECORDER_KEYS) {
+      return;
+    }
+    held[held_count++] = (held_key_t) { .position = position, .layer = layer };
+    put_layer(layer);
+    ring_put(position);
+  } else {
+    // Pressed before the recording started
+    if (!held_remove(position, NULL)) {
+      return;
+    }
+    ring_put(EVENT_RELEASE | position);
+  }
+  recorder_stats.events++;
+}
+
+void recorder_tap(keypos_t key) {
+  if (!recording) {
+    return;
+  }
+  put_layer(layer_switch_get_layer(key));
+  ring_put(EVENT_TAP);
+  ring_put(position_of(key));
+  recorder_stats.events++;
+}
+
+void recorder_toggle(void) {
+  if (playing) {
+    return;
+  }
+  if (!recording) {
+    recording = true;
+    ring_head = 0;
+    ring_length = 0;
+    record_layer = 0;
+    held_count = 0;
+    recorder_stats.events = 0;
+    recorder_stats.bytes = 0;
+    recorder_stats.dropped = 0;
+    return;
+  }
+
+  while (held_count > 0) {
+    ring_put(EVENT_RELEASE | held[--held_count].position);
+    recorder_stats.events++;
+  }
+  recording = false;
+}
+
+void recorder_replay(void) {
+  if (recording || playing || !ring_length) {
+    return;
+  }
+  playing = true;
+  play_offset = 0;
+  play_layer = 0;
+  held_count = 0;
+  play_timer = timer_read() - REPORT_QUEUE_INTERVAL;
+}
+
+bool recorder_recording(void) {
+  return recording;
+}
+
+bool recorder_replaying(void) {
+  return replaying;
+}
+
+// Process an event as the core would for the keycode on the given layer
+static void dispatch(uint8_t position, uint8_t layer, bool pressed) {
+  keyrecord_t record = {
+    .event = {
+      .key = { .row = position / MATRIX_COLS, .col = position % MATRIX_COLS },
+      .pressed = pressed,
+      .time = timer_read() | 1,
+    },
+  };
+  uint16_t keycode = keymap_key_to_keycode(layer, record.event.key);
+
+  replaying = true;
+  if (process_record_user(keycode, &record)) {
+    process_action(&record, action_for_key(layer, record.event.key));
+  }
+  replaying = false;
+  recorder_stats.replayed++;
+}
+
+// Replay the next event, returns false at the end of the recording
+static bool replay_next(void) {
+  while (play_offset < ring_length) {
+    uint8_t byte = ring_at(play_offset++);
+    uint8_t layer;
+
+    if (byte & EVENT_RELEASE) {
+      // The press may have been dropped with the oldest events
+      if (held_remove(byte & ~EVENT_RELEASE, &layer)) {
+        dispatch(byte & ~EVENT_RELEASE, layer, false);
+        return true;
+      }
+    } else if (byte == EVENT_TAP) {
+      keypos_t key = { .row = ring_at(play_offset) / MATRIX_COLS, .col = ring_at(play_offset) % MATRIX_COLS };
+
+      play_offset++;
+      tap_hold_tap(keymap_key_to_keycode(play_layer, key));
+      recorder_stats.replayed++;
+      return true;
+    } else if (is_layer(byte)) {
+      play_layer = byte - EVENT_LAYER;
+    } else if (held_count < RECORDER_KEYS) {
+      held[held_count++] = (held_key_t) { .position = byte, .layer = play_layer };
+      dispatch(byte, play_layer, true);
+      return true;
+    }
+  }
+  return false;
+}
+
+void recorder_task(void) {
+  if (!playing || !report_queue_idle() || timer_elapsed(play_timer) < REPORT_QUEUE_INTERVAL) {
+    return;
+  }
+
+  // Events without output, such as layer keys, go out together with the
+  // next one that has some
+  report_keyboard_t sent = *keyboard_report;
+
+  while (replay_next()) {
+    if (report_queue_busy() || memcmp(&sent, keyboard_report, sizeof(sent)) != 0) {
+      play_timer = timer_read();
+      return;
+    }
+  }
+  playing = false;
+}
+
+void recorder_reset(void) {
+  recording = false;
+  playing = false;
+  replaying = false;
+  ring_head = 0;
+  ring_length = 0;
+  held_count = 0;
+  memset(&recorder_stats, 0, sizeof(recorder_stats));
+}
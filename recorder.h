@@ -0,0 +1,58 @@
+#pragma once
+
+#include "quantum.h"
+
+// Dynamic macros: key events recorded into RAM and replayed on request.
+//
+// Events are recorded as the keymap sees them once dual-role keys are
+// decided, layer keys and NEO2_* macros included. Each one is stored as its
+// matrix position and the layer its keycode comes from, so a replay types
+// the same keys whatever layers are active when it starts. The encoding is
+// one byte per event in the common case:
+//
+//   0ppppppp   press of position p, resolved on the current layer
+//   1ppppppp   release of position p, resolved on the layer of its press
+//   0x70 + l   the presses from here on resolve on layer l
+//   0x78, p    tap of the dual-role key at position p
+//
+// Layer bytes are only stored when the layer differs from the press before.
+// The recording is a ring: once it is full, the oldest events make room.
+//
+// A replay goes out as fast as the host takes reports, not at typing speed:
+// from matrix_scan_user, events are processed until one of them has output,
+// then the replay waits for the next poll interval. Keys pressed meanwhile
+// are processed as usual.
+#ifndef RECORDER_SIZE
+#define RECORDER_SIZE 1024          // bytes, about one per key event
+#endif
+#ifndef RECORDER_KEYS
+#define RECORDER_KEYS 16            // keys down at once in a recording
+#endif
+
+typedef struct {
+  uint16_t events;                  // in the recording
+  uint16_t bytes;                   // of the recording
+  uint16_t dropped;                 // oldest events overwritten
+  uint32_t replayed;                // events sent by replays
+} recorder_stats_t;
+
+extern recorder_stats_t recorder_stats;
+
+// Start a recording, or end the one running. Keys still down at the end are
+// released in the recording.
+void recorder_toggle(void);
+// Replay the last recording, unless a recording or a replay is running
+void recorder_replay(void);
+bool recorder_recording(void);
+// True while a replayed event is processed
+bool recorder_replaying(void);
+
+// Record a decided key event
+void recorder_event(keyrecord_t *record);
+// Record the tap of a dual-role key, see tap_hold.h
+void recorder_tap(keypos_t key);
+
+// Play the replay, from matrix_scan_user
+void recorder_task(void);
+// Drop the recording and a replay, and clear the statistics
+void recorder_reset(void);
@@ -0,0 +1,251 @@
+#include "report_stream.h"
+#include "latency_stats.h"
+#include "debug.h"
+
+enum report_queue_ops {
+  QUEUE_REPORT,         // send a report with the given modifiers and key
+  QUEUE_REGISTER,       // register_code(key)
+  QUEUE_UNREGISTER,     // unregister_code(key)
+  QUEUE_MODIFIED_UP     // release a mod-wrapped key pressed outside the queue
+};
+
+typedef struct {
+  uint8_t op;
+  uint8_t mods;
+  uint8_t key;
+#ifdef LATENCY_STATS_ENABLE
+  uint8_t latency_class;  // of the key press whose first report this is
+  uint16_t event_time;
+#endif
+} queued_report_t;
+
+report_queue_stats_t report_queue_stats;
+
+static queued_report_t report_queue[REPORT_QUEUE_SIZE];
+static uint8_t queue_head;
+static uint8_t queue_length;
+static uint16_t queue_timer;
+// Time the report sent last stays out before the next one
+static uint16_t queue_interval = REPORT_QUEUE_INTERVAL;
+// Modifiers as they will be once everything queued so far has been sent
+static uint8_t queue_mods;
+// Weak modifiers that queued QUEUE_MODIFIED_UP entries take out
+static uint8_t queue_weak_up;
+// Key held by the QUEUE_REPORT entry sent last
+static uint8_t queue_key = KC_NO;
+
+static void send_queued_report(const queued_report_t *entry) {
+  switch (entry->op) {
+    case QUEUE_REPORT:
+      if (entry->key != queue_key) {
+        if (queue_key != KC_NO) del_key(queue_key);
+        if (entry->key != KC_NO) add_key(entry->key);
+        queue_key = entry->key;
+      }
+      keyboard_report->mods = entry->mods;
+      host_keyboard_send(keyboard_report);
+      break;
+    case QUEUE_REGISTER:
+      register_code(entry->key);
+      break;
+    case QUEUE_UNREGISTER:
+      unregister_code(entry->key);
+      break;
+    case QUEUE_MODIFIED_UP:
+      del_key(entry->key);
+      del_weak_mods(entry->mods);
+      send_keyboard_report();
+      break;
+  }
+}
+
+static void report_queue_pop(void) {
+  send_queued_report(&report_queue[queue_head]);
+#ifdef LATENCY_STATS_ENABLE
+  if (report_queue[queue_head].latency_class != LATENCY_NONE) {
+    latency_record(report_queue[queue_head].latency_class, report_queue[queue_head].event_time);
+  }
+#endif
+  // macOS ignores shorter Caps Lock presses
+  queue_interval = report_queue[queue_head].op == QUEUE_REPORT && report_queue[queue_head].key == KC_CAPSLOCK
+                   ? REPORT_QUEUE_CAPS_HOLD : REPORT_QUEUE_INTERVAL;
+  queue_head = (queue_head + 1) % REPORT_QUEUE_SIZE;
+  queue_length--;
+  queue_timer = timer_read();
+}
+
+static void report_queue_push(uint8_t op, uint8_t mods, uint8_t key) {
+  if (queue_length == 0) {
+    queue_mods = get_mods();
+    queue_weak_up = 0;
+  }
+  if (queue_length == REPORT_QUEUE_SIZE) {
+    report_queue_stats.overflows++;
+    dprintf("report queue overflow\n");
+    report_queue_flush();
+  }
+
+  queued_report_t *entry = &report_queue[(queue_head + queue_length) % REPORT_QUEUE_SIZE];
+  entry->op = op;
+  entry->mods = mods;
+  entry->key = key;
+#ifdef LATENCY_STATS_ENABLE
+  entry->latency_class = latency_take(&entry->event_time);
+#endif
+  queue_length++;
+  report_queue_stats.queued++;
+  if (queue_length > report_queue_stats.max_depth) report_queue_stats.max_depth = queue_length;
+
+  if (op == QUEUE_MODIFIED_UP) {
+    queue_weak_up |= mods;
+  } else if (IS_MOD(key) && op != QUEUE_REPORT) {
+    if (op == QUEUE_REGISTER) {
+      queue_mods |= MOD_BIT(key);
+    } else {
+      queue_mods &= ~MOD_BIT(key);
+    }
+  }
+}
+
+// Sends the first report of a stream right away if nothing was pending before.
+static void report_queue_start(bool was_idle) {
+  if (was_idle) {
+    report_queue_pop();
+  } else {
+    report_queue_task();
+  }
+}
+
+void report_queue_task(void) {
+  if (queue_length > 0 && timer_elapsed(queue_timer) >= queue_interval) {
+    report_queue_pop();
+  }
+}
+
+void report_queue_flush(void) {
+  while (queue_length > 0) {
+    if (timer_elapsed(queue_timer) < queue_interval && queue_interval > REPORT_QUEUE_INTERVAL) {
+      wait_ms(queue_interval - timer_elapsed(queue_timer));
+    }
+    report_queue_pop();
+  }
+}
+
+bool report_queue_busy(void) {
+  return queue_length > 0;
+}
+
+bool report_queue_idle(void) {
+  return queue_length == 0 && timer_elapsed(queue_timer) >= queue_interval;
+}
+
+uint8_t report_queue_mods(void) {
+  return queue_length > 0 ? queue_mods : get_mods();
+}
+
+bool process_report_queue(uint16_t keycode, keyrecord_t *record) {
+  if (queue_length == 0 || !(IS_KEY(keycode) || IS_MOD(keycode))) {
+    return true;
+  }
+
+  report_queue_push(record->event.pressed ? QUEUE_REGISTER : QUEUE_UNREGISTER, 0, keycode);
+  return false;
+}
+
+// Modifiers held or implied once the queue has drained, as
+// send_keyboard_report would send them
+static uint8_t report_modifiers(void) {
+  uint8_t weak_mods = get_weak_mods();
+
+  if (queue_length > 0) weak_mods &= ~queue_weak_up;
+  return report_queue_mods() | weak_mods;
+}
+
+static uint8_t stream_byte(const uint8_t *byte, bool in_flash) {
+  return in_flash ? pgm_read_byte(byte) : *byte;
+}
+
+static void queue_stream(const report_stream_t *stream, uint8_t hidden_modifiers, bool in_flash) {
+  uint8_t length = stream_byte(&stream->length, in_flash);
+  bool was_idle = !report_queue_busy();
+
+  for (uint8_t i = 0; i < length; i++) {
+    uint8_t modifiers = stream_byte(&stream->reports[i][0], in_flash);
+    uint8_t key = stream_byte(&stream->reports[i][1], in_flash);
+
+    if (i + 1 == length) hidden_modifiers = 0;
+    report_queue_push(QUEUE_REPORT, (report_modifiers() & ~hidden_modifiers) | modifiers, key);
+  }
+  if (length > 0) report_queue_start(was_idle);
+}
+
+void send_report_stream(const report_stream_t *stream, uint8_t hidden_modifiers) {
+  queue_stream(stream, hidden_modifiers, true);
+}
+
+void send_report_stream_ram(const report_stream_t *stream, uint8_t hidden_modifiers) {
+  queue_stream(stream, hidden_modifiers, false);
+}
+
+void send_modified_tap(uint8_t key, uint8_t modifiers) {
+  bool was_idle = !report_queue_busy();
+
+  report_queue_push(QUEUE_REPORT, report_modifiers() | modifiers, key);
+  report_queue_push(QUEUE_REPORT, report_modifiers(), KC_NO);
+  report_queue_start(was_idle);
+}
+
+// Report modifiers of a mod-wrapped keycode. Right hand modifiers live in
+// the upper nibble of the report.
+static uint8_t keycode_modifiers(uint16_t keycode) {
+  uint8_t modifiers = (keycode >> 8) & 0x1F;
+
+  return (modifiers & 0x10) ? (modifiers & 0x0F) << 4 : modifiers;
+}
+
+void send_keycode_tap(uint16_t keycode) {
+  send_modified_tap(keycode & 0xFF, keycode_modifiers(keycode));
+}
+
+static bool in_report(uint8_t key) {
+  for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+    if (keyboard_report->keys[i] == key) return true;
+  }
+  return false;
+}
+
+bool process_modified_key(uint16_t keycode, keyrecord_t *record) {
+  uint8_t key = keycode & 0xFF;
+  uint8_t modifiers = keycode_modifiers(keycode);
+
+  if (keycode < QK_MODS || keycode > QK_MODS_MAX || !IS_KEY(key)) {
+    return true;
+  }
+
+  if (report_queue_busy()) {
+    if (record->event.pressed) {
+      report_queue_push(QUEUE_REPORT, report_modifiers() | modifiers, key);
+    } else if (key != queue_key && in_report(key)) {
+      // Pressed while the queue was idle: its key and weak modifiers are
+      // in the report, take them out in turn
+      report_queue_push(QUEUE_MODIFIED_UP, modifiers, key);
+    } else {
+      report_queue_push(QUEUE_REPORT, report_modifiers(), KC_NO);
+    }
+    return false;
+  }
+
+  if (record->event.pressed) {
+    add_weak_mods(modifiers);
+    add_key(key);
+  } else {
+    del_key(key);
+    del_weak_mods(modifiers);
+    // Pressed while the queue was busy, the queue no longer holds it
+    if (key == queue_key) queue_key = KC_NO;
+  }
+  send_keyboard_report();
+  latency_output();
+
+  return false;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "quantum.h"
+
+// Longest report sequence a single key can send
+#define REPORT_STREAM_MAX 10
+
+// A ready-to-send sequence of HID reports. Every entry is one report, given
+// as { modifiers, key }; the modifiers are added to the ones already held.
+typedef struct {
+  uint8_t length;
+  uint8_t reports[REPORT_STREAM_MAX][2];
+} report_stream_t;
+
+#define REPORT_STREAM(...)    { .length = sizeof((uint8_t[][2]) { __VA_ARGS__ }) / 2, .reports = { __VA_ARGS__ } }
+#define REPORT_STREAM_NONE    { .length = 0 }
+
+// Building blocks for the streams. A tap sends its modifiers and key in one
+// report and releases them together. Dead keys press the modifiers in a report
+// of their own first, macOS drops the dead key state otherwise.
+#define RS_SHIFT                MOD_BIT(KC_LSHIFT)
+#define RS_ALT                  MOD_BIT(KC_LALT)
+#define RS_ALT_SHIFT            (RS_ALT|RS_SHIFT)
+
+#define RS_TAP(key)             { 0, key }, { 0, KC_NO }
+#define RS_MOD_TAP(mods, key)   { mods, key }, { 0, KC_NO }
+#define RS_SHIFT_TAP(key)       RS_MOD_TAP(RS_SHIFT, key)
+#define RS_ALT_TAP(key)         RS_MOD_TAP(RS_ALT, key)
+#define RS_ALT_SHIFT_TAP(key)   RS_MOD_TAP(RS_ALT_SHIFT, key)
+#define RS_DEAD_TAP(mods, key)  { mods, KC_NO }, { mods, key }, { 0, KC_NO }
+
+// Queue a stream from flash, one report per entry. The hidden modifiers are
+// masked out of every report but the last one, which hands the physical
+// modifier state back to the host. The modifier state itself is never changed.
+void send_report_stream(const report_stream_t *stream, uint8_t hidden_modifiers);
+// The same for a stream built in RAM
+void send_report_stream_ram(const report_stream_t *stream, uint8_t hidden_modifiers);
+
+// Queue a tap of a basic key with extra modifiers: one report to press, one
+// to release.
+void send_modified_tap(uint8_t key, uint8_t modifiers);
+// The same for a basic or mod-wrapped keycode such as LSFT(KC_2)
+void send_keycode_tap(uint16_t keycode);
+
+// Press and release a mod-wrapped keycode such as LSFT(KC_9) with one report
+// each, instead of separate reports for the modifiers and the key.
+bool process_modified_key(uint16_t keycode, keyrecord_t *record);
+
+// Output queue. Queued reports are sent from matrix_scan_user, one per host
+// poll interval, so the matrix keeps being scanned while a stream plays.
+// Basic keycodes that come in while reports are pending are queued behind
+// them to keep the output in order.
+#ifndef REPORT_QUEUE_SIZE
+#define REPORT_QUEUE_SIZE 16
+#endif
+#ifndef REPORT_QUEUE_INTERVAL
+#define REPORT_QUEUE_INTERVAL 1   // ms, the keyboard endpoint poll interval
+#endif
+// A queued report that presses Caps Lock stays out this long before the next
+#ifndef REPORT_QUEUE_CAPS_HOLD
+#define REPORT_QUEUE_CAPS_HOLD 100  // ms
+#endif
+
+typedef struct {
+  uint8_t max_depth;      // most reports pending at once
+  uint16_t overflows;     // times a full queue had to be flushed synchronously
+  uint32_t queued;        // reports that went through the queue
+} report_queue_stats_t;
+
+extern report_queue_stats_t report_queue_stats;
+
+// Send the next pending report once the previous one had time to go out.
+void report_queue_task(void);
+// Send everything pending right away, blocking on the endpoint and for
+// the Caps Lock hold.
+void report_queue_flush(void);
+bool report_queue_busy(void);
+// Nothing pending and the last queued report had its poll interval, so a
+// report sent now goes out without waiting on the endpoint
+bool report_queue_idle(void);
+// Modifiers that will be held once the queue has drained
+uint8_t report_queue_mods(void);
+// Queue basic keycodes while reports are pending. Returns false if queued.
+bool process_report_queue(uint16_t keycode, keyrecord_t *record);
@@ -0,0 +1,35 @@
+SRC += report_stream.c tap_hold.c layer_hold.c combo.c compose.c host_profile.c key_repeat.c snippets.c recorder.c
+
+# The LCD status screen shows the host profile, handed over as visualizer
+# user data, see status_screen.h
+OPT_DEFS += -DVISUALIZER_USER_DATA_SIZE=1
+
+# Store the mostly empty layers sparsely, see keymap_sparse.h
+SPARSE_LAYERS_ENABLE = yes
+
+ifeq ($(strip $(SPARSE_LAYERS_ENABLE)), yes)
+  OPT_DEFS += -DSPARSE_LAYERS_ENABLE
+  SRC += keymap_sparse.c
+endif
+
+# Key-to-report latency histograms, read out over raw HID, see latency_stats.h
+LATENCY_STATS_ENABLE = no
+
+ifeq ($(strip $(LATENCY_STATS_ENABLE)), yes)
+  OPT_DEFS += -DLATENCY_STATS_ENABLE
+  RAW_ENABLE = yes
+  SRC += latency_stats.c
+endif
+
+# Key, macro and layer usage counters, read out over raw HID, see usage_stats.h
+USAGE_STATS_ENABLE = no
+
+ifeq ($(strip $(USAGE_STATS_ENABLE)), yes)
+  OPT_DEFS += -DUSAGE_STATS_ENABLE
+  RAW_ENABLE = yes
+  SRC += usage_stats.c
+endif
+
+ifeq ($(strip $(RAW_ENABLE)), yes)
+  SRC += hid_commands.c
+endif
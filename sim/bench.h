@@ -0,0 +1,26 @@
+// Benchmarks run by neo2sim
+#pragma once
+
+#include "sim.h"
+
+int bench_corpus(int argc, char** argv);
+int bench_lcd(int argc, char** argv);
+int bench_compose(int argc, char** argv);
+int bench_repeat(int argc, char** argv);
+int bench_snippets(int argc, char** argv);
+int bench_recorder(int argc, char** argv);
+// neo2sim snippet-trie: print snippet_trie.h for the current keymap
+int print_snippet_trie(int argc, char** argv);
+// neo2sim glyph-forms: print glyph_forms.h for the current keymap
+int print_glyph_forms(int argc, char** argv);
+// neo2sim latency: replay traces and print the latency histograms
+int latency(int argc, char** argv);
+void latency_print(const char* indent);
+// neo2sim heatmap: replay traces or type text, print the usage counters
+int heatmap(int argc, char** argv);
+// neo2sim fuzz: random key interleavings against the layer and modifier invariants
+int fuzz(int argc, char** argv);
+
+// Helpers shared by the benchmarks
+char* bench_read_file(const char* path);
+const char* bench_glyph_name(uint32_t codepoint);
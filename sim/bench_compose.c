@@ -0,0 +1,251 @@
+// Glyph forms: plays every candidate form of the glyph code points in
+// glyph_codepoints[] into the host model of each host profile and picks the
+// one with the fewest reports. `neo2sim glyph-forms` prints the result as
+// glyph_forms.h, `neo2sim bench-compose` checks the tables the firmware is
+// built with against it and types every glyph on every profile through the
+// keymap.
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "compose.h"
+#include "glyph_forms.h"
+#include "host.h"
+
+#define BASE_KEYS (KC_SLASH + 1)
+
+const host_model_t host_models[HOST_PROFILES] = {
+  [HOST_MACOS]     = { "macOS, ABC Extended", host_macos_reset, host_macos_report },
+  [HOST_MACOS_HEX] = { "macOS, Unicode Hex Input", host_macos_hex_reset, host_macos_report },
+  [HOST_LINUX]     = { "Linux, U.S. with Compose", host_linux_reset, host_linux_report },
+  [HOST_WINDOWS]   = { "Windows, U.S.-International", host_windows_reset, host_windows_report },
+};
+
+typedef struct {
+  uint32_t codepoint;
+  uint8_t reports;
+  uint16_t form;
+} route_t;
+
+static route_t* routes;
+static size_t route_count;
+
+// Readable form: the prefix taps and the base key as the U.S. layout
+// labels them
+static const char* form_name(uint8_t profile, uint16_t form) {
+  static char name[48];
+  const host_profile_t* host = &host_profiles[profile];
+  uint8_t prefix = form >> COMPOSE_PREFIX_OFFSET;
+  const char* option = host->option == MOD_BIT(KC_RALT) ? "AltGr-" : "Opt-";
+  size_t length = 0;
+
+  if (form == COMPOSE_NONE) return "none";
+  if (form == COMPOSE_HEX) return "hex";
+
+  name[0] = '\0';
+  for (uint8_t i = 0; prefix && i < HOST_PREFIX_TAPS; i++) {
+    uint8_t mods = host->prefixes[prefix - 1][i][0];
+    uint8_t key = host->prefixes[prefix - 1][i][1];
+
+    if (key == KC_NO) break;
+    if (key == KC_APPLICATION) {
+      length += snprintf(name + length, sizeof(name) - length, "Compose ");
+      continue;
+    }
+    if (mods & ~MOD_BIT(KC_LSHIFT)) length += snprintf(name + length, sizeof(name) - length, "%s", option);
+    length += snprintf(name + length, sizeof(name) - length, "%c ",
+                       (mods & MOD_BIT(KC_LSHIFT) ? host_us_shift_level : host_us_base_level)[key]);
+  }
+  snprintf(name + length, sizeof(name) - length, "%s%c", (form & COMPOSE_OPTION) ? option : "",
+           (form & COMPOSE_SHIFT ? host_us_shift_level : host_us_base_level)[form & 0xFF]);
+  return name;
+}
+
+// Character the host types for a form, 0 unless it is exactly one
+static uint32_t host_type(uint8_t profile, uint16_t form, uint16_t codepoint, uint8_t* reports) {
+  report_stream_t stream;
+
+  compose_stream(&host_profiles[profile], form, codepoint, &stream);
+  host_models[profile].reset();
+  for (uint8_t i = 0; i < stream.length; i++) {
+    report_keyboard_t report = { .mods = stream.reports[i][0], .keys = { stream.reports[i][1] } };
+    host_models[profile].report(0, &report);
+  }
+  *reports = stream.length;
+  if (host_output.glyphs != 1) return 0;
+
+  const char* text = host_output.text;
+  return utf8_next(&text);
+}
+
+static route_t* find_route(uint32_t codepoint) {
+  for (size_t i = 0; i < route_count; i++) {
+    if (routes[i].codepoint == codepoint) return &routes[i];
+  }
+  return NULL;
+}
+
+// The shortest chord or prefixed form of every character the host can
+// type, the first one found of equally short forms
+static void learn_routes(uint8_t profile) {
+  static const uint16_t modifiers[] = { 0, COMPOSE_SHIFT, COMPOSE_OPTION, COMPOSE_OPTION | COMPOSE_SHIFT };
+  const host_profile_t* host = &host_profiles[profile];
+
+  route_count = 0;
+  for (uint8_t prefix = 0; prefix <= HOST_PREFIXES; prefix++) {
+    if (prefix && host->prefixes[prefix - 1][0][1] == KC_NO) continue;
+    for (size_t m = 0; m < sizeof(modifiers) / sizeof(modifiers[0]); m++) {
+      if ((modifiers[m] & COMPOSE_OPTION) && !host->option) continue;
+      for (uint8_t key = KC_A; key < BASE_KEYS; key++) {
+        uint16_t form = COMPOSE_PREFIX(prefix, key) | modifiers[m];
+        uint8_t reports;
+        uint32_t codepoint = host_type(profile, form, 0, &reports);
+        route_t* route;
+
+        if (!codepoint) continue;
+        route = find_route(codepoint);
+        if (route && route->reports <= reports) continue;
+        if (!route) {
+          routes = realloc(routes, (route_count + 1) * sizeof(*routes));
+          route = &routes[route_count++];
+          route->codepoint = codepoint;
+        }
+        route->reports = reports;
+        route->form = form;
+      }
+    }
+  }
+}
+
+// Cheapest form of a code point: the learned route, or the hex form where
+// the host takes it and it is shorter. COMPOSE_NONE with 0 reports if the
+// host cannot type the code point at all.
+static uint16_t best_form(uint8_t profile, uint16_t codepoint, uint8_t* reports) {
+  const route_t* route = find_route(codepoint);
+  uint8_t hex_reports;
+
+  if (host_type(profile, COMPOSE_HEX, codepoint, &hex_reports) == codepoint &&
+      (!route || hex_reports < route->reports)) {
+    *reports = hex_reports;
+    return COMPOSE_HEX;
+  }
+  *reports = route ? route->reports : 0;
+  return route ? route->form : COMPOSE_NONE;
+}
+
+int print_glyph_forms(int argc, char** argv) {
+  printf("// Forms of the glyphs in glyph_codepoints[] in keymap.c per host profile,\n");
+  printf("// see compose.h. Generated by `make -C sim glyphs` from the host models in sim/.\n");
+  printf("#pragma once\n\n");
+  printf("#define GLYPH_FORMS %u\n\n", glyph_count);
+  printf("static const uint16_t PROGMEM glyph_forms[HOST_PROFILES][GLYPH_FORMS][2] = {\n");
+
+  for (uint8_t profile = 0; profile < HOST_PROFILES; profile++) {
+    learn_routes(profile);
+    printf("  // %s\n  {\n", host_models[profile].name);
+    for (uint8_t glyph = 0; glyph < glyph_count; glyph++) {
+      uint16_t forms[2];
+      uint8_t reports[2];
+      char comment[96];
+      size_t length = 0;
+
+      for (uint8_t upper = 0; upper < 2; upper++) {
+        uint16_t codepoint = pgm_read_word(&glyph_codepoints[glyph][upper]);
+
+        forms[upper] = best_form(profile, codepoint, &reports[upper]);
+        length += snprintf(comment + length, sizeof(comment) - length, "%s%s ", upper ? ", " : "",
+                           bench_glyph_name(codepoint));
+        length += snprintf(comment + length, sizeof(comment) - length, "%s %u",
+                           form_name(profile, forms[upper]), reports[upper]);
+      }
+      printf("    { 0x%04x, 0x%04x },  // %2u: %s\n", forms[0], forms[1], glyph, comment);
+    }
+    printf("  },\n");
+  }
+  printf("};\n");
+  return 0;
+}
+
+// Type a glyph through the keymap on the active profile, as the host model
+// of the profile decodes it
+static uint32_t keymap_type(uint8_t profile, uint8_t glyph, bool upper) {
+  sim_reset();
+  host_profile_set(profile);
+  host_models[profile].reset();
+  sim_report_hook = host_models[profile].report;
+  emit_glyph(glyph, upper);
+  sim_run_until(sim_now_us + 50 * 1000);
+  sim_report_hook = NULL;
+  if (host_output.glyphs != 1) return 0;
+
+  const char* text = host_output.text;
+  return utf8_next(&text);
+}
+
+// A profile selected before a power cycle is active after it, and selecting
+// the active profile again does not write the EEPROM
+static bool profile_persists(uint8_t profile) {
+  uint32_t writes;
+
+  sim_reset();
+  host_profile_set(profile);
+  writes = sim_eeprom_writes;
+  host_profile_set(profile);
+  if (sim_eeprom_writes != writes) return false;
+  sim_power_cycle();
+  return host_profile_get() == profile;
+}
+
+int bench_compose(int argc, char** argv) {
+  uint32_t stale = 0, broken = 0, lost = 0;
+
+  if (GLYPH_FORMS != glyph_count) {
+    printf("FAIL: glyph_forms.h has %u glyphs, the keymap %u, run make -C sim glyphs\n", GLYPH_FORMS, glyph_count);
+    return 1;
+  }
+
+  for (uint8_t profile = 0; profile < HOST_PROFILES; profile++) {
+    uint32_t total = 0, forms = 0, unreachable = 0;
+    bool persists = profile_persists(profile);
+
+    learn_routes(profile);
+    printf("%s\n", host_models[profile].name);
+    printf("  %-5s %-6s %-16s %8s %8s  %s\n", "glyph", "code", "form", "reports", "shortest", "char");
+    for (uint8_t glyph = 0; glyph < glyph_count; glyph++) {
+      for (uint8_t upper = 0; upper < 2; upper++) {
+        uint16_t codepoint = pgm_read_word(&glyph_codepoints[glyph][upper]);
+        uint16_t form = pgm_read_word(&glyph_forms[profile][glyph][upper]);
+        uint8_t reports, shortest;
+        uint16_t best = best_form(profile, codepoint, &shortest);
+        const char* problem = "";
+
+        host_type(profile, form, codepoint, &reports);
+        if (form != best) {
+          problem = "  STALE";
+          stale++;
+        } else if (form != COMPOSE_NONE && keymap_type(profile, glyph, upper) != codepoint) {
+          problem = "  WRONG CHARACTER";
+          broken++;
+        }
+        if (form == COMPOSE_NONE) {
+          unreachable++;
+        } else {
+          forms++;
+          total += reports;
+        }
+        printf("  %-5u U+%04X %-16s %8u %8u  %s%s\n", glyph, codepoint, form_name(profile, form), reports, shortest,
+               bench_glyph_name(codepoint), problem);
+      }
+    }
+    printf("  %u forms, %.2f reports per glyph, %u not reachable, %s\n\n",
+           forms, forms ? (double)total / forms : 0.0, unreachable,
+           persists ? "kept over a power cycle" : "LOST over a power cycle");
+    if (!persists) lost++;
+  }
+
+  if (stale || broken || lost) {
+    printf("FAIL: %u forms differ from the cheapest (run make -C sim glyphs), %u type the wrong character, "
+           "%u profiles not kept\n", stale, broken, lost);
+    return 1;
+  }
+  return 0;
+}
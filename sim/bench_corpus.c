@@ -0,0 +1,204 @@
+// Corpus typing benchmark: types text files through the full keymap and
+// reports HID reports and emission time per output character.
+//
+// The text the host model decodes must match the corpus, so the benchmark
+// doubles as a check that every typed glyph still comes out right.
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "host.h"
+#include "typist.h"
+
+typedef struct {
+  uint32_t codepoint;
+  uint32_t count;
+  uint32_t reports;
+  uint32_t max_latency_us;
+} glyph_stats_t;
+
+typedef struct {
+  glyph_stats_t* glyphs;
+  size_t count;
+} corpus_stats_t;
+
+static glyph_stats_t* glyph_stats(corpus_stats_t* stats, uint32_t codepoint) {
+  for (size_t i = 0; i < stats->count; i++) {
+    if (stats->glyphs[i].codepoint == codepoint) return &stats->glyphs[i];
+  }
+  stats->glyphs = realloc(stats->glyphs, (stats->count + 1) * sizeof(*stats->glyphs));
+  stats->glyphs[stats->count] = (glyph_stats_t) { .codepoint = codepoint };
+  return &stats->glyphs[stats->count++];
+}
+
+static int by_cost(const void* a, const void* b) {
+  const glyph_stats_t* x = a;
+  const glyph_stats_t* y = b;
+  // reports per occurrence, descending
+  uint64_t lhs = (uint64_t)x->reports * y->count;
+  uint64_t rhs = (uint64_t)y->reports * x->count;
+  if (lhs != rhs) return lhs < rhs ? 1 : -1;
+  return x->codepoint < y->codepoint ? -1 : 1;
+}
+
+char* bench_read_file(const char* path) {
+  FILE* file = fopen(path, "rb");
+  char* text;
+  long size;
+
+  if (!file) {
+    perror(path);
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  text = malloc(size + 1);
+  text[fread(text, 1, size, file)] = '\0';
+  fclose(file);
+  return text;
+}
+
+const char* bench_glyph_name(uint32_t codepoint) {
+  static char name[16];
+
+  switch (codepoint) {
+    case '\n': return "\\n";
+    case '\t': return "\\t";
+    case ' ':  return "space";
+  }
+  name[utf8_encode(codepoint, name)] = '\0';
+  return name;
+}
+
+static bool type_corpus(const char* path, uint32_t interval_us, double max_per_char, int top) {
+  char* text = bench_read_file(path);
+  char* expected;
+  size_t expected_length = 0;
+  const char* cursor;
+  corpus_stats_t stats = { 0 };
+  corpus_stats_t missing = { 0 };
+  uint32_t typed = 0, skipped = 0;
+  uint64_t total_latency = 0;
+  uint32_t max_latency = 0;
+  uint32_t time = 0;
+  bool ok = true;
+
+  if (!text) return false;
+  expected = malloc(strlen(text) + 1);
+
+  sim_reset();
+  host_macos_reset();
+  sim_report_hook = host_macos_report;
+
+  for (cursor = text; *cursor;) {
+    uint32_t codepoint = utf8_next(&cursor);
+    const typist_chord_t* chord = typist_find(codepoint);
+    uint32_t reports = sim_stats.reports;
+    uint32_t glyphs = host_output.glyphs;
+    uint32_t trigger = 0;
+
+    if (codepoint == '\r') continue;
+    if (!chord) {
+      glyph_stats(&missing, codepoint)->count++;
+      skipped++;
+      continue;
+    }
+
+    uint32_t done = typist_type(chord, time, &trigger);
+    time += interval_us;
+    if (time < done) time = done;
+    sim_run_until(time);
+
+    glyph_stats_t* glyph = glyph_stats(&stats, codepoint);
+    uint32_t latency = host_output.glyphs > glyphs ? host_output.last_glyph_us - trigger : 0;
+    glyph->count++;
+    glyph->reports += sim_stats.reports - reports;
+    if (latency > glyph->max_latency_us) glyph->max_latency_us = latency;
+    if (latency > max_latency) max_latency = latency;
+    total_latency += latency;
+    expected_length += utf8_encode(codepoint, expected + expected_length);
+    typed++;
+  }
+  expected[expected_length] = '\0';
+
+  double per_char = typed ? (double)sim_stats.reports / typed : 0;
+  uint64_t emission_us = (uint64_t)sim_stats.reports * sim_config.poll_us;
+
+  printf("%s: %u characters typed, %u skipped\n", path, typed, skipped);
+  if (missing.count) {
+    printf("  not on the keymap: ");
+    for (size_t i = 0; i < missing.count; i++) {
+      printf("%s%s", i ? " " : "", bench_glyph_name(missing.glyphs[i].codepoint));
+    }
+    printf("\n");
+  }
+  printf("  reports             %u (%.3f per character)\n", sim_stats.reports, per_char);
+  printf("  emission time       %llu.%03llu ms at %u us poll interval (%.3f ms per character)\n",
+         (unsigned long long)(emission_us / 1000), (unsigned long long)(emission_us % 1000),
+         sim_config.poll_us, typed ? emission_us / 1000.0 / typed : 0);
+  printf("  key to host latency mean %.3f ms, max %.3f ms\n",
+         typed ? total_latency / 1000.0 / typed : 0, max_latency / 1000.0);
+  printf("  firmware blocked    %u.%03u ms\n", sim_stats.blocked_us / 1000, sim_stats.blocked_us % 1000);
+  printf("  report queue        max depth %u, %u overflows\n",
+         report_queue_stats.max_depth, report_queue_stats.overflows);
+  latency_print("  ");
+
+  qsort(stats.glyphs, stats.count, sizeof(*stats.glyphs), by_cost);
+  printf("  worst glyphs:\n");
+  for (int i = 0; i < top && (size_t)i < stats.count; i++) {
+    const glyph_stats_t* glyph = &stats.glyphs[i];
+    printf("    %-6s %5.2f reports  %6u times  max latency %.3f ms\n",
+           bench_glyph_name(glyph->codepoint), (double)glyph->reports / glyph->count,
+           glyph->count, glyph->max_latency_us / 1000.0);
+  }
+
+  if (strcmp(host_output.text ? host_output.text : "", expected) != 0) {
+    size_t at = 0;
+    while (host_output.text[at] && host_output.text[at] == expected[at]) at++;
+    printf("  FAIL: host output differs from the corpus at byte %zu: \"%.20s\" instead of \"%.20s\"\n",
+           at, host_output.text + at, expected + at);
+    ok = false;
+  }
+  if (max_per_char > 0 && per_char > max_per_char) {
+    printf("  FAIL: %.3f reports per character exceeds the limit of %.3f\n", per_char, max_per_char);
+    ok = false;
+  }
+
+  sim_report_hook = NULL;
+  free(stats.glyphs);
+  free(missing.glyphs);
+  free(expected);
+  free(text);
+  return ok;
+}
+
+int bench_corpus(int argc, char** argv) {
+  double max_per_char = 0;
+  uint32_t interval_us = 150 * 1000;
+  int top = 10;
+  int i = 0;
+  bool ok = true;
+
+  for (; i + 1 < argc && strncmp(argv[i], "--", 2) == 0; i += 2) {
+    if (strcmp(argv[i], "--max") == 0) {
+      max_per_char = atof(argv[i + 1]);
+    } else if (strcmp(argv[i], "--interval-ms") == 0) {
+      interval_us = atoi(argv[i + 1]) * 1000;
+    } else if (strcmp(argv[i], "--top") == 0) {
+      top = atoi(argv[i + 1]);
+    } else {
+      fprintf(stderr, "bench-corpus: unknown option %s\n", argv[i]);
+      return 2;
+    }
+  }
+  if (i >= argc) {
+    fprintf(stderr, "usage: neo2sim bench-corpus [--max R] [--interval-ms N] [--top N] <text>...\n");
+    return 2;
+  }
+
+  typist_learn(host_macos_report, host_macos_reset);
+  for (; i < argc; i++) {
+    ok = type_corpus(argv[i], interval_us, max_per_char, top) && ok;
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+// LCD redraw benchmark: the cost of showing each layer label through the
+// font path, the way keyframe_display_layer_text draws text, against the
+// blit of the label visualizer.c renders at startup.
+//
+// Cost is counted in gdisp calls and pixels written. On the Infinity every
+// call takes the display lock and clips, so calls dominate; the host time of
+// the model itself says nothing about the firmware and is not reported.
+//
+// Both have to produce the same pixels, so the benchmark also catches labels
+// and status cells rendered differently from gdispDrawString().
+//
+// The second part types status changes through the keymap and counts what
+// the status screen redraws for each, against repainting the whole screen.
+#include <string.h>
+#include "bench.h"
+#include "lcd.h"
+#include "layers.h"
+#include "status_screen.h"
+#include "mcufont.h"
+
+static void redraw_font(visualizer_state_t* state) {
+  font_t font = state->font_dejavusansbold12;
+
+  gdispClear(White);
+  gdispDrawString(0, LAYER_LABEL_Y + (LAYER_LABEL_HEIGHT - font->height) / 2, state->layer_text, font, Black);
+}
+
+static void redraw_blit(visualizer_state_t* state) {
+  visualizer_keyboard_status_t prev = state->status;
+
+  // A state without text is redrawn even though the layer did not change
+  state->layer_text = NULL;
+  update_user_visualizer_state(state, &prev);
+}
+
+static sim_lcd_stats_t measure(void (*redraw)(visualizer_state_t*), visualizer_state_t* state) {
+  sim_lcd_reset();
+  redraw(state);
+  return sim_lcd_stats;
+}
+
+typedef struct {
+  const char* name;
+  uint8_t count;
+  struct {
+    uint8_t index;            // LAYOUT_ergodox() index
+    bool pressed;
+  } events[4];
+  uint32_t max_pixels;        // the regions the change concerns
+} status_step_t;
+
+// Cells are 18x8 in the layer stack, 10x8 for modifiers, 28x8 for Caps Lock
+// and 56x8 for the host profile. The label is 128x16 and only changes with
+// the top layer: MOD3 over the NEO_4 lock reaches NEO_6, Shift does not.
+static const status_step_t status_steps[] = {
+  { "hold Shift",        1, { { 20, true } },                            80 },
+  { "Caps Lock chord",   2, { { 64, true }, { 64, false } },             224 },
+  { "release Shift",     1, { { 20, false } },                           80 },
+  { "lock NEO_4",        4, { { 37, true }, { 73, true }, { 37, false }, { 73, false } }, 2048 + 144 },
+  { "hold Shift on it",  1, { { 20, true } },                            80 },
+  { "release Shift",     1, { { 20, false } },                           80 },
+  { "MOD3 on it: NEO_6", 1, { { 14, true } },                            2048 + 2 * 144 },
+  { "release MOD3",      1, { { 14, false } },                           2048 + 2 * 144 },
+  { "hold FKEYS",        1, { { 32, true } },                            2048 + 144 },
+  { "host Linux",        2, { { 10, true }, { 10, false } },             448 },
+  { "release FKEYS",     1, { { 32, false } },                           2048 + 144 },
+};
+
+// Type each step and count the gdisp calls and pixels it costs
+static bool status_redraws(void) {
+  visualizer_state_t* state;
+  sim_lcd_stats_t full;
+  bool ok = true;
+
+  sim_reset();
+  state = sim_visualizer_state;
+  sim_lcd_reset();
+  user_visualizer_resume(state);
+  update_user_visualizer_state(state, &state->status);
+  full = sim_lcd_stats;
+
+  printf("\n%-18s %8s %8s\n", "status change", "calls", "pixels");
+  printf("%-18s %8u %8u\n", "full screen", full.calls, full.pixels);
+  for (size_t i = 0; i < sizeof(status_steps) / sizeof(status_steps[0]); i++) {
+    const status_step_t* step = &status_steps[i];
+
+    sim_lcd_reset();
+    for (uint8_t e = 0; e < step->count; e++) {
+      keypos_t pos;
+
+      sim_layout_position(step->events[e].index, &pos);
+      sim_event(pos.row, pos.col, step->events[e].pressed);
+      sim_run_until(sim_now_us + 200 * 1000);
+    }
+    printf("%-18s %8u %8u\n", step->name, sim_lcd_stats.calls, sim_lcd_stats.pixels);
+    if (sim_lcd_stats.pixels > step->max_pixels) {
+      printf("  FAIL: redraws more than the %u pixels of the regions that changed\n", step->max_pixels);
+      ok = false;
+    }
+  }
+  if (!(host_keyboard_leds() & (1 << USB_LED_CAPS_LOCK)) || host_profile_get() != HOST_LINUX) {
+    printf("  FAIL: Caps Lock or the host profile did not change\n");
+    ok = false;
+  }
+  return ok;
+}
+
+// Draw a status cell with gdispDrawString(), inverted or not
+static void draw_cell_text(visualizer_state_t* state, uint8_t cell, bool inverted) {
+  const status_cell_t* c = &status_cells[cell];
+  font_t font = state->font_fixed5x8;
+
+  gdispFillArea(c->x, c->y, c->width, STATUS_CELL_HEIGHT, inverted ? Black : White);
+  gdispDrawString(c->x + (c->width - mf_get_string_width(font, c->text, 0, false)) / 2,
+                  c->y + (STATUS_CELL_HEIGHT - font->height) / 2, c->text, font, inverted ? White : Black);
+}
+
+// The status lines right after startup against the cells drawn as text: no
+// layer above the default one, no modifiers, no Caps Lock, macOS
+static bool status_cells_current(void) {
+  static color_t cells_frame[SIM_LCD_HEIGHT][SIM_LCD_WIDTH];
+  visualizer_state_t* state;
+
+  sim_reset();
+  state = sim_visualizer_state;
+  memcpy(cells_frame, sim_lcd, sizeof(cells_frame));
+
+  sim_lcd_reset();
+  for (uint8_t layer = 0; layer < LAYER_COUNT; layer++) {
+    draw_cell_text(state, CELL_LAYER + layer, false);
+  }
+  for (uint8_t mod = 0; mod < 4; mod++) {
+    draw_cell_text(state, CELL_MODS + mod, false);
+  }
+  draw_cell_text(state, CELL_HOST + HOST_MACOS, false);
+  if (memcmp(cells_frame[LAYER_LABEL_HEIGHT], sim_lcd[LAYER_LABEL_HEIGHT],
+             sizeof(cells_frame) - sizeof(cells_frame[0]) * LAYER_LABEL_HEIGHT) != 0) {
+    printf("  FAIL: the status cells differ from their texts\n");
+    return false;
+  }
+  return true;
+}
+
+int bench_lcd(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  static color_t font_frame[SIM_LCD_HEIGHT][SIM_LCD_WIDTH];
+  sim_lcd_stats_t font_total = { 0 }, blit_total = { 0 };
+  visualizer_state_t* state;
+  bool ok = true;
+
+  sim_reset();
+  state = sim_visualizer_state;
+
+  printf("%-14s %17s %17s\n", "layer", "font path", "label blit");
+  printf("%-14s %8s %8s %8s %8s\n", "", "calls", "pixels", "calls", "pixels");
+  for (uint8_t layer = 0; layer < LAYER_COUNT; layer++) {
+    state->status.layer = 1UL << layer;
+    redraw_blit(state);
+
+    sim_lcd_stats_t font = measure(redraw_font, state);
+    memcpy(font_frame, sim_lcd, sizeof(font_frame));
+    sim_lcd_stats_t blit = measure(redraw_blit, state);
+
+    printf("%-14s %8u %8u %8u %8u\n", state->layer_text, font.calls, font.pixels, blit.calls, blit.pixels);
+    font_total.calls += font.calls;
+    font_total.pixels += font.pixels;
+    blit_total.calls += blit.calls;
+    blit_total.pixels += blit.pixels;
+    if (memcmp(font_frame, sim_lcd, sizeof(font_frame)) != 0) {
+      printf("  FAIL: the label blit differs from the text\n");
+      ok = false;
+    }
+  }
+  printf("%-14s %8u %8u %8u %8u\n", "total", font_total.calls, font_total.pixels,
+         blit_total.calls, blit_total.pixels);
+
+  ok = status_cells_current() && ok;
+  ok = status_redraws() && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// Keycode lookup benchmark: host time per lookup through
+// keymap_key_to_keycode() against a plain read of the dense keymaps[], and
+// the flash each layer takes in either encoding.
+//
+// Every lookup has to return the keycode from keymaps[], which catches a
+// sparse_layers.h that is out of date with keymap.c.
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+#include "layers.h"
+#include "keymap_sparse.h"
+#include "lookup.h"
+#include "sparse_layers.h"
+
+extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
+
+#define LAYOUT_KEYS 76
+
+static volatile uint16_t sink;
+
+__attribute__ ((noinline))
+static uint16_t dense_lookup(uint8_t layer, keypos_t key) {
+  return pgm_read_word(&keymaps[layer][key.row][key.col]);
+}
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double time_lookups(uint16_t (*lookup)(uint8_t, keypos_t), uint8_t layer,
+                           const keypos_t* keys, uint32_t iterations) {
+  uint16_t sum = 0;
+  double start = now_ns();
+
+  for (uint32_t i = 0; i < iterations; i++) {
+    for (uint8_t k = 0; k < LAYOUT_KEYS; k++) sum += lookup(layer, keys[k]);
+  }
+  sink = sum;
+  return (now_ns() - start) / ((double)iterations * LAYOUT_KEYS);
+}
+
+int bench_lookup(int argc, char** argv) {
+  keypos_t keys[LAYOUT_KEYS];
+  uint32_t iterations = 20000;
+  uint32_t dense_total = 0, stored_total = 0;
+  uint16_t packed = 0;
+  bool ok = true;
+  int i = 0;
+
+  for (; i + 1 < argc && strncmp(argv[i], "--", 2) == 0; i += 2) {
+    if (strcmp(argv[i], "--iterations") == 0) {
+      iterations = atoi(argv[i + 1]);
+    } else {
+      fprintf(stderr, "bench-lookup: unknown option %s\n", argv[i]);
+      return 2;
+    }
+  }
+  if (iterations == 0) iterations = 1;
+
+  for (uint8_t k = 0; k < LAYOUT_KEYS; k++) sim_layout_position(k, &keys[k]);
+
+  printf("%-6s %-7s %12s %12s %8s %8s\n", "layer", "storage", "dense ns", "keymap ns", "dense B", "stored B");
+  for (uint8_t layer = 0; layer < LAYER_COUNT; layer++) {
+    bool sparse = LAYER_IS_SPARSE(layer);
+    uint32_t dense_bytes = MATRIX_ROWS * MATRIX_COLS * sizeof(uint16_t);
+    uint32_t stored_bytes = dense_bytes;
+
+    // A sparse layer takes the keycodes it adds to sparse_keycodes[], none
+    // if it shares those of an earlier one
+    if (sparse) {
+      uint16_t fill = lookup_fill(layer);
+      uint16_t end = pgm_read_word(&sparse_layers[SPARSE_LAYERS_BELOW(layer)].base);
+
+      for (uint8_t k = 0; k < LAYOUT_KEYS; k++) {
+        if (keymaps[layer][keys[k].row][keys[k].col] != fill) end++;
+      }
+      stored_bytes = sizeof(sparse_layer_t) + (end > packed ? end - packed : 0) * sizeof(uint16_t);
+      if (end > packed) packed = end;
+    }
+
+    for (uint8_t k = 0; k < LAYOUT_KEYS; k++) {
+      if (keymap_key_to_keycode(layer, keys[k]) != dense_lookup(layer, keys[k])) {
+        printf("  FAIL: layer %u (%u,%u) looks up 0x%04x instead of 0x%04x, run make -C sim layers\n",
+               layer, keys[k].row, keys[k].col, keymap_key_to_keycode(layer, keys[k]),
+               dense_lookup(layer, keys[k]));
+        ok = false;
+        break;
+      }
+    }
+
+    double dense_ns = time_lookups(dense_lookup, layer, keys, iterations);
+    double keymap_ns = time_lookups(keymap_key_to_keycode, layer, keys, iterations);
+    printf("%-6u %-7s %12.2f %12.2f %8u %8u\n", layer, sparse ? "sparse" : "dense",
+           dense_ns, keymap_ns, dense_bytes, stored_bytes);
+    dense_total += dense_bytes;
+    stored_total += stored_bytes;
+  }
+  // The slot of every layer, see keymap_sparse.c
+  printf("%-6s %-7s %12s %12s %8s %8u\n", "slots", "", "", "", "", LAYER_COUNT);
+  stored_total += LAYER_COUNT;
+  printf("%-6s %-7s %12s %12s %8u %8u\n", "total", "", "", "", dense_total, stored_total);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+// Dynamic macro benchmark: records the corpora typed through the keymap,
+// replays the recording and checks the host gets the same text. It prints
+// the bytes the recording takes per key event, against a keyrecord_t per
+// event, and the replay throughput against the one report per poll
+// interval the host takes. A recording longer than the ring keeps its end,
+// which the second run per corpus checks.
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "host.h"
+#include "recorder.h"
+#include "typist.h"
+
+// NEO2_FKEYS and the Record and Replay keys below it, as LAYOUT_ergodox()
+// indices
+#define FKEYS_KEY   32
+#define RECORD_KEY  15
+#define REPLAY_KEY  16
+
+static uint32_t fkeys_tap(uint8_t index, uint32_t time) {
+  typist_chord_t chord = { .count = 2, .keys = { FKEYS_KEY, index } };
+
+  return typist_type(&chord, time, NULL);
+}
+
+// Type the text until the recording has room for bytes more. Returns the
+// time typing ended and the text typed in *typed.
+static uint32_t type_text(const char* text, uint32_t bytes, char* typed, uint32_t time) {
+  size_t length = 0;
+
+  while (*text && recorder_stats.bytes + 16u <= bytes) {
+    const char* next = text;
+    uint32_t codepoint = utf8_next(&next);
+    const typist_chord_t* chord = typist_find(codepoint);
+
+    if (chord) {
+      time = typist_type(chord, time, NULL);
+      memcpy(typed + length, text, next - text);
+      length += next - text;
+    }
+    text = next;
+  }
+  typed[length] = '\0';
+  return time;
+}
+
+static bool record_and_replay(const char* name, const char* text, uint32_t bytes) {
+  char* typed = malloc(strlen(text) + 1);
+  uint32_t time = 1000, start, reports, replay_us;
+  const char* expected;
+  const char* output;
+  bool ok = true;
+
+  sim_reset();
+  host_macos_reset();
+  sim_report_hook = host_macos_report;
+
+  time = fkeys_tap(RECORD_KEY, time);
+  start = time;
+  time = type_text(text, bytes, typed, time);
+  time = fkeys_tap(RECORD_KEY, time);
+  sim_run_until(time + 100 * 1000);
+  start = time - start;
+
+  host_output_reset();
+  reports = sim_stats.reports;
+  time = sim_now_us;
+  fkeys_tap(REPLAY_KEY, time);
+  sim_run_until(time + 60 * 1000 * 1000);
+  sim_report_hook = NULL;
+  reports = sim_stats.reports - reports;
+  replay_us = sim_stats.last_delivery_us - time;
+
+  // With the oldest events dropped, the first character may have lost
+  // its modifiers
+  output = host_output.text;
+  if (recorder_stats.dropped) utf8_next(&output);
+  expected = typed + strlen(typed) - strlen(output);
+  if (expected < typed || strcmp(output, expected) != 0) {
+    printf("  FAIL: replay differs from the typed text: \"%.20s\" instead of \"%.20s\"\n", output,
+           expected < typed ? typed : expected);
+    ok = false;
+  }
+  if (reports * 1e6 / replay_us < 0.9 * 1e6 / sim_config.poll_us) {
+    printf("  FAIL: replay below 90%% of the report rate the host takes\n");
+    ok = false;
+  }
+  if (layer_state != 0 || get_mods() != 0) {
+    printf("  FAIL: layers %08x and modifiers %02x left on after the replay\n", layer_state, get_mods());
+    ok = false;
+  }
+
+  printf("%-12s %6u %6u %5u %7u %9.2f %9.1f %9.1f %8.1f %7.0fx\n", name, host_output.glyphs,
+         recorder_stats.events, recorder_stats.dropped, recorder_stats.bytes,
+         (double)recorder_stats.bytes / recorder_stats.events, replay_us / 1000.0,
+         recorder_stats.replayed * 1e6 / replay_us, reports * 1e6 / replay_us,
+         (double)start / replay_us);
+  free(typed);
+  return ok;
+}
+
+int bench_recorder(int argc, char** argv) {
+  static const char* corpora[] = { "corpus/de.txt", "corpus/en.txt" };
+  bool ok = true;
+
+  typist_learn(host_macos_report, host_macos_reset);
+  printf("recording of %u bytes, %zu bytes per event as keyrecord_t\n", RECORDER_SIZE, sizeof(keyrecord_t));
+  printf("at most %.1f reports per second\n\n", 1e6 / sim_config.poll_us);
+  printf("%-12s %6s %6s %5s %7s %9s %9s %9s %8s %8s\n", "text", "chars", "events", "drop", "bytes",
+         "per event", "replay ms", "events/s", "reports/s", "speedup");
+
+  for (size_t i = 0; i < sizeof(corpora) / sizeof(corpora[0]); i++) {
+    char* text = bench_read_file(corpora[i]);
+    char name[16];
+
+    if (!text) return 1;
+    snprintf(name, sizeof(name), "%.2s", corpora[i] + strlen("corpus/"));
+    ok = record_and_replay(name, text, RECORDER_SIZE) && ok;
+    snprintf(name, sizeof(name), "%.2s, all", corpora[i] + strlen("corpus/"));
+    ok = record_and_replay(name, text, UINT32_MAX) && ok;
+    free(text);
+  }
+
+  if (!ok) {
+    printf("FAIL: replays differ from the recordings or are slow\n");
+    return 1;
+  }
+  return 0;
+}
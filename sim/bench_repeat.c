@@ -0,0 +1,141 @@
+// Auto-repeat benchmark: holds glyph keys on every host profile and measures
+// the rate their repeats reach the host at, against the 1000 / REPEAT_INTERVAL
+// per second key_repeat.h asks for, and the most the report queue could send
+// at one report per poll interval. A plain key pressed while the glyph still
+// repeats has to end the repeat and come out as soon as the stream in flight
+// has gone out.
+#include "bench.h"
+#include "host.h"
+#include "key_repeat.h"
+#include "typist.h"
+
+#define HOLD_US (2 * 1000 * 1000)
+
+// Glyph keys held, chosen to cover chords, dead keys and long hex forms
+static const uint32_t repeat_codepoints[] = { 0x2013, 0x2022, 0x2026, 0x20AC, 0x00F6, 0x00C0 };
+// Pressed while the glyph repeats
+#define INTERRUPT_CODEPOINT 'n'
+
+static sim_report_hook_t model_report;
+static uint32_t glyph_times[3];   // first glyph, first repeat, last glyph
+static uint32_t glyph_reports;    // of the first repeat
+static uint32_t pending_reports;
+
+static void timed_report(uint32_t time_us, const report_keyboard_t* report) {
+  uint32_t glyphs = host_output.glyphs;
+
+  model_report(time_us, report);
+  pending_reports++;
+  if (host_output.glyphs == glyphs) return;
+  if (glyphs == 1) glyph_reports = pending_reports;
+  if (glyphs < 2) glyph_times[glyphs] = time_us;
+  glyph_times[2] = time_us;
+  pending_reports = 0;
+}
+
+static void press_chord(const typist_chord_t* chord, bool pressed, uint32_t* time) {
+  keypos_t pos;
+
+  for (uint8_t n = 0; n < chord->count; n++) {
+    uint8_t i = pressed ? n : chord->count - 1 - n;
+
+    sim_layout_position(chord->keys[i], &pos);
+    sim_event_at(*time, pos, pressed);
+    *time = sim_now_us + typist_timing.key_gap_us;
+  }
+}
+
+int bench_repeat(int argc, char** argv) {
+  const typist_chord_t* interrupt;
+  uint32_t target = 1000 / REPEAT_INTERVAL;
+  uint32_t slow = 0, wrong = 0, late = 0;
+
+  typist_learn(host_macos_report, host_macos_reset);
+  interrupt = typist_find(INTERRUPT_CODEPOINT);
+  printf("repeat after %u ms, every %u ms, %u per second\n\n", REPEAT_DELAY, REPEAT_INTERVAL, target);
+
+  for (uint8_t profile = 0; profile < HOST_PROFILES; profile++) {
+    printf("%s\n", host_models[profile].name);
+    printf("  %-6s %7s %7s %9s %8s %8s %5s %9s  %s\n", "code", "reports", "repeats", "first ms", "per sec",
+           "limit", "late", "interrupt", "char");
+
+    for (size_t g = 0; g < sizeof(repeat_codepoints) / sizeof(repeat_codepoints[0]); g++) {
+      uint32_t codepoint = repeat_codepoints[g];
+      const typist_chord_t* chord = typist_find(codepoint);
+      uint32_t time, trigger, interrupt_us, glyphs;
+      keypos_t key;
+      double rate;
+      const char* problem = "";
+      const char* text;
+      bool correct = true;
+
+      if (!chord) {
+        printf("  U+%04X not on the keymap\n", codepoint);
+        wrong++;
+        continue;
+      }
+
+      sim_reset();
+      host_profile_set(profile);
+      host_models[profile].reset();
+      model_report = host_models[profile].report;
+      sim_report_hook = timed_report;
+      glyph_reports = 0;
+
+      // Hold the chord, let go of its modifiers and type the interrupting
+      // key over the glyph key
+      time = sim_now_us + 1000;
+      press_chord(chord, true, &time);
+      trigger = sim_now_us;
+      time = trigger + HOLD_US;
+      for (uint8_t i = chord->count - 1; i-- > 0;) {
+        keypos_t pos;
+
+        sim_layout_position(chord->keys[i], &pos);
+        time = sim_event_at(time, pos, false) + typist_timing.key_gap_us;
+      }
+      sim_run_until(time);
+      glyphs = host_output.glyphs;
+      rate = glyphs > 2 ? (glyphs - 2) * 1e6 / (glyph_times[2] - glyph_times[1]) : 0;
+      press_chord(interrupt, true, &time);
+      interrupt_us = sim_now_us;
+      press_chord(interrupt, false, &time);
+      sim_layout_position(chord->keys[chord->count - 1], &key);
+      sim_event_at(time, key, false);
+      sim_run_until(sim_now_us + 500 * 1000);
+      sim_report_hook = NULL;
+
+      // Every glyph is the held one, the stream in flight included, then
+      // the interrupting key ends the output
+      text = host_output.text;
+      for (uint32_t i = 0; i + 1 < host_output.glyphs; i++) {
+        if (utf8_next(&text) != codepoint) correct = false;
+      }
+      if (utf8_next(&text) != INTERRUPT_CODEPOINT) correct = false;
+      interrupt_us = host_output.last_glyph_us - interrupt_us;
+
+      if (!correct) {
+        problem = "  WRONG CHARACTER";
+        wrong++;
+      } else if (rate < target * 0.95) {
+        problem = "  SLOW";
+        slow++;
+      } else if (interrupt_us > REPORT_STREAM_MAX * sim_config.poll_us + sim_config.scan_us) {
+        problem = "  INTERRUPT LATE";
+        late++;
+      }
+      printf("  U+%04X %7u %7u %9.1f %8.1f %8.1f %5u %7.1fms  %s%s\n", codepoint, glyph_reports, glyphs - 1,
+             (glyph_times[1] - trigger) / 1000.0, rate, glyph_reports ? 1e6 / (glyph_reports * sim_config.poll_us) : 0,
+             key_repeat_stats.late, interrupt_us / 1000.0,
+             bench_glyph_name(codepoint), problem);
+    }
+    printf("\n");
+  }
+
+  if (slow || wrong || late) {
+    printf("FAIL: %u repeats below 95%% of %u per second, %u typed wrong, %u interrupted late\n",
+           slow, target, wrong, late);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,448 @@
+// Snippet trie: `neo2sim snippet-trie` packs the triggers of snippets[] in
+// keymap.c into the double array of snippets.h and prints snippet_trie.h.
+// `neo2sim bench-snippets` checks the tables the firmware is built with
+// against it and expands every snippet through the keymap on every host
+// profile. It then times matching the corpora key by key through the trie
+// against comparing the word typed so far with every trigger, for the
+// keymap's snippets and for generated sets of growing size.
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+#include "host.h"
+#include "typist.h"
+#include "snippet_trie.h"
+
+// NEO2_LMOD3 and Leader on NEO_3, as LAYOUT_ergodox() indices
+static const uint8_t leader_chord[] = { 14, 7 };
+
+typedef struct {
+  uint8_t symbols[128];
+  uint8_t symbol_count;
+  snippet_cell_t* cells;
+  uint32_t cell_count;
+  char (*prefixes)[SNIPPET_DEPTH + 1];
+} trie_t;
+
+typedef struct {
+  int32_t children[128];
+  uint8_t snippet;
+  uint16_t cell;
+} node_t;
+
+static void trie_free(trie_t* trie) {
+  free(trie->cells);
+  free(trie->prefixes);
+  memset(trie, 0, sizeof(*trie));
+}
+
+static void trie_grow(trie_t* trie, uint32_t count) {
+  if (count <= trie->cell_count) return;
+  trie->cells = realloc(trie->cells, count * sizeof(*trie->cells));
+  trie->prefixes = realloc(trie->prefixes, count * sizeof(*trie->prefixes));
+  for (uint32_t i = trie->cell_count; i < count; i++) {
+    trie->cells[i] = (snippet_cell_t) { .base = 0, .check = SNIPPET_NO_STATE, .snippet = 0 };
+    trie->prefixes[i][0] = '\0';
+  }
+  trie->cell_count = count;
+}
+
+// Build the double array for the triggers. The most common characters get
+// the lowest symbols, children are placed breadth first at the lowest base
+// where all of them fit. Returns false for triggers snippets.h cannot take.
+static bool trie_build(trie_t* trie, const char* const* triggers, uint32_t count) {
+  uint32_t frequency[128] = { 0 };
+  node_t* nodes = calloc(1, sizeof(node_t));
+  uint32_t node_count = 1;
+  uint32_t* queue;
+  uint32_t head = 0, tail = 0, first_free = 1;
+
+  memset(trie, 0, sizeof(*trie));
+  for (uint32_t s = 0; s < count; s++) {
+    const char* trigger = triggers[s];
+    int32_t node = 0;
+    size_t length = strlen(trigger);
+
+    if (length == 0 || length > SNIPPET_DEPTH) {
+      fprintf(stderr, "snippet trigger \"%s\" is empty or longer than SNIPPET_DEPTH\n", trigger);
+      free(nodes);
+      return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+      uint8_t c = trigger[i];
+
+      if (c <= ' ' || c >= 0x7F) {
+        fprintf(stderr, "snippet trigger \"%s\" has a character other than printable ASCII\n", trigger);
+        free(nodes);
+        return false;
+      }
+      frequency[c]++;
+      if (!nodes[node].children[c]) {
+        nodes = realloc(nodes, (node_count + 1) * sizeof(node_t));
+        memset(&nodes[node_count], 0, sizeof(node_t));
+        nodes[node].children[c] = node_count++;
+      }
+      node = nodes[node].children[c];
+    }
+    if (nodes[node].snippet) {
+      fprintf(stderr, "snippet trigger \"%s\" is there twice\n", trigger);
+      free(nodes);
+      return false;
+    }
+    nodes[node].snippet = s + 1;
+  }
+
+  // Symbols by falling frequency
+  for (;;) {
+    uint8_t best = 0;
+
+    for (uint8_t c = 1; c < 128; c++) {
+      if (frequency[c] && !trie->symbols[c] && (!best || frequency[c] > frequency[best])) best = c;
+    }
+    if (!best) break;
+    trie->symbols[best] = ++trie->symbol_count;
+  }
+
+  trie_grow(trie, 1);
+  trie->cells[0].snippet = nodes[0].snippet;
+  queue = malloc(node_count * sizeof(*queue));
+  queue[tail++] = 0;
+  while (head < tail) {
+    node_t* node = &nodes[queue[head++]];
+    uint8_t min_symbol = 0xFF;
+    uint32_t base;
+
+    for (uint8_t c = 1; c < 128; c++) {
+      if (node->children[c] && trie->symbols[c] < min_symbol) min_symbol = trie->symbols[c];
+    }
+    if (min_symbol == 0xFF) continue;
+
+    for (base = first_free > min_symbol ? first_free - min_symbol : 1;; base++) {
+      bool fits = true;
+
+      for (uint8_t c = 1; c < 128 && fits; c++) {
+        uint32_t cell = base + trie->symbols[c];
+        if (node->children[c] && cell < trie->cell_count && trie->cells[cell].check != SNIPPET_NO_STATE) fits = false;
+      }
+      if (fits) break;
+    }
+    trie->cells[node->cell].base = base;
+    for (uint8_t c = 1; c < 128; c++) {
+      node_t* child;
+      uint32_t cell = base + trie->symbols[c];
+      size_t length = strlen(trie->prefixes[node->cell]);
+
+      if (!node->children[c]) continue;
+      trie_grow(trie, cell + 1);
+      child = &nodes[node->children[c]];
+      child->cell = cell;
+      trie->cells[cell].check = node->cell;
+      trie->cells[cell].snippet = child->snippet;
+      memcpy(trie->prefixes[cell], trie->prefixes[node->cell], length);
+      trie->prefixes[cell][length] = c;
+      trie->prefixes[cell][length + 1] = '\0';
+      queue[tail++] = node->children[c];
+    }
+    while (first_free < trie->cell_count && trie->cells[first_free].check != SNIPPET_NO_STATE) first_free++;
+  }
+
+  free(queue);
+  free(nodes);
+  return true;
+}
+
+// snippet_next() on a trie built here
+static uint16_t trie_next(const trie_t* trie, uint16_t state, uint8_t character) {
+  uint8_t symbol = character < 128 ? trie->symbols[character] : 0;
+  uint32_t next;
+
+  if (!symbol) return SNIPPET_NO_STATE;
+  next = trie->cells[state].base + symbol;
+  if (next >= trie->cell_count || trie->cells[next].check != state) return SNIPPET_NO_STATE;
+  return next;
+}
+
+static bool keymap_trie(trie_t* trie) {
+  const char** triggers = malloc(snippet_count * sizeof(*triggers));
+  bool ok;
+
+  for (uint8_t i = 0; i < snippet_count; i++) triggers[i] = snippets[i].trigger;
+  ok = trie_build(trie, triggers, snippet_count);
+  free(triggers);
+  return ok;
+}
+
+int print_snippet_trie(int argc, char** argv) {
+  trie_t trie;
+
+  if (!keymap_trie(&trie)) return 1;
+
+  printf("// Trie of the snippet triggers in keymap.c, see snippets.h.\n");
+  printf("// Generated by `make -C sim snippets` from snippets[].\n");
+  printf("#pragma once\n\n");
+  printf("#define SNIPPET_CELLS %u\n\n", trie.cell_count);
+  printf("// Symbol of each character that is in a trigger, 0 for the others\n");
+  printf("static const uint8_t PROGMEM snippet_symbols[128] = {");
+  for (uint8_t c = 0; c < 128; c++) {
+    printf("%s%2u,", c % 16 ? " " : "\n  ", trie.symbols[c]);
+  }
+  printf("\n};\n\n");
+
+  printf("static const snippet_cell_t PROGMEM snippet_trie[SNIPPET_CELLS] = {\n");
+  for (uint32_t i = 0; i < trie.cell_count; i++) {
+    const snippet_cell_t* cell = &trie.cells[i];
+    char comment[64];
+
+    if (i == 0) snprintf(comment, sizeof(comment), "root");
+    else if (cell->check == SNIPPET_NO_STATE) snprintf(comment, sizeof(comment), "free");
+    else if (cell->snippet) snprintf(comment, sizeof(comment), "\"%s\", snippet %u", trie.prefixes[i], cell->snippet - 1);
+    else snprintf(comment, sizeof(comment), "\"%s\"", trie.prefixes[i]);
+    printf("  { %3u, 0x%04x, %2u },  // %3u: %s\n", cell->base, cell->check, cell->snippet, i, comment);
+  }
+  printf("};\n");
+  trie_free(&trie);
+  return 0;
+}
+
+// The tables snippets.c is built with match the keymap
+static bool trie_current(void) {
+  trie_t trie;
+  bool current;
+
+  if (!keymap_trie(&trie)) return false;
+  current = trie.cell_count == SNIPPET_CELLS &&
+            memcmp(trie.symbols, snippet_symbols, sizeof(trie.symbols)) == 0;
+  for (uint32_t i = 0; current && i < trie.cell_count; i++) {
+    current = trie.cells[i].base == snippet_trie[i].base && trie.cells[i].check == snippet_trie[i].check &&
+              trie.cells[i].snippet == snippet_trie[i].snippet;
+  }
+  trie_free(&trie);
+  return current;
+}
+
+// Leader sequences wait for a word end while a longer trigger starts with
+// the one typed
+static bool has_longer_trigger(uint8_t snippet) {
+  const char* trigger = snippets[snippet].trigger;
+
+  for (uint8_t s = 0; s < snippet_count; s++) {
+    if (s != snippet && strncmp(snippets[s].trigger, trigger, strlen(trigger)) == 0) return true;
+  }
+  return false;
+}
+
+static uint32_t type_string(const char* text, uint32_t time) {
+  while (*text) {
+    const typist_chord_t* chord = typist_find(utf8_next(&text));
+
+    if (!chord) return 0;
+    time = typist_type(chord, time, NULL);
+  }
+  return time;
+}
+
+// Expand a snippet on a profile, with the leader key or by typing its
+// trigger and a space. Returns whether the host got the text.
+static bool expand_snippet(uint8_t profile, uint8_t snippet, bool typed, uint32_t* reports) {
+  typist_chord_t leader = { .count = sizeof(leader_chord) };
+  char expected[128];
+  uint32_t time = 1000;
+
+  memcpy(leader.keys, leader_chord, sizeof(leader_chord));
+  sim_reset();
+  host_profile_set(profile);
+  host_models[profile].reset();
+  sim_report_hook = host_models[profile].report;
+
+  if (!typed) time = typist_type(&leader, time, NULL);
+  time = type_string(snippets[snippet].trigger, time);
+  if (time && (typed || has_longer_trigger(snippet))) time = type_string(" ", time);
+  if (time) sim_run_until(time + 500 * 1000);
+  sim_report_hook = NULL;
+  *reports = sim_stats.reports;
+
+  snprintf(expected, sizeof(expected), "%s%s%s", typed ? snippets[snippet].trigger : "",
+           snippets[snippet].text, typed ? " " : "");
+  if (!time) return false;
+  if (!typed) return strcmp(host_output.text, expected) == 0;
+  // The trigger is typed, then erased
+  return host_output.length == strlen(expected) - strlen(snippets[snippet].trigger) &&
+         strcmp(host_output.text, expected + strlen(snippets[snippet].trigger)) == 0;
+}
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static volatile uint32_t sink;
+
+// Typed-trigger matching as process_snippets() does it: from the root at
+// the start of a word, one step per character, stopped by a miss
+__attribute__ ((noinline))
+static uint32_t match_trie(const trie_t* trie, const char* text, size_t length) {
+  uint16_t state = SNIPPET_ROOT;
+  uint32_t matches = 0;
+
+  for (size_t i = 0; i < length; i++) {
+    uint8_t c = text[i];
+
+    if (c == ' ' || c == '\n' || c == '\t') {
+      if (state != SNIPPET_NO_STATE && trie->cells[state].snippet) matches++;
+      state = SNIPPET_ROOT;
+    } else if (state != SNIPPET_NO_STATE) {
+      state = trie_next(trie, state, c);
+    }
+  }
+  return matches;
+}
+
+// The same by comparing the word so far with every trigger
+__attribute__ ((noinline))
+static uint32_t match_linear(const char* const* triggers, uint32_t count, const char* text, size_t length) {
+  char word[SNIPPET_DEPTH + 1];
+  uint8_t word_length = 0;
+  bool prefix = true;
+  uint32_t matches = 0;
+
+  for (size_t i = 0; i < length; i++) {
+    uint8_t c = text[i];
+
+    if (c == ' ' || c == '\n' || c == '\t') {
+      for (uint32_t s = 0; prefix && s < count; s++) {
+        if (strlen(triggers[s]) == word_length && memcmp(triggers[s], word, word_length) == 0) {
+          matches++;
+          break;
+        }
+      }
+      word_length = 0;
+      prefix = true;
+      continue;
+    }
+    if (!prefix) continue;
+    if (word_length == SNIPPET_DEPTH) {
+      prefix = false;
+      continue;
+    }
+    word[word_length++] = c;
+    // Any trigger still starting with the word?
+    prefix = false;
+    for (uint32_t s = 0; s < count && !prefix; s++) {
+      prefix = strncmp(triggers[s], word, word_length) == 0;
+    }
+  }
+  return matches;
+}
+
+static void bench_matching(const char* name, const char* const* triggers, uint32_t count, const char* text) {
+  size_t length = strlen(text);
+  uint32_t rounds = 200;
+  trie_t trie;
+  double start, trie_ns, linear_ns;
+  uint32_t nodes = 0;
+
+  if (!trie_build(&trie, triggers, count)) return;
+  for (uint32_t i = 0; i < trie.cell_count; i++) {
+    if (i == 0 || trie.cells[i].check != SNIPPET_NO_STATE) nodes++;
+  }
+
+  start = now_ns();
+  for (uint32_t r = 0; r < rounds; r++) sink = match_trie(&trie, text, length);
+  trie_ns = (now_ns() - start) / ((double)rounds * length);
+  start = now_ns();
+  for (uint32_t r = 0; r < rounds / 10 + 1; r++) sink = match_linear(triggers, count, text, length);
+  linear_ns = (now_ns() - start) / ((double)(rounds / 10 + 1) * length);
+
+  printf("%-8s %8u %8u %8u %7.1f%% %8zu %10.2f %10.2f\n", name, count, nodes, trie.cell_count,
+         100.0 * nodes / trie.cell_count, trie.cell_count * sizeof(snippet_cell_t) + sizeof(trie.symbols),
+         trie_ns, linear_ns);
+  trie_free(&trie);
+}
+
+// Random lowercase triggers, some starting with ; as the typed ones do
+static const char** random_triggers(uint32_t count) {
+  const char** triggers = malloc(count * sizeof(*triggers));
+  uint32_t seed = 12345;
+
+  for (uint32_t i = 0; i < count; i++) {
+    char* trigger = malloc(SNIPPET_DEPTH + 1);
+    bool duplicate;
+
+    do {
+      uint8_t length = 2 + (seed = seed * 1103515245 + 12345) / 65536 % 6;
+
+      for (uint8_t j = 0; j < length; j++) {
+        seed = seed * 1103515245 + 12345;
+        trigger[j] = j == 0 && seed / 65536 % 4 == 0 ? ';' : 'a' + seed / 65536 % 26;
+      }
+      trigger[length] = '\0';
+      duplicate = false;
+      for (uint32_t j = 0; j < i && !duplicate; j++) duplicate = strcmp(triggers[j], trigger) == 0;
+    } while (duplicate);
+    triggers[i] = trigger;
+  }
+  return triggers;
+}
+
+int bench_snippets(int argc, char** argv) {
+  static const uint32_t set_sizes[] = { 100, 400, 1600 };
+  uint32_t wrong = 0;
+  char* corpus;
+  char* en;
+
+  if (!trie_current()) {
+    printf("FAIL: snippet_trie.h is out of date with snippets[], run make -C sim snippets\n");
+    return 1;
+  }
+
+  typist_learn(host_macos_report, host_macos_reset);
+  for (uint8_t profile = 0; profile < HOST_PROFILES; profile++) {
+    uint32_t total = 0, reports;
+
+    for (uint8_t s = 0; s < snippet_count; s++) {
+      for (uint8_t typed = 0; typed < 2; typed++) {
+        if (typed && !(snippets[s].flags & SNIPPET_TYPED)) continue;
+        if (!expand_snippet(profile, s, typed, &reports)) {
+          printf("  %s: \"%s\"%s types \"%s\"\n", host_models[profile].name, snippets[s].trigger,
+                 typed ? " typed" : "", host_output.text);
+          wrong++;
+        }
+        total += reports;
+      }
+    }
+    printf("%-28s %u snippets expanded, %u reports\n", host_models[profile].name, snippet_count, total);
+  }
+
+  corpus = bench_read_file("corpus/de.txt");
+  en = bench_read_file("corpus/en.txt");
+  if (!corpus || !en) return 1;
+  corpus = realloc(corpus, strlen(corpus) + strlen(en) + 1);
+  strcat(corpus, en);
+
+  printf("\nmatching the corpora, per character\n");
+  printf("%-8s %8s %8s %8s %8s %8s %10s %10s\n", "set", "snippets", "nodes", "cells", "fill", "bytes",
+         "trie ns", "linear ns");
+  {
+    const char** triggers = malloc(snippet_count * sizeof(*triggers));
+
+    for (uint8_t i = 0; i < snippet_count; i++) triggers[i] = snippets[i].trigger;
+    bench_matching("keymap", triggers, snippet_count, corpus);
+    free(triggers);
+  }
+  for (size_t i = 0; i < sizeof(set_sizes) / sizeof(set_sizes[0]); i++) {
+    const char** triggers = random_triggers(set_sizes[i]);
+
+    bench_matching("random", triggers, set_sizes[i], corpus);
+    for (uint32_t j = 0; j < set_sizes[i]; j++) free((char*)triggers[j]);
+    free(triggers);
+  }
+  free(corpus);
+  free(en);
+
+  if (wrong) {
+    printf("FAIL: %u snippets typed the wrong text\n", wrong);
+    return 1;
+  }
+  return 0;
+}
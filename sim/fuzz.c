@@ -0,0 +1,510 @@
+// Property fuzzer: plays random press/release interleavings of the Shift,
+// MOD3 and MOD4 keys and a few glyph keys through the keymap and checks the
+// layer and modifier state against a model of the keys held.
+//
+// A key only takes its role as a modifier if the layers active when it goes
+// down have its NEO_1 keycode at its position; on NEO_4 the right MOD3 key
+// is the keypad dot.
+//
+// After every event, once no dual-role key holds events back:
+//  - layer_state is what the keys held give: NEO_3 for a MOD3 key, NEO_4
+//    for a MOD4 key or the lock but not both, NEO_5 and NEO_6 for their
+//    combinations. Both MOD4 keys at once and five taps in a row of the
+//    same MOD4 key toggle the lock, once no MOD4 key is held.
+//  - the layer hold counts match the MOD3 and MOD4 keys held
+//  - the Shift modifiers match the Shift keys held
+//  - Caps Lock toggled at most once per chord of both Shift keys
+// With every key released and the output drained:
+//  - no modifier, weak modifier or key left in the report or at the host
+//  - no layer hold left, layer_state is just the NEO_4 lock if it is on
+//  - Caps Lock toggled exactly once per chord
+//
+// One in sixteen events starts a row of MOD4 taps instead, so that the
+// lock by TAPPING_TOGGLE taps is hit and missed often; the fuzzer ends with
+// how often each way toggled the lock. Between events, scans that cannot
+// find anything to do are skipped.
+//
+// A failing run is shrunk by delta debugging to the fewest events that still
+// fail the same check, and printed as a trace for `neo2sim replay`.
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+#include "layers.h"
+
+typedef struct {
+  uint8_t index;          // LAYOUT_ergodox() index
+  const char* name;
+} fuzz_key_t;
+
+enum { KEY_LSHIFT, KEY_RSHIFT, KEY_LMOD3, KEY_RMOD3, KEY_LMOD4, KEY_RMOD4, KEY_MODIFIERS };
+
+static const fuzz_key_t fuzz_keys[] = {
+  [KEY_LSHIFT] = { 20, "LSHIFT" },
+  [KEY_RSHIFT] = { 64, "RSHIFT" },
+  [KEY_LMOD3]  = { 14, "NEO2_LMOD3" },
+  [KEY_RMOD3]  = { 57, "NEO2_RMOD3" },
+  [KEY_LMOD4]  = { 37, "NEO2_LMOD4" },
+  [KEY_RMOD4]  = { 73, "NEO2_RMOD4" },
+  { 1,  "NEO2_1" },
+  { 21, "NEO2_UE" },
+  { 51, "NEO2_SHARP_S" },
+  { 61, "NEO2_COMMA" },
+  { 18, "e" },
+};
+
+#define FUZZ_KEYS (sizeof(fuzz_keys) / sizeof(fuzz_keys[0]))
+#define HELD(key) (held & (1 << (key)))
+#define ROLE(key) (roles & (1 << (key)))
+
+typedef struct {
+  uint8_t key;
+  bool pressed;
+  uint32_t gap_us;        // since the event before
+} fuzz_event_t;
+
+static keypos_t positions[FUZZ_KEYS];
+
+// Events as played by the last run, with the time they were picked up
+typedef struct {
+  uint8_t key;
+  bool pressed;
+  uint32_t time_us;
+} played_event_t;
+
+static played_event_t* played_events;
+static size_t played_count;
+static uint32_t rng_state;
+
+static uint32_t rng(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+// Mostly rollover within a few ms, with gaps around the tapping term and
+// past the repeat delay to hit the timed decisions
+static uint32_t random_gap(void) {
+  uint32_t pick = rng() % 100;
+
+  if (pick < 15) return 0;
+  if (pick < 65) return rng() % 4000;
+  if (pick < 85) return 4000 + rng() % 100000;
+  if (pick < 97) return 145000 + rng() % 10000;
+  return 400000 + rng() % 100000;
+}
+
+// Taps of the MOD4 keys in a row, mostly of one key and within the tapping
+// term, so that some of them add up to TAPPING_TOGGLE and toggle the lock
+static size_t random_taps(fuzz_event_t* events, size_t count) {
+  uint8_t taps = 2 + rng() % (TAPPING_TOGGLE + 1);
+  uint8_t key = rng() % 2 ? KEY_LMOD4 : KEY_RMOD4;
+  size_t i = 0;
+
+  for (uint8_t tap = 0; tap < taps && i + 1 < count; tap++) {
+    if (rng() % 8 == 0) key = key == KEY_LMOD4 ? KEY_RMOD4 : KEY_LMOD4;
+    uint32_t term_us = TAPPING_TERM * 1000;
+
+    events[i++] = (fuzz_event_t) { key, true, rng() % 8 ? rng() % (term_us / 2) : term_us + rng() % term_us };
+    events[i++] = (fuzz_event_t) { key, false, rng() % 8 ? rng() % (term_us / 2) : term_us + rng() % term_us };
+  }
+  return i;
+}
+
+static void random_events(fuzz_event_t* events, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (rng() % 16 == 0) {
+      size_t taps = random_taps(events + i, count - i);
+
+      if (taps > 0) {
+        i += taps - 1;
+        continue;
+      }
+    }
+    // Two in three events go to the modifiers
+    events[i].key = rng() % 3 ? rng() % KEY_MODIFIERS : rng() % FUZZ_KEYS;
+    events[i].pressed = rng() % 2;
+    events[i].gap_us = random_gap();
+  }
+}
+
+/*
+ * Running a trace
+ */
+
+static uint16_t held;
+// Keys held that went down as modifiers
+static uint16_t roles;
+// The dual-role key waiting for its decision while nothing is held back
+// behind it. Releases of keys pressed before it still go through and change
+// the layers its hold is decided on.
+static uint16_t undecided;
+static bool locked;
+// The lock toggles once no MOD4 key holds NEO_4
+static bool lock_toggle;
+// MOD4 taps in a row, as layer_hold_tap_toggle() counts them
+static struct {
+  bool seen;
+  uint8_t key;
+  uint8_t count;
+  uint16_t time;
+} taps;
+static uint32_t chords;
+// Lock toggles over all runs, by taps and by both MOD4 keys
+static uint32_t tap_locks;
+static uint32_t chord_locks;
+static uint32_t caps_toggles;
+static uint8_t host_leds;
+static report_keyboard_t host_report;
+static char failure[128];
+
+static void fuzz_report(uint32_t time_us, const report_keyboard_t* report) {
+  if ((host_keyboard_leds() ^ host_leds) & (1 << USB_LED_CAPS_LOCK)) caps_toggles++;
+  host_leds = host_keyboard_leds();
+  host_report = *report;
+}
+
+static bool fail(const char* format, ...) __attribute__ ((format (printf, 1, 2)));
+
+static bool fail(const char* format, ...) {
+  va_list args;
+
+  va_start(args, format);
+  vsnprintf(failure, sizeof(failure), format, args);
+  va_end(args);
+  return false;
+}
+
+static uint32_t expected_layers(void) {
+  bool mod3 = ROLE(KEY_LMOD3) || ROLE(KEY_RMOD3);
+  bool mod4 = (ROLE(KEY_LMOD4) || ROLE(KEY_RMOD4)) != locked;
+  bool shift = ROLE(KEY_LSHIFT) || ROLE(KEY_RSHIFT);
+  uint32_t layers = 0;
+
+  if (mod3) layers |= 1UL << NEO_3;
+  if (mod4) layers |= 1UL << NEO_4;
+  if (mod3 && shift) layers |= 1UL << NEO_5;
+  if (mod3 && mod4) layers |= 1UL << NEO_6;
+  return layers;
+}
+
+// Whether the key has its NEO_1 keycode on the layers the model expects
+static bool takes_role(uint8_t key) {
+  uint32_t layers = expected_layers() | default_layer_state;
+
+  for (int8_t layer = LAYER_COUNT - 1; layer >= 0; layer--) {
+    uint16_t keycode = keymap_key_to_keycode(layer, positions[key]);
+
+    if (!(layers & (1UL << layer)) || keycode == KC_TRNS) continue;
+    return keycode == keymap_key_to_keycode(NEO_1, positions[key]);
+  }
+  return false;
+}
+
+static bool check_event(void) {
+  uint8_t mod3 = !!ROLE(KEY_LMOD3) + !!ROLE(KEY_RMOD3);
+  uint8_t mod4 = !!ROLE(KEY_LMOD4) + !!ROLE(KEY_RMOD4);
+  uint8_t shift = (ROLE(KEY_LSHIFT) ? MOD_BIT(KC_LSHIFT) : 0) | (ROLE(KEY_RSHIFT) ? MOD_BIT(KC_RSHIFT) : 0);
+  uint8_t mods = report_queue_mods() & (MOD_BIT(KC_LSHIFT) | MOD_BIT(KC_RSHIFT));
+
+  if (layer_state != expected_layers()) {
+    return fail("layer_state %08x with the keys held, expected %08x", layer_state, expected_layers());
+  }
+  if (layer_hold_count(NEO_3) != mod3 || layer_hold_count(NEO_4) != mod4) {
+    return fail("layer holds NEO_3 %u and NEO_4 %u, expected %u and %u", layer_hold_count(NEO_3),
+                layer_hold_count(NEO_4), mod3, mod4);
+  }
+  if (mods != shift) {
+    return fail("Shift modifiers %02x with the keys held, expected %02x", mods, shift);
+  }
+  if (caps_toggles > chords) {
+    return fail("Caps Lock toggled %u times in %u chords", caps_toggles, chords);
+  }
+  return true;
+}
+
+static bool check_released(void) {
+  static const report_keyboard_t empty;
+
+  if (get_mods() || get_weak_mods()) {
+    return fail("modifiers %02x, weak %02x stuck", get_mods(), get_weak_mods());
+  }
+  if (memcmp(keyboard_report, &empty, sizeof(empty)) != 0 || memcmp(&host_report, &empty, sizeof(empty)) != 0) {
+    return fail("report mods=%02x key=%02x, host mods=%02x key=%02x left over", keyboard_report->mods,
+                keyboard_report->keys[0], host_report.mods, host_report.keys[0]);
+  }
+  for (uint8_t layer = 0; layer < LAYER_COUNT; layer++) {
+    if (layer_hold_count(layer)) return fail("layer %u still held %u times", layer, layer_hold_count(layer));
+  }
+  if (layer_state != (locked ? 1UL << NEO_4 : 0)) {
+    return fail("layer_state %08x with every key released", layer_state);
+  }
+  if (caps_toggles != chords) {
+    return fail("Caps Lock toggled %u times in %u chords", caps_toggles, chords);
+  }
+  return true;
+}
+
+// Run the scans up to the one before time_us, the event's. The tasks of
+// the keymap count time in ms, so after the scan following an event only
+// the first scan of each ms can find something new to do. Once nothing is
+// under way, no dual-role key waiting, no report queued and no key
+// repeating, only events can, and the clock moves on to the event.
+static void skip_idle_scans(uint32_t time_us) {
+  uint32_t scan = sim_config.scan_us;
+
+  time_us = (time_us + scan - 1) / scan * scan;
+  if (sim_now_us + scan < time_us) {
+    sim_run_until(sim_now_us + scan);
+  }
+  while (sim_now_us + scan < time_us) {
+    uint32_t next = (sim_now_us / 1000 + 1) * 1000;
+
+    if (next + scan >= time_us || (!tap_hold_pending() && !report_queue_busy() && !key_repeat_active())) {
+      sim_now_us = time_us - scan;
+      return;
+    }
+    sim_now_us = next - scan;
+    sim_run_until(next);
+  }
+}
+
+// Apply an event to the keyboard and the model. Presses of held keys and
+// releases of keys not held cannot happen on a matrix and are skipped.
+static bool play(const fuzz_event_t* event, uint32_t* time) {
+  if (!HELD(event->key) != event->pressed) return false;
+
+  *time += event->gap_us;
+  skip_idle_scans(*time);
+  bool was_pending = tap_hold_pending();
+  *time = sim_event_at(*time, positions[event->key], event->pressed);
+  played_events[played_count++] = (played_event_t) { event->key, event->pressed, *time };
+
+  bool mod4 = event->key == KEY_LMOD4 || event->key == KEY_RMOD4;
+  uint16_t ms = (uint16_t)(*time / 1000) | 1;
+  bool in_term = taps.seen && taps.key == event->key && (uint16_t)(ms - taps.time) < TAPPING_TERM;
+
+  // A release of a key pressed before the dual-role key goes through, the
+  // dual-role key is decided before anything else and starts the taps over
+  bool through = undecided && tap_hold_pending() && !event->pressed && !(undecided & (1 << event->key));
+
+  if (undecided && !through) {
+    taps.count = 0;
+    undecided = 0;
+  }
+  if (event->pressed) {
+    held |= 1 << event->key;
+    if (event->key < KEY_MODIFIERS && takes_role(event->key)) roles |= 1 << event->key;
+    if (!was_pending && tap_hold_pending()) {
+      undecided = 1 << event->key;
+    } else if (mod4 && ROLE(event->key)) {
+      if (!in_term) taps.count = 0;
+      taps.seen = true;
+      taps.key = event->key;
+      taps.time = ms;
+      if (ROLE(KEY_LMOD4) && ROLE(KEY_RMOD4)) {
+        lock_toggle = !lock_toggle;
+        chord_locks++;
+      }
+    } else {
+      taps.count = 0;
+    }
+    // Both Shift keys are a chord on every layer
+    if (HELD(KEY_LSHIFT) && HELD(KEY_RSHIFT) && (event->key == KEY_LSHIFT || event->key == KEY_RSHIFT)) {
+      chords++;
+    }
+  } else {
+    if (mod4 && ROLE(event->key)) {
+      taps.count = in_term ? taps.count + 1 : 0;
+      taps.key = event->key;
+      taps.time = ms;
+      if (taps.count == TAPPING_TOGGLE) {
+        taps.count = 0;
+        lock_toggle = !lock_toggle;
+        tap_locks++;
+      }
+    }
+    held &= ~(1 << event->key);
+    roles &= ~(1 << event->key);
+    if (lock_toggle && !ROLE(KEY_LMOD4) && !ROLE(KEY_RMOD4)) {
+      locked = !locked;
+      lock_toggle = false;
+    }
+    if (through) {
+      roles &= ~undecided;
+      for (uint8_t key = 0; key < KEY_MODIFIERS; key++) {
+        if ((undecided & (1 << key)) && takes_role(key)) roles |= 1 << key;
+      }
+    }
+  }
+  return true;
+}
+
+// Play the events, release whatever is still held and check every step.
+// Returns false with the failed check in failure.
+static bool run(const fuzz_event_t* events, size_t count, uint32_t* played) {
+  uint32_t time;
+
+  sim_reset();
+  sim_report_hook = fuzz_report;
+  held = 0;
+  roles = 0;
+  undecided = 0;
+  locked = false;
+  lock_toggle = false;
+  memset(&taps, 0, sizeof(taps));
+  chords = 0;
+  caps_toggles = 0;
+  host_leds = host_keyboard_leds();
+  memset(&host_report, 0, sizeof(host_report));
+  time = sim_now_us;
+  played_count = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    if (!play(&events[i], &time)) continue;
+    if (played) (*played)++;
+    if (!tap_hold_pending() && !check_event()) return false;
+  }
+  for (uint8_t key = 0; key < FUZZ_KEYS; key++) {
+    fuzz_event_t release = { .key = key, .pressed = false, .gap_us = 1000 };
+
+    if (play(&release, &time) && !tap_hold_pending() && !check_event()) return false;
+  }
+
+  // Let the queued output go out
+  do {
+    sim_run_until(sim_now_us + sim_config.poll_us);
+  } while (report_queue_busy());
+  sim_run_until(sim_now_us + sim_config.poll_us);
+  sim_report_hook = NULL;
+  return check_released();
+}
+
+/*
+ * Shrinking a failing trace
+ */
+
+// Whether the events fail the same check as the original trace, told
+// apart by the first two words of the failure
+static bool fails_alike(const fuzz_event_t* events, size_t count, const char* check) {
+  size_t length = strcspn(check, " ");
+
+  length += strcspn(check + length + 1, " ") + 1;
+  return !run(events, count, NULL) && strncmp(failure, check, length) == 0;
+}
+
+// ddmin: drop chunks of the trace while it keeps failing, with chunks
+// getting smaller until single events
+static size_t minimize(fuzz_event_t* events, size_t count) {
+  fuzz_event_t* candidate = malloc(count * sizeof(*events));
+  char check[sizeof(failure)];
+  size_t chunks = 2;
+
+  run(events, count, NULL);
+  strcpy(check, failure);
+
+  while (count >= 2) {
+    size_t size = (count + chunks - 1) / chunks;
+    bool reduced = false;
+
+    for (size_t start = 0; start < count && !reduced; start += size) {
+      size_t end = start + size < count ? start + size : count;
+      size_t length = 0;
+
+      // The chunk alone, then everything but the chunk
+      memcpy(candidate, events + start, (end - start) * sizeof(*events));
+      if (fails_alike(candidate, end - start, check)) {
+        memcpy(events, candidate, (end - start) * sizeof(*events));
+        count = end - start;
+        chunks = 2;
+        reduced = true;
+        break;
+      }
+      memcpy(candidate, events, start * sizeof(*events));
+      length = start;
+      memcpy(candidate + length, events + end, (count - end) * sizeof(*events));
+      length += count - end;
+      if (fails_alike(candidate, length, check)) {
+        memcpy(events, candidate, length * sizeof(*events));
+        count = length;
+        chunks = chunks > 2 ? chunks - 1 : 2;
+        reduced = true;
+      }
+    }
+    if (!reduced) {
+      if (chunks >= count) break;
+      chunks = chunks * 2 < count ? chunks * 2 : count;
+    }
+  }
+  free(candidate);
+  run(events, count, NULL);
+  return count;
+}
+
+// The events of the last run, the releases at the end included
+static void print_trace(void) {
+  for (size_t i = 0; i < played_count; i++) {
+    const played_event_t* event = &played_events[i];
+
+    printf("%-9.3f %-4s k%-4u # %s\n", event->time_us / 1000.0, event->pressed ? "down" : "up",
+           fuzz_keys[event->key].index, fuzz_keys[event->key].name);
+  }
+}
+
+int fuzz(int argc, char** argv) {
+  uint32_t seed = 1, runs = 100000, length = 40;
+  uint32_t played = 0;
+  fuzz_event_t* events;
+  struct timespec start, end;
+  double seconds;
+
+  for (int i = 0; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--seed") == 0) {
+      seed = strtoul(argv[i + 1], NULL, 0);
+    } else if (strcmp(argv[i], "--runs") == 0) {
+      runs = strtoul(argv[i + 1], NULL, 0);
+    } else if (strcmp(argv[i], "--events") == 0) {
+      length = strtoul(argv[i + 1], NULL, 0);
+    } else {
+      fprintf(stderr, "usage: neo2sim fuzz [--seed N] [--runs N] [--events N]\n");
+      return 2;
+    }
+  }
+
+  for (uint8_t key = 0; key < FUZZ_KEYS; key++) {
+    sim_layout_position(fuzz_keys[key].index, &positions[key]);
+  }
+  events = malloc(length * sizeof(*events));
+  played_events = malloc((length + FUZZ_KEYS) * sizeof(*played_events));
+  rng_state = seed ? seed : 1;
+  // The LCD does not take part in the checks
+  sim_config.visualizer = false;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (uint32_t r = 0; r < runs; r++) {
+    random_events(events, length);
+    if (!run(events, length, &played)) {
+      size_t count;
+
+      printf("FAIL: run %u of seed %u: %s\n", r, seed, failure);
+      count = minimize(events, length);
+      printf("shrunk to %zu events: %s\n\n", count, failure);
+      print_trace();
+      free(events);
+      free(played_events);
+      return 1;
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+  printf("%u runs of %u events, seed %u: %u key events, %.2f s, %.0f events per second\n", runs, length,
+         seed, played, seconds, played / seconds);
+  printf("NEO_4 lock toggled %u times by %u taps in a row, %u times by both MOD4 keys\n", tap_locks,
+         TAPPING_TOGGLE, chord_locks);
+  free(events);
+  free(played_events);
+  return 0;
+}
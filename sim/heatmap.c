@@ -0,0 +1,224 @@
+// Usage heatmap: replays traces or types text files, reads the usage
+// counters back over raw HID and prints the key presses of every used layer
+// in the shape of the layer diagrams in README.md, followed by the glyph and
+// layer counters.
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "compose.h"
+#include "hid_commands.h"
+#include "host.h"
+#include "layers.h"
+#include "raw_hid.h"
+#include "typist.h"
+
+#define LAYOUT_KEYS 76
+#define POSITIONS (MATRIX_ROWS * MATRIX_COLS)
+
+// The README diagram frame, @nn marks the cell of key nn in
+// LAYOUT_ergodox() order. A cell runs from its mark to the next '|'.
+static const char* const diagram[] = {
+  ",--------------------------------------------------.           ,--------------------------------------------------.",
+  "|@00     |@01   |@02   |@03   |@04   |@05   |@06   |           |@38   |@39   |@40   |@41   |@42   |@43   |@44     |",
+  "|--------+------+------+------+------+-------------|           |------+------+------+------+------+------+--------|",
+  "|@07     |@08   |@09   |@10   |@11   |@12   |@13   |           |@45   |@46   |@47   |@48   |@49   |@50   |@51     |",
+  "|--------+------+------+------+------+------|      |           |      |------+------+------+------+------+--------|",
+  "|@14     |@15   |@16   |@17   |@18   |@19   |------|           |------|@52   |@53   |@54   |@55   |@56   |@57     |",
+  "|--------+------+------+------+------+------|@26   |           |@58   |------+------+------+------+------+--------|",
+  "|@20     |@21   |@22   |@23   |@24   |@25   |      |           |      |@59   |@60   |@61   |@62   |@63   |@64     |",
+  "`--------+------+------+------+------+-------------'           `-------------+------+------+------+------+--------'",
+  "  |@27   |@28   |@29   |@30   |@31   |                                       |@65   |@66   |@67   |@68   |@69   |",
+  "  `----------------------------------'                                       `----------------------------------'",
+  "                                       ,-------------.       ,-------------.",
+  "                                       |@32   |@33   |       |@70   |@71   |",
+  "                                ,------|------|------|       |------+------+------.",
+  "                                |      |      |@34   |       |@72   |      |      |",
+  "                                |@35   |@36   |------|       |------|@74   |@75   |",
+  "                                |      |      |@37   |       |@73   |      |      |",
+  "                                `--------------------'       `--------------------'",
+};
+
+// README section of each layer
+static const struct {
+  uint8_t readme;
+  const char* name;
+} layer_sections[LAYER_COUNT] = {
+  [NEO_1] = { 1, "NEO_1" },
+  [NEO_3] = { 2, "NEO_3" },
+  [NEO_4] = { 3, "NEO_4" },
+  [NEO_5] = { 4, "NEO_5" },
+  [NEO_6] = { 5, "NEO_6" },
+  [US_1]  = { 6, "US_1" },
+  [FKEYS] = { 7, "FKEYS" },
+};
+
+static const char shades[] = " .:-=+*#%@";
+
+static uint16_t get_word(const uint8_t* data, uint8_t offset) {
+  return data[offset] | (data[offset + 1] << 8);
+}
+
+static const uint8_t* request(uint8_t command, uint8_t arg1, uint8_t arg2) {
+  uint8_t data[RAW_EPSIZE] = { command, arg1, arg2 };
+
+  raw_hid_receive(data, sizeof(data));
+  return sim_raw_hid_reply[0] == command ? sim_raw_hid_reply : NULL;
+}
+
+// Read a counter array in HID_USAGE_WORDS chunks. header is the reply
+// header size, the count is its last byte.
+static bool read_counters(uint8_t command, uint8_t layer, uint16_t* counters, uint16_t total) {
+  bool keys = command == HID_USAGE_KEYS;
+  uint8_t header = keys ? 4 : 3;
+
+  for (uint16_t first = 0; first < total;) {
+    const uint8_t* reply = keys ? request(command, layer, first) : request(command, first, 0);
+    if (!reply || reply[header - 1] == 0) return false;
+    for (uint8_t i = 0; i < reply[header - 1]; i++) {
+      counters[first + i] = get_word(reply, header + 2 * i);
+    }
+    first += reply[header - 1];
+  }
+  return true;
+}
+
+static void print_layer(const uint16_t* presses, uint16_t max) {
+  uint8_t positions[LAYOUT_KEYS];
+
+  for (uint8_t k = 0; k < LAYOUT_KEYS; k++) {
+    keypos_t pos;
+    sim_layout_position(k, &pos);
+    positions[k] = pos.row * MATRIX_COLS + pos.col;
+  }
+
+  for (size_t line = 0; line < sizeof(diagram) / sizeof(diagram[0]); line++) {
+    char out[256];
+    const char* in = diagram[line];
+    size_t length = 0;
+
+    while (*in) {
+      unsigned k;
+      if (*in == '@' && sscanf(in + 1, "%2u", &k) == 1 && k < LAYOUT_KEYS) {
+        size_t width = strcspn(in, "|");
+        uint16_t count = presses[positions[k]];
+        char cell[32];
+
+        if (count == 0) {
+          snprintf(cell, sizeof(cell), "%*s", (int)width, "");
+        } else {
+          char shade = shades[1 + (uint32_t)count * (sizeof(shades) - 3) / max];
+          snprintf(cell, sizeof(cell), "%c%*u", shade, (int)width - 1, count);
+        }
+        memcpy(out + length, cell, width);
+        length += width;
+        in += width;
+      } else {
+        out[length++] = *in++;
+      }
+    }
+    out[length] = '\0';
+    printf("%s\n", out);
+  }
+}
+
+static void print_usage(void) {
+  uint16_t macros[USAGE_MACROS];
+
+  for (uint8_t layer = 0; layer < LAYER_COUNT; layer++) {
+    uint16_t presses[POSITIONS];
+    uint32_t total = 0;
+    uint16_t max = 0;
+
+    if (!read_counters(HID_USAGE_KEYS, layer, presses, POSITIONS)) {
+      printf("%s: no reply\n", layer_sections[layer].name);
+      continue;
+    }
+    for (uint16_t i = 0; i < POSITIONS; i++) {
+      total += presses[i];
+      if (presses[i] > max) max = presses[i];
+    }
+    if (total == 0) continue;
+
+    printf("## Layer %u (%s): %u presses\n\n", layer_sections[layer].readme, layer_sections[layer].name, total);
+    print_layer(presses, max);
+    printf("\n");
+  }
+
+  // Macro counter 2n is glyph n unshifted, 2n + 1 shifted
+  printf("%-14s %10s %10s\n", "glyph", "unshifted", "shifted");
+  if (read_counters(HID_USAGE_MACROS, 0, macros, USAGE_MACROS)) {
+    for (uint8_t i = 0; i < glyph_count && 2 * i + 1 < USAGE_MACROS; i++) {
+      if (macros[2 * i] || macros[2 * i + 1]) {
+        char name[32];
+
+        snprintf(name, sizeof(name), "%s", bench_glyph_name(pgm_read_word(&glyph_codepoints[i][0])));
+        snprintf(name + strlen(name), sizeof(name) - strlen(name), " %s",
+                 bench_glyph_name(pgm_read_word(&glyph_codepoints[i][1])));
+        printf("%-14s %10u %10u\n", name, macros[2 * i], macros[2 * i + 1]);
+      }
+    }
+  }
+
+  printf("\n%-14s %10s %10s\n", "layer", "activated", "dwell ms");
+  for (uint8_t layer = 0; layer < LAYER_COUNT; layer++) {
+    const uint8_t* reply = request(HID_USAGE_LAYER, layer, 0);
+    if (reply && get_word(reply, 2)) {
+      printf("%-14s %10u %10u\n", layer_sections[layer].name, get_word(reply, 2),
+             get_word(reply, 4) | ((uint32_t)get_word(reply, 6) << 16));
+    }
+  }
+}
+
+static bool is_trace(const char* path) {
+  size_t length = strlen(path);
+  return length > 6 && strcmp(path + length - 6, ".trace") == 0;
+}
+
+// Type a text file as fast as the typist plays its chords.
+static bool type_text(const char* path) {
+  char* text = bench_read_file(path);
+  const char* cursor;
+  uint32_t time = sim_now_us;
+
+  if (!text) return false;
+  for (cursor = text; *cursor;) {
+    const typist_chord_t* chord = typist_find(utf8_next(&cursor));
+    if (chord) time = typist_type(chord, time, NULL);
+  }
+  sim_run_until(time + 300 * 1000);
+  free(text);
+  return true;
+}
+
+int heatmap(int argc, char** argv) {
+  bool learned = false;
+
+  if (argc < 1) {
+    fprintf(stderr, "usage: neo2sim heatmap <trace|text>...\n");
+    return 2;
+  }
+
+  for (int i = 0; i < argc; i++) {
+    if (!is_trace(argv[i]) && !learned) {
+      typist_learn(host_macos_report, host_macos_reset);
+      learned = true;
+    }
+  }
+
+  sim_reset();
+  host_macos_reset();
+  sim_report_hook = host_macos_report;
+  for (int i = 0; i < argc; i++) {
+    if (is_trace(argv[i])) {
+      sim_trace_t trace = { 0 };
+
+      if (!sim_trace_load(&trace, argv[i])) return 1;
+      sim_trace_replay(&trace, 1000 * 1000);
+      sim_trace_free(&trace);
+    } else if (!type_text(argv[i])) {
+      return 1;
+    }
+  }
+  print_usage();
+  return 0;
+}
@@ -0,0 +1,52 @@
+// Host models: turn the keyboard reports the host receives into text.
+#pragma once
+
+#include "sim.h"
+#include "host_profile.h"
+
+typedef struct {
+  char*    text;            // UTF-8
+  size_t   length;
+  size_t   capacity;
+  uint32_t glyphs;          // number of code points produced
+  uint32_t last_glyph_us;   // time the last code point was produced
+} host_output_t;
+
+extern host_output_t host_output;
+
+void host_output_reset(void);
+void host_output_append(uint32_t codepoint, uint32_t time_us);
+// Backspace: remove the last code point
+void host_output_erase(void);
+size_t utf8_encode(uint32_t codepoint, char* out);
+// Decode one code point from *text and advance it; returns 0 at the end.
+uint32_t utf8_next(const char** text);
+
+// Base and Shift level of the U.S. layout, and the keypad
+#define HOST_US_KEYS (KC_SLASH + 1)
+extern const uint16_t host_us_base_level[HOST_US_KEYS];
+extern const uint16_t host_us_shift_level[HOST_US_KEYS];
+uint16_t host_keypad_character(uint8_t keycode);
+
+// macOS with the U.S. or ABC Extended input source
+void host_macos_reset(void);
+void host_macos_report(uint32_t time_us, const report_keyboard_t* report);
+// The same with the Unicode Hex Input source, reports go to host_macos_report
+void host_macos_hex_reset(void);
+
+// Linux, U.S. layout with Compose on the Menu key and Ctrl+Shift+U
+void host_linux_reset(void);
+void host_linux_report(uint32_t time_us, const report_keyboard_t* report);
+
+// Windows, U.S.-International layout
+void host_windows_reset(void);
+void host_windows_report(uint32_t time_us, const report_keyboard_t* report);
+
+// The host model each host profile types for, see bench_compose.c
+typedef struct {
+  const char* name;
+  void (*reset)(void);
+  sim_report_hook_t report;
+} host_model_t;
+
+extern const host_model_t host_models[HOST_PROFILES];
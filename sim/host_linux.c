@@ -0,0 +1,149 @@
+// Linux, U.S. layout under X11 or Wayland with an input method.
+//
+// Models the base and Shift levels, Caps Lock, the Compose key on Menu with
+// the part of the en_US.UTF-8 Compose table that covers the Neo 2 glyphs,
+// and Ctrl+Shift+U hex input ended by Space or Enter. Backspace erases the
+// last character outside of a sequence. Invalid Compose
+// sequences type nothing. Shortcuts (Control, Alt or Super held) produce no
+// text.
+#include <string.h>
+#include "host.h"
+
+typedef struct {
+  const char* keys;
+  uint16_t codepoint;
+} compose_sequence_t;
+
+static const compose_sequence_t compose_sequences[] = {
+  { "`a", 0xE0 }, { "`e", 0xE8 }, { "`i", 0xEC }, { "`o", 0xF2 }, { "`u", 0xF9 },
+  { "`A", 0xC0 }, { "`E", 0xC8 }, { "`I", 0xCC }, { "`O", 0xD2 }, { "`U", 0xD9 },
+  { "'a", 0xE1 }, { "'e", 0xE9 }, { "'i", 0xED }, { "'o", 0xF3 }, { "'u", 0xFA },
+  { "'A", 0xC1 }, { "'E", 0xC9 }, { "'I", 0xCD }, { "'O", 0xD3 }, { "'U", 0xDA },
+  { "\"a", 0xE4 }, { "\"e", 0xEB }, { "\"i", 0xEF }, { "\"o", 0xF6 }, { "\"u", 0xFC }, { "\"y", 0xFF },
+  { "\"A", 0xC4 }, { "\"E", 0xCB }, { "\"I", 0xCF }, { "\"O", 0xD6 }, { "\"U", 0xDC }, { "\"Y", 0x178 },
+  { "^a", 0xE2 }, { "^e", 0xEA }, { "^i", 0xEE }, { "^o", 0xF4 }, { "^u", 0xFB },
+  { "^A", 0xC2 }, { "^E", 0xCA }, { "^I", 0xCE }, { "^O", 0xD4 }, { "^U", 0xDB },
+  { "~a", 0xE3 }, { "~n", 0xF1 }, { "~o", 0xF5 }, { "~A", 0xC3 }, { "~N", 0xD1 }, { "~O", 0xD5 },
+  { "oa", 0xE5 }, { "oA", 0xC5 }, { "ae", 0xE6 }, { "AE", 0xC6 }, { "oe", 0x153 }, { "OE", 0x152 },
+  { "o/", 0xF8 }, { "O/", 0xD8 }, { ",c", 0xE7 }, { ",C", 0xC7 }, { "ss", 0xDF },
+  { "^1", 0xB9 }, { "^2", 0xB2 }, { "^3", 0xB3 }, { "^_a", 0xAA }, { "^_o", 0xBA },
+  { "oo", 0xB0 }, { "so", 0xA7 }, { "ox", 0xA4 }, { "c/", 0xA2 }, { "y=", 0xA5 }, { "l-", 0xA3 },
+  { "=e", 0x20AC }, { "No", 0x2116 }, { "fs", 0x17F }, { "!!", 0xA1 }, { "??", 0xBF },
+  { "<<", 0xAB }, { ">>", 0xBB }, { ".<", 0x2039 }, { ".>", 0x203A },
+  { "<'", 0x2018 }, { ">'", 0x2019 }, { ",'", 0x201A }, { "<\"", 0x201C }, { ">\"", 0x201D }, { ",\"", 0x201E },
+  { "..", 0x2026 }, { ".-", 0xB7 }, { ".=", 0x2022 }, { "---", 0x2014 }, { "--.", 0x2013 },
+};
+
+#define COMPOSE_MAX 4
+
+static uint8_t previous_keys[KEYBOARD_REPORT_KEYS];
+static bool caps_lock;
+
+static bool composing;
+static char compose_keys[COMPOSE_MAX];
+static uint8_t compose_length;
+
+static bool hex_entry;
+static uint32_t hex_codepoint;
+static uint8_t hex_digits;
+
+void host_linux_reset(void) {
+  host_output_reset();
+  memset(previous_keys, 0, sizeof(previous_keys));
+  caps_lock = false;
+  composing = false;
+  compose_length = 0;
+  hex_entry = false;
+}
+
+// Add a character to the Compose sequence, type it once complete
+static void compose(uint16_t character, uint32_t time_us) {
+  bool prefix = false;
+
+  compose_keys[compose_length++] = character < 0x80 ? character : 0;
+  for (size_t i = 0; i < sizeof(compose_sequences) / sizeof(compose_sequences[0]); i++) {
+    const char* keys = compose_sequences[i].keys;
+
+    if (strncmp(keys, compose_keys, compose_length) != 0) continue;
+    if (keys[compose_length] == '\0') {
+      host_output_append(compose_sequences[i].codepoint, time_us);
+      composing = false;
+      return;
+    }
+    prefix = true;
+  }
+  if (!prefix || compose_length == COMPOSE_MAX) composing = false;
+}
+
+static int8_t hex_digit(uint16_t character) {
+  if (character >= '0' && character <= '9') return character - '0';
+  if (character >= 'a' && character <= 'f') return 10 + character - 'a';
+  return -1;
+}
+
+static void key_pressed(uint8_t keycode, uint8_t mods, uint32_t time_us) {
+  bool shift = mods & (MOD_BIT(KC_LSHIFT) | MOD_BIT(KC_RSHIFT));
+  bool ctrl = mods & (MOD_BIT(KC_LCTRL) | MOD_BIT(KC_RCTRL));
+  bool shortcut = mods & (MOD_BIT(KC_LCTRL) | MOD_BIT(KC_RCTRL) | MOD_BIT(KC_LALT) | MOD_BIT(KC_RALT) |
+                          MOD_BIT(KC_LGUI) | MOD_BIT(KC_RGUI));
+  uint16_t character = 0;
+
+  if (keycode == KC_CAPSLOCK) {
+    caps_lock = !caps_lock;
+    return;
+  }
+  if (ctrl && shift && keycode == KC_U) {
+    hex_entry = true;
+    hex_codepoint = 0;
+    hex_digits = 0;
+    composing = false;
+    return;
+  }
+  if (shortcut) return;
+  if (keycode == KC_BSPACE) {
+    host_output_erase();
+    return;
+  }
+
+  if (keycode == KC_APPLICATION) {
+    composing = true;
+    compose_length = 0;
+    return;
+  }
+  if (keycode < HOST_US_KEYS) {
+    bool upper = shift;
+    if (caps_lock && keycode >= KC_A && keycode <= KC_Z) upper = !upper;
+    character = upper ? host_us_shift_level[keycode] : host_us_base_level[keycode];
+  } else {
+    character = host_keypad_character(keycode);
+  }
+  if (!character) return;
+
+  if (hex_entry) {
+    if (hex_digit(character) >= 0 && hex_digits < 6) {
+      hex_codepoint = (hex_codepoint << 4) | hex_digit(character);
+      hex_digits++;
+    } else {
+      if ((character == ' ' || character == '\n') && hex_digits) {
+        host_output_append(hex_codepoint, time_us);
+      }
+      hex_entry = false;
+    }
+    return;
+  }
+  if (composing) {
+    compose(character, time_us);
+    return;
+  }
+  host_output_append(character, time_us);
+}
+
+void host_linux_report(uint32_t time_us, const report_keyboard_t* report) {
+  for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+    uint8_t keycode = report->keys[i];
+    if (keycode && !memchr(previous_keys, keycode, sizeof(previous_keys))) {
+      key_pressed(keycode, report->mods, time_us);
+    }
+  }
+  memcpy(previous_keys, report->keys, sizeof(previous_keys));
+}
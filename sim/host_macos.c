@@ -0,0 +1,320 @@
+// macOS, U.S. / ABC Extended input source.
+//
+// Models the base, Shift, Option and Option+Shift levels of the layout, the
+// five Option dead keys and Caps Lock. Backspace erases the last character.
+// Shortcuts (Control or Command held) produce no text.
+//
+// The Unicode Hex Input source is the same layout, except that Option with
+// 0-9 or a-f types a hex digit and releasing Option types the code point of
+// the digits. Option+Shift with those keys types nothing.
+#include <stdlib.h>
+#include <string.h>
+#include "host.h"
+
+host_output_t host_output;
+
+#define KEYS HOST_US_KEYS
+
+const uint16_t host_us_base_level[KEYS] = {
+  [KC_A] = 'a', [KC_B] = 'b', [KC_C] = 'c', [KC_D] = 'd', [KC_E] = 'e', [KC_F] = 'f',
+  [KC_G] = 'g', [KC_H] = 'h', [KC_I] = 'i', [KC_J] = 'j', [KC_K] = 'k', [KC_L] = 'l',
+  [KC_M] = 'm', [KC_N] = 'n', [KC_O] = 'o', [KC_P] = 'p', [KC_Q] = 'q', [KC_R] = 'r',
+  [KC_S] = 's', [KC_T] = 't', [KC_U] = 'u', [KC_V] = 'v', [KC_W] = 'w', [KC_X] = 'x',
+  [KC_Y] = 'y', [KC_Z] = 'z',
+  [KC_1] = '1', [KC_2] = '2', [KC_3] = '3', [KC_4] = '4', [KC_5] = '5',
+  [KC_6] = '6', [KC_7] = '7', [KC_8] = '8', [KC_9] = '9', [KC_0] = '0',
+  [KC_ENTER] = '\n', [KC_TAB] = '\t', [KC_SPACE] = ' ',
+  [KC_MINUS] = '-', [KC_EQUAL] = '=', [KC_LBRACKET] = '[', [KC_RBRACKET] = ']',
+  [KC_BSLASH] = '\\', [KC_SCOLON] = ';', [KC_QUOTE] = '\'', [KC_GRAVE] = '`',
+  [KC_COMMA] = ',', [KC_DOT] = '.', [KC_SLASH] = '/',
+};
+
+const uint16_t host_us_shift_level[KEYS] = {
+  [KC_A] = 'A', [KC_B] = 'B', [KC_C] = 'C', [KC_D] = 'D', [KC_E] = 'E', [KC_F] = 'F',
+  [KC_G] = 'G', [KC_H] = 'H', [KC_I] = 'I', [KC_J] = 'J', [KC_K] = 'K', [KC_L] = 'L',
+  [KC_M] = 'M', [KC_N] = 'N', [KC_O] = 'O', [KC_P] = 'P', [KC_Q] = 'Q', [KC_R] = 'R',
+  [KC_S] = 'S', [KC_T] = 'T', [KC_U] = 'U', [KC_V] = 'V', [KC_W] = 'W', [KC_X] = 'X',
+  [KC_Y] = 'Y', [KC_Z] = 'Z',
+  [KC_1] = '!', [KC_2] = '@', [KC_3] = '#', [KC_4] = '$', [KC_5] = '%',
+  [KC_6] = '^', [KC_7] = '&', [KC_8] = '*', [KC_9] = '(', [KC_0] = ')',
+  [KC_ENTER] = '\n', [KC_TAB] = '\t', [KC_SPACE] = ' ',
+  [KC_MINUS] = '_', [KC_EQUAL] = '+', [KC_LBRACKET] = '{', [KC_RBRACKET] = '}',
+  [KC_BSLASH] = '|', [KC_SCOLON] = ':', [KC_QUOTE] = '"', [KC_GRAVE] = '~',
+  [KC_COMMA] = '<', [KC_DOT] = '>', [KC_SLASH] = '?',
+};
+
+static const uint16_t option_level[KEYS] = {
+  [KC_A] = 0x00E5, [KC_B] = 0x222B, [KC_C] = 0x00E7, [KC_D] = 0x2202, [KC_F] = 0x0192,
+  [KC_G] = 0x00A9, [KC_H] = 0x02D9, [KC_J] = 0x2206, [KC_K] = 0x02DA, [KC_L] = 0x00AC,
+  [KC_M] = 0x00B5, [KC_O] = 0x00F8, [KC_P] = 0x03C0, [KC_Q] = 0x0153, [KC_R] = 0x00AE,
+  [KC_S] = 0x00DF, [KC_T] = 0x2020, [KC_V] = 0x221A, [KC_W] = 0x2211, [KC_X] = 0x2248,
+  [KC_Y] = 0x00A5, [KC_Z] = 0x03A9,
+  [KC_1] = 0x00A1, [KC_2] = 0x2122, [KC_3] = 0x00A3, [KC_4] = 0x00A2, [KC_5] = 0x221E,
+  [KC_6] = 0x00A7, [KC_7] = 0x00B6, [KC_8] = 0x2022, [KC_9] = 0x00AA, [KC_0] = 0x00BA,
+  [KC_ENTER] = '\n', [KC_TAB] = '\t', [KC_SPACE] = 0x00A0,
+  [KC_MINUS] = 0x2013, [KC_EQUAL] = 0x2260, [KC_LBRACKET] = 0x201C, [KC_RBRACKET] = 0x2018,
+  [KC_BSLASH] = 0x00AB, [KC_SCOLON] = 0x2026, [KC_QUOTE] = 0x00E6,
+  [KC_COMMA] = 0x2264, [KC_DOT] = 0x2265, [KC_SLASH] = 0x00F7,
+};
+
+static const uint16_t option_shift_level[KEYS] = {
+  [KC_A] = 0x00C5, [KC_B] = 0x0131, [KC_C] = 0x00C7, [KC_D] = 0x00CE, [KC_E] = 0x00B4,
+  [KC_F] = 0x00CF, [KC_G] = 0x02DD, [KC_H] = 0x00D3, [KC_I] = 0x02C6, [KC_J] = 0x00D4,
+  [KC_K] = 0xF8FF, [KC_L] = 0x00D2, [KC_M] = 0x00C2, [KC_N] = 0x02DC, [KC_O] = 0x00D8,
+  [KC_P] = 0x220F, [KC_Q] = 0x0152, [KC_R] = 0x2030, [KC_S] = 0x00CD, [KC_T] = 0x02C7,
+  [KC_U] = 0x00A8, [KC_V] = 0x25CA, [KC_W] = 0x201E, [KC_X] = 0x02DB, [KC_Y] = 0x00C1,
+  [KC_Z] = 0x00B8,
+  [KC_1] = 0x2044, [KC_2] = 0x20AC, [KC_3] = 0x2039, [KC_4] = 0x203A, [KC_5] = 0xFB01,
+  [KC_6] = 0xFB02, [KC_7] = 0x2021, [KC_8] = 0x00B0, [KC_9] = 0x00B7, [KC_0] = 0x201A,
+  [KC_ENTER] = '\n', [KC_TAB] = '\t', [KC_SPACE] = 0x00A0,
+  [KC_MINUS] = 0x2014, [KC_EQUAL] = 0x00B1, [KC_LBRACKET] = 0x201D, [KC_RBRACKET] = 0x2019,
+  [KC_BSLASH] = 0x00BB, [KC_SCOLON] = 0x00DA, [KC_QUOTE] = 0x00C6, [KC_GRAVE] = '`',
+  [KC_COMMA] = 0x00AF, [KC_DOT] = 0x02D8, [KC_SLASH] = 0x00BF,
+};
+
+// Option dead keys: the spacing accent and the letters it combines with
+typedef struct {
+  uint8_t keycode;
+  uint16_t accent;
+  const char* bases;
+  const uint16_t* composed;
+} dead_key_t;
+
+static const uint16_t grave_composed[] = { 0xE0, 0xE8, 0xEC, 0xF2, 0xF9, 0xC0, 0xC8, 0xCC, 0xD2, 0xD9 };
+static const uint16_t acute_composed[] = { 0xE1, 0xE9, 0xED, 0xF3, 0xFA, 0xC1, 0xC9, 0xCD, 0xD3, 0xDA };
+static const uint16_t diaeresis_composed[] = { 0xE4, 0xEB, 0xEF, 0xF6, 0xFC, 0xFF, 0xC4, 0xCB, 0xCF, 0xD6, 0xDC, 0x178 };
+static const uint16_t circumflex_composed[] = { 0xE2, 0xEA, 0xEE, 0xF4, 0xFB, 0xC2, 0xCA, 0xCE, 0xD4, 0xDB };
+static const uint16_t tilde_composed[] = { 0xE3, 0xF1, 0xF5, 0xC3, 0xD1, 0xD5 };
+
+static const dead_key_t dead_keys[] = {
+  { KC_GRAVE, '`',    "aeiouAEIOU",   grave_composed },
+  { KC_E,     0x00B4, "aeiouAEIOU",   acute_composed },
+  { KC_U,     0x00A8, "aeiouyAEIOUY", diaeresis_composed },
+  { KC_I,     0x02C6, "aeiouAEIOU",   circumflex_composed },
+  { KC_N,     0x02DC, "anoANO",       tilde_composed },
+};
+
+static const dead_key_t* pending_dead_key;
+static uint8_t previous_keys[KEYBOARD_REPORT_KEYS];
+static uint8_t previous_mods;
+static bool caps_lock;
+static uint32_t caps_press_us;
+
+static bool hex_input;
+static uint32_t hex_codepoint;
+static uint8_t hex_digits;
+
+/*
+ * Output buffer
+ */
+
+size_t utf8_encode(uint32_t codepoint, char* out) {
+  if (codepoint < 0x80) {
+    out[0] = codepoint;
+    return 1;
+  } else if (codepoint < 0x800) {
+    out[0] = 0xC0 | (codepoint >> 6);
+    out[1] = 0x80 | (codepoint & 0x3F);
+    return 2;
+  } else if (codepoint < 0x10000) {
+    out[0] = 0xE0 | (codepoint >> 12);
+    out[1] = 0x80 | ((codepoint >> 6) & 0x3F);
+    out[2] = 0x80 | (codepoint & 0x3F);
+    return 3;
+  }
+  out[0] = 0xF0 | (codepoint >> 18);
+  out[1] = 0x80 | ((codepoint >> 12) & 0x3F);
+  out[2] = 0x80 | ((codepoint >> 6) & 0x3F);
+  out[3] = 0x80 | (codepoint & 0x3F);
+  return 4;
+}
+
+uint32_t utf8_next(const char** text) {
+  const uint8_t* s = (const uint8_t*)*text;
+  uint32_t codepoint;
+  size_t length;
+
+  if (!*s) return 0;
+  if (s[0] < 0x80) {
+    codepoint = s[0];
+    length = 1;
+  } else if ((s[0] & 0xE0) == 0xC0) {
+    codepoint = s[0] & 0x1F;
+    length = 2;
+  } else if ((s[0] & 0xF0) == 0xE0) {
+    codepoint = s[0] & 0x0F;
+    length = 3;
+  } else {
+    codepoint = s[0] & 0x07;
+    length = 4;
+  }
+  for (size_t i = 1; i < length && s[i]; i++) {
+    codepoint = (codepoint << 6) | (s[i] & 0x3F);
+  }
+  *text += length;
+  return codepoint;
+}
+
+void host_output_reset(void) {
+  host_output.length = 0;
+  host_output.glyphs = 0;
+  host_output.last_glyph_us = 0;
+  if (host_output.text) host_output.text[0] = '\0';
+}
+
+void host_output_append(uint32_t codepoint, uint32_t time_us) {
+  if (host_output.length + 5 > host_output.capacity) {
+    host_output.capacity = host_output.capacity ? host_output.capacity * 2 : 256;
+    host_output.text = realloc(host_output.text, host_output.capacity);
+  }
+  host_output.length += utf8_encode(codepoint, host_output.text + host_output.length);
+  host_output.text[host_output.length] = '\0';
+  host_output.glyphs++;
+  host_output.last_glyph_us = time_us;
+}
+
+void host_output_erase(void) {
+  if (host_output.length == 0) return;
+  do {
+    host_output.length--;
+  } while (host_output.length > 0 && (host_output.text[host_output.length] & 0xC0) == 0x80);
+  host_output.text[host_output.length] = '\0';
+  host_output.glyphs--;
+}
+
+/*
+ * Key handling
+ */
+
+void host_macos_reset(void) {
+  host_output_reset();
+  pending_dead_key = NULL;
+  memset(previous_keys, 0, sizeof(previous_keys));
+  previous_mods = 0;
+  caps_lock = false;
+  caps_press_us = 0;
+  hex_input = false;
+  hex_codepoint = 0;
+  hex_digits = 0;
+}
+
+void host_macos_hex_reset(void) {
+  host_macos_reset();
+  hex_input = true;
+}
+
+static int8_t hex_digit(uint8_t keycode) {
+  if (keycode >= KC_A && keycode <= KC_F) return 10 + keycode - KC_A;
+  if (keycode >= KC_1 && keycode <= KC_9) return 1 + keycode - KC_1;
+  if (keycode == KC_0) return 0;
+  return -1;
+}
+
+uint16_t host_keypad_character(uint8_t keycode) {
+  switch (keycode) {
+    case KC_KP_SLASH:    return '/';
+    case KC_KP_ASTERISK: return '*';
+    case KC_KP_MINUS:    return '-';
+    case KC_KP_PLUS:     return '+';
+    case KC_KP_ENTER:    return '\n';
+    case KC_KP_0:        return '0';
+    case KC_KP_DOT:      return '.';
+    case KC_KP_COMMA:    return ',';
+    case KC_KP_EQUAL:    return '=';
+  }
+  if (keycode >= KC_KP_1 && keycode <= KC_KP_9) {
+    return '1' + (keycode - KC_KP_1);
+  }
+  return 0;
+}
+
+static void emit(uint16_t codepoint, uint32_t time_us) {
+  if (pending_dead_key) {
+    const dead_key_t* dead = pending_dead_key;
+    const char* base = codepoint < 0x80 ? strchr(dead->bases, codepoint) : NULL;
+
+    pending_dead_key = NULL;
+    if (base && codepoint) {
+      host_output_append(dead->composed[base - dead->bases], time_us);
+      return;
+    }
+    host_output_append(dead->accent, time_us);
+    if (codepoint == ' ') return;
+  }
+  host_output_append(codepoint, time_us);
+}
+
+static void key_pressed(uint8_t keycode, uint8_t mods, uint32_t time_us) {
+  bool shift = mods & (MOD_BIT(KC_LSHIFT) | MOD_BIT(KC_RSHIFT));
+  bool option = mods & (MOD_BIT(KC_LALT) | MOD_BIT(KC_RALT));
+  bool shortcut = mods & (MOD_BIT(KC_LCTRL) | MOD_BIT(KC_RCTRL) | MOD_BIT(KC_LGUI) | MOD_BIT(KC_RGUI));
+  uint16_t codepoint = 0;
+
+  if (keycode == KC_CAPSLOCK) {
+    caps_press_us = time_us;
+    return;
+  }
+  if (shortcut) return;
+  if (keycode == KC_BSPACE) {
+    host_output_erase();
+    return;
+  }
+
+  if (hex_input && hex_digit(keycode) >= 0 && option) {
+    if (!shift) {
+      hex_codepoint = (hex_codepoint << 4) | hex_digit(keycode);
+      hex_digits++;
+    }
+    return;
+  }
+  hex_codepoint = 0;
+  hex_digits = 0;
+
+  if (keycode < KEYS) {
+    if (option && !shift) {
+      for (size_t i = 0; i < sizeof(dead_keys) / sizeof(dead_keys[0]); i++) {
+        if (dead_keys[i].keycode == keycode) {
+          if (pending_dead_key) emit(' ', time_us);
+          pending_dead_key = &dead_keys[i];
+          return;
+        }
+      }
+    }
+
+    if (option) {
+      codepoint = shift ? option_shift_level[keycode] : option_level[keycode];
+    } else {
+      bool upper = shift;
+      if (caps_lock && keycode >= KC_A && keycode <= KC_Z) upper = !upper;
+      codepoint = upper ? host_us_shift_level[keycode] : host_us_base_level[keycode];
+    }
+  } else {
+    codepoint = host_keypad_character(keycode);
+  }
+
+  if (codepoint) emit(codepoint, time_us);
+}
+
+void host_macos_report(uint32_t time_us, const report_keyboard_t* report) {
+  uint8_t options = MOD_BIT(KC_LALT) | MOD_BIT(KC_RALT);
+
+  if ((previous_mods & options) && !(report->mods & options)) {
+    if (hex_digits) emit(hex_codepoint, time_us);
+    hex_codepoint = 0;
+    hex_digits = 0;
+  }
+  previous_mods = report->mods;
+  // Caps Lock toggles once it was held long enough, see sim.h
+  if (memchr(previous_keys, KC_CAPSLOCK, sizeof(previous_keys)) &&
+      !memchr(report->keys, KC_CAPSLOCK, sizeof(report->keys)) &&
+      time_us - caps_press_us >= SIM_CAPS_LOCK_DELAY_US) {
+    caps_lock = !caps_lock;
+  }
+  for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+    uint8_t keycode = report->keys[i];
+    if (keycode && !memchr(previous_keys, keycode, sizeof(previous_keys))) {
+      key_pressed(keycode, report->mods, time_us);
+    }
+  }
+  memcpy(previous_keys, report->keys, sizeof(previous_keys));
+}
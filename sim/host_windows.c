@@ -0,0 +1,170 @@
+// Windows, U.S.-International layout.
+//
+// Models the base and Shift levels with their five dead keys (' " ` ~ ^),
+// the AltGr levels on Right Alt and Caps Lock. Backspace erases the last
+// character. Left Alt held over 0 and a
+// decimal code on the keypad types the Windows-1252 character on release.
+// Other shortcuts (Control, Alt or Windows held) produce no text.
+#include <string.h>
+#include "host.h"
+
+#define KEYS HOST_US_KEYS
+
+static const uint16_t altgr_level[KEYS] = {
+  [KC_1] = 0x00A1, [KC_2] = 0x00B2, [KC_3] = 0x00B3, [KC_4] = 0x00A4, [KC_5] = 0x20AC,
+  [KC_6] = 0x00BC, [KC_7] = 0x00BD, [KC_8] = 0x00BE, [KC_9] = 0x2018, [KC_0] = 0x2019,
+  [KC_MINUS] = 0x00A5, [KC_EQUAL] = 0x00D7,
+  [KC_Q] = 0x00E4, [KC_W] = 0x00E5, [KC_E] = 0x00E9, [KC_R] = 0x00AE, [KC_T] = 0x00FE,
+  [KC_Y] = 0x00FC, [KC_U] = 0x00FA, [KC_I] = 0x00ED, [KC_O] = 0x00F3, [KC_P] = 0x00F6,
+  [KC_LBRACKET] = 0x00AB, [KC_RBRACKET] = 0x00BB, [KC_BSLASH] = 0x00AC,
+  [KC_A] = 0x00E1, [KC_S] = 0x00DF, [KC_D] = 0x00F0, [KC_L] = 0x00F8, [KC_SCOLON] = 0x00B6,
+  [KC_QUOTE] = 0x00B4, [KC_Z] = 0x00E6, [KC_C] = 0x00A9, [KC_N] = 0x00F1, [KC_M] = 0x00B5,
+  [KC_COMMA] = 0x00E7, [KC_SLASH] = 0x00BF,
+};
+
+static const uint16_t altgr_shift_level[KEYS] = {
+  [KC_1] = 0x00B9, [KC_4] = 0x00A3, [KC_SCOLON] = 0x00B0, [KC_QUOTE] = 0x00A8,
+  [KC_Q] = 0x00C4, [KC_W] = 0x00C5, [KC_E] = 0x00C9, [KC_T] = 0x00DE, [KC_Y] = 0x00DC,
+  [KC_U] = 0x00DA, [KC_I] = 0x00CD, [KC_O] = 0x00D3, [KC_P] = 0x00D6,
+  [KC_A] = 0x00C1, [KC_S] = 0x00A7, [KC_D] = 0x00D0, [KC_L] = 0x00D8,
+  [KC_Z] = 0x00C6, [KC_C] = 0x00A2, [KC_N] = 0x00D1, [KC_COMMA] = 0x00C7,
+};
+
+// Dead keys: the character typed with Space and the letters it combines with
+typedef struct {
+  uint16_t accent;
+  const char* bases;
+  const uint16_t* composed;
+} dead_key_t;
+
+static const uint16_t acute_composed[] = { 0xE1, 0xE9, 0xED, 0xF3, 0xFA, 0xFD, 0xE7, 0xC1, 0xC9, 0xCD, 0xD3, 0xDA, 0xDD, 0xC7 };
+static const uint16_t diaeresis_composed[] = { 0xE4, 0xEB, 0xEF, 0xF6, 0xFC, 0xFF, 0xC4, 0xCB, 0xCF, 0xD6, 0xDC };
+static const uint16_t grave_composed[] = { 0xE0, 0xE8, 0xEC, 0xF2, 0xF9, 0xC0, 0xC8, 0xCC, 0xD2, 0xD9 };
+static const uint16_t tilde_composed[] = { 0xE3, 0xF1, 0xF5, 0xC3, 0xD1, 0xD5 };
+static const uint16_t circumflex_composed[] = { 0xE2, 0xEA, 0xEE, 0xF4, 0xFB, 0xC2, 0xCA, 0xCE, 0xD4, 0xDB };
+
+static const dead_key_t dead_keys[] = {
+  { '\'', "aeiouycAEIOUYC", acute_composed },
+  { '"',  "aeiouyAEIOU",    diaeresis_composed },
+  { '`',  "aeiouAEIOU",     grave_composed },
+  { '~',  "anoANO",         tilde_composed },
+  { '^',  "aeiouAEIOU",     circumflex_composed },
+};
+
+// Windows-1252 0x80 .. 0x9F, 0 where unassigned
+static const uint16_t cp1252_high[32] = {
+  0x20AC, 0,      0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+  0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0,      0x017D, 0,
+  0,      0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+  0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0,      0x017E, 0x0178,
+};
+
+static uint8_t previous_keys[KEYBOARD_REPORT_KEYS];
+static uint8_t previous_mods;
+static bool caps_lock;
+static const dead_key_t* pending_dead_key;
+
+// Alt+keypad code
+static uint16_t alt_code;
+static uint8_t alt_digits;
+static bool alt_leading_zero;
+
+void host_windows_reset(void) {
+  host_output_reset();
+  memset(previous_keys, 0, sizeof(previous_keys));
+  previous_mods = 0;
+  caps_lock = false;
+  pending_dead_key = NULL;
+  alt_code = 0;
+  alt_digits = 0;
+}
+
+static const dead_key_t* dead_key(uint16_t character) {
+  for (size_t i = 0; i < sizeof(dead_keys) / sizeof(dead_keys[0]); i++) {
+    if (dead_keys[i].accent == character) return &dead_keys[i];
+  }
+  return NULL;
+}
+
+static void emit(uint16_t codepoint, uint32_t time_us) {
+  if (pending_dead_key) {
+    const dead_key_t* dead = pending_dead_key;
+    const char* base = codepoint < 0x80 && codepoint ? strchr(dead->bases, codepoint) : NULL;
+
+    pending_dead_key = NULL;
+    if (base) {
+      host_output_append(dead->composed[base - dead->bases], time_us);
+      return;
+    }
+    host_output_append(dead->accent, time_us);
+    if (codepoint == ' ') return;
+  }
+  host_output_append(codepoint, time_us);
+}
+
+static void key_pressed(uint8_t keycode, uint8_t mods, uint32_t time_us) {
+  bool shift = mods & (MOD_BIT(KC_LSHIFT) | MOD_BIT(KC_RSHIFT));
+  bool altgr = mods & MOD_BIT(KC_RALT);
+  bool alt = mods & MOD_BIT(KC_LALT);
+  bool shortcut = mods & (MOD_BIT(KC_LCTRL) | MOD_BIT(KC_RCTRL) | MOD_BIT(KC_LGUI) | MOD_BIT(KC_RGUI));
+  uint16_t codepoint = 0;
+
+  if (keycode == KC_CAPSLOCK) {
+    caps_lock = !caps_lock;
+    return;
+  }
+  if (alt && !altgr && !shortcut) {
+    uint16_t digit = host_keypad_character(keycode);
+
+    if (digit >= '0' && digit <= '9') {
+      if (alt_digits == 0) alt_leading_zero = digit == '0';
+      alt_code = alt_code * 10 + digit - '0';
+      alt_digits++;
+    }
+    return;
+  }
+  if (shortcut || alt) return;
+  if (keycode == KC_BSPACE) {
+    host_output_erase();
+    return;
+  }
+
+  if (keycode < KEYS) {
+    if (altgr) {
+      codepoint = shift ? altgr_shift_level[keycode] : altgr_level[keycode];
+    } else {
+      bool upper = shift;
+      if (caps_lock && keycode >= KC_A && keycode <= KC_Z) upper = !upper;
+      codepoint = upper ? host_us_shift_level[keycode] : host_us_base_level[keycode];
+      if (dead_key(codepoint)) {
+        if (pending_dead_key) emit(' ', time_us);
+        pending_dead_key = dead_key(codepoint);
+        return;
+      }
+    }
+  } else {
+    codepoint = host_keypad_character(keycode);
+  }
+
+  if (codepoint) emit(codepoint, time_us);
+}
+
+void host_windows_report(uint32_t time_us, const report_keyboard_t* report) {
+  if ((previous_mods & MOD_BIT(KC_LALT)) && !(report->mods & MOD_BIT(KC_LALT))) {
+    // Only the Windows-1252 codes with a leading 0 are modelled
+    if (alt_digits && alt_leading_zero && alt_code >= 0x80 && alt_code <= 0xFF) {
+      uint16_t codepoint = alt_code < 0xA0 ? cp1252_high[alt_code - 0x80] : alt_code;
+      if (codepoint) emit(codepoint, time_us);
+    }
+    alt_code = 0;
+    alt_digits = 0;
+  }
+  previous_mods = report->mods;
+  for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+    uint8_t keycode = report->keys[i];
+    if (keycode && !memchr(previous_keys, keycode, sizeof(previous_keys))) {
+      key_pressed(keycode, report->mods, time_us);
+    }
+  }
+  memcpy(previous_keys, report->keys, sizeof(previous_keys));
+}
@@ -0,0 +1,67 @@
+// Latency histograms read back from the firmware over raw HID, the way a
+// host tool talks to the board, with times from the virtual clock.
+#include <string.h>
+#include "bench.h"
+#include "hid_commands.h"
+#include "raw_hid.h"
+
+static const char* const class_names[LATENCY_CLASSES] = {
+  [LATENCY_PLAIN] = "plain",
+  [LATENCY_MACRO] = "macro",
+  [LATENCY_TAP_HOLD] = "tap-hold",
+  [LATENCY_LAYER] = "layer",
+};
+
+static uint16_t get_word(const uint8_t* data, uint8_t offset) {
+  return data[offset] | (data[offset + 1] << 8);
+}
+
+void latency_print(const char* indent) {
+  printf("%s%-9s %6s %6s", indent, "latency", "count", "max");
+  for (uint8_t b = 0; b < LATENCY_BUCKETS; b++) {
+    char label[16];
+
+    if (b == 0) snprintf(label, sizeof(label), "0");
+    else if (b == 1) snprintf(label, sizeof(label), "1");
+    else if (b == LATENCY_BUCKETS - 1) snprintf(label, sizeof(label), "%u+", 1 << (b - 1));
+    else snprintf(label, sizeof(label), "%u-%u", 1 << (b - 1), (1 << b) - 1);
+    printf(" %7s", label);
+  }
+  printf("\n");
+
+  for (uint8_t c = 0; c < LATENCY_CLASSES; c++) {
+    uint8_t request[RAW_EPSIZE] = { HID_LATENCY_READ, c };
+
+    raw_hid_receive(request, sizeof(request));
+    if (sim_raw_hid_reply[0] != HID_LATENCY_READ || sim_raw_hid_reply[1] != c) {
+      printf("%s%-9s no reply\n", indent, class_names[c]);
+      continue;
+    }
+    printf("%s%-9s %6u %6u", indent, class_names[c], get_word(sim_raw_hid_reply, 2),
+           get_word(sim_raw_hid_reply, 4));
+    for (uint8_t b = 0; b < LATENCY_BUCKETS; b++) {
+      printf(" %7u", get_word(sim_raw_hid_reply, 6 + 2 * b));
+    }
+    printf("\n");
+  }
+}
+
+int latency(int argc, char** argv) {
+  if (argc < 1) {
+    fprintf(stderr, "usage: neo2sim latency <trace>...\n");
+    return 2;
+  }
+
+  sim_reset();
+  for (int i = 0; i < argc; i++) {
+    sim_trace_t trace = { 0 };
+
+    if (!sim_trace_load(&trace, argv[i])) {
+      return 1;
+    }
+    sim_trace_replay(&trace, 1000 * 1000);
+    sim_trace_free(&trace);
+  }
+  latency_print("");
+  return 0;
+}
@@ -0,0 +1,221 @@
+// LCD model, keyframe runner and the font stand-ins.
+#include <string.h>
+#include "lcd.h"
+#include "mcufont.h"
+#include "visualizer_keyframes.h"
+#include "lcd_backlight_keyframes.h"
+#include "lcd_backlight.h"
+#include "default_animations.h"
+
+color_t sim_lcd[SIM_LCD_HEIGHT][SIM_LCD_WIDTH];
+sim_lcd_stats_t sim_lcd_stats;
+visualizer_state_t* sim_visualizer_state;
+GDisplay* GDISP;
+
+void sim_lcd_reset(void) {
+  memset(sim_lcd, White, sizeof(sim_lcd));
+  memset(&sim_lcd_stats, 0, sizeof(sim_lcd_stats));
+}
+
+/*
+ * uGFX
+ */
+
+static void put_pixel(coord_t x, coord_t y, color_t color) {
+  if (x < 0 || y < 0 || x >= SIM_LCD_WIDTH || y >= SIM_LCD_HEIGHT) return;
+  sim_lcd[y][x] = color;
+  sim_lcd_stats.pixels++;
+}
+
+void gdispGClear(GDisplay* g, color_t color) {
+  sim_lcd_stats.calls++;
+  for (coord_t y = 0; y < SIM_LCD_HEIGHT; y++) {
+    for (coord_t x = 0; x < SIM_LCD_WIDTH; x++) put_pixel(x, y, color);
+  }
+}
+
+void gdispGDrawPixel(GDisplay* g, coord_t x, coord_t y, color_t color) {
+  sim_lcd_stats.calls++;
+  put_pixel(x, y, color);
+}
+
+void gdispGFillArea(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
+  sim_lcd_stats.calls++;
+  for (coord_t row = y; row < y + cy; row++) {
+    for (coord_t col = x; col < x + cx; col++) put_pixel(col, row, color);
+  }
+}
+
+void gdispGBlitArea(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy,
+                    coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t* buffer) {
+  sim_lcd_stats.calls++;
+  for (coord_t row = 0; row < cy; row++) {
+    for (coord_t col = 0; col < cx; col++) {
+      put_pixel(x + col, y + row, buffer[(srcy + row) * srccx + srcx + col]);
+    }
+  }
+}
+
+/*
+ * Visualizer library
+ */
+
+void start_keyframe_animation(keyframe_animation_t* animation) {
+  visualizer_state_t* state = sim_visualizer_state;
+  uint32_t calls = sim_lcd_stats.calls;
+  uint32_t pixels = sim_lcd_stats.pixels;
+
+  for (uint8_t frame = 0; frame < animation->num_frames; frame++) {
+    animation->frame_functions[frame](animation, state);
+  }
+
+  if (sim_lcd_stats.calls != calls) {
+    sim_stats.lcd_updates++;
+    sim_log("lcd", "redraw \"%s\", %u calls, %u pixels", state->layer_text ? state->layer_text : "",
+            sim_lcd_stats.calls - calls, sim_lcd_stats.pixels - pixels);
+  }
+}
+
+void stop_keyframe_animation(keyframe_animation_t* animation) {
+}
+
+bool keyframe_no_operation(keyframe_animation_t* animation, visualizer_state_t* state) {
+  return false;
+}
+
+bool keyframe_animate_backlight_color(keyframe_animation_t* animation, visualizer_state_t* state) {
+  state->current_lcd_color = state->target_lcd_color;
+  sim_lcd_color(state->current_lcd_color);
+  return false;
+}
+
+bool keyframe_set_backlight_color(keyframe_animation_t* animation, visualizer_state_t* state) {
+  return keyframe_animate_backlight_color(animation, state);
+}
+
+void lcd_backlight_brightness(uint8_t b) {
+}
+
+keyframe_animation_t default_startup_animation = { .num_frames = 0 };
+keyframe_animation_t default_suspend_animation = { .num_frames = 0 };
+
+/*
+ * 5x7 font, one byte per column, least significant bit on top
+ */
+
+#define FONT_FIRST ' '
+#define FONT_LAST  'Z'
+
+static const uint8_t font5x7[FONT_LAST - FONT_FIRST + 1][5] = {
+  { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, // space !
+  { 0x00, 0x07, 0x00, 0x07, 0x00 }, { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, // " #
+  { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 }, // $ %
+  { 0x36, 0x49, 0x55, 0x22, 0x50 }, { 0x00, 0x05, 0x03, 0x00, 0x00 }, // & '
+  { 0x00, 0x1C, 0x22, 0x41, 0x00 }, { 0x00, 0x41, 0x22, 0x1C, 0x00 }, // ( )
+  { 0x08, 0x2A, 0x1C, 0x2A, 0x08 }, { 0x08, 0x08, 0x3E, 0x08, 0x08 }, // * +
+  { 0x00, 0x50, 0x30, 0x00, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, // , -
+  { 0x00, 0x60, 0x60, 0x00, 0x00 }, { 0x20, 0x10, 0x08, 0x04, 0x02 }, // . /
+  { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 }, // 0 1
+  { 0x42, 0x61, 0x51, 0x49, 0x46 }, { 0x21, 0x41, 0x45, 0x4B, 0x31 }, // 2 3
+  { 0x18, 0x14, 0x12, 0x7F, 0x10 }, { 0x27, 0x45, 0x45, 0x45, 0x39 }, // 4 5
+  { 0x3C, 0x4A, 0x49, 0x49, 0x30 }, { 0x01, 0x71, 0x09, 0x05, 0x03 }, // 6 7
+  { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x06, 0x49, 0x49, 0x29, 0x1E }, // 8 9
+  { 0x00, 0x36, 0x36, 0x00, 0x00 }, { 0x00, 0x56, 0x36, 0x00, 0x00 }, // : ;
+  { 0x08, 0x14, 0x22, 0x41, 0x00 }, { 0x14, 0x14, 0x14, 0x14, 0x14 }, // < =
+  { 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x51, 0x09, 0x06 }, // > ?
+  { 0x32, 0x49, 0x79, 0x41, 0x3E }, { 0x7E, 0x11, 0x11, 0x11, 0x7E }, // @ A
+  { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 }, // B C
+  { 0x7F, 0x41, 0x41, 0x22, 0x1C }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, // D E
+  { 0x7F, 0x09, 0x09, 0x09, 0x01 }, { 0x3E, 0x41, 0x49, 0x49, 0x7A }, // F G
+  { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 }, // H I
+  { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, // J K
+  { 0x7F, 0x40, 0x40, 0x40, 0x40 }, { 0x7F, 0x02, 0x0C, 0x02, 0x7F }, // L M
+  { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E }, // N O
+  { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, // P Q
+  { 0x7F, 0x09, 0x19, 0x29, 0x46 }, { 0x46, 0x49, 0x49, 0x49, 0x31 }, // R S
+  { 0x01, 0x01, 0x7F, 0x01, 0x01 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F }, // T U
+  { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x3F, 0x40, 0x38, 0x40, 0x3F }, // V W
+  { 0x63, 0x14, 0x08, 0x14, 0x63 }, { 0x07, 0x08, 0x70, 0x08, 0x07 }, // X Y
+  { 0x61, 0x51, 0x49, 0x45, 0x43 },                                   // Z
+};
+
+#define FONT_ADVANCE 6
+#define FONT_HEIGHT  7
+
+// Stand-ins for the fonts the visualizer opens. DejaVu Sans Bold 12 becomes
+// the 5x7 font at twice the height, so the longest label still fits.
+static const struct mf_font_s fonts[] = {
+  { "fixed_5x8",        8,  0, 7,  1, 1, 1 },
+  { "DejaVuSansBold12", 16, 0, 15, 1, 2, 1 },
+};
+
+font_t gdispOpenFont(const char* name) {
+  for (size_t i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++) {
+    if (strcmp(fonts[i].short_name, name) == 0) return &fonts[i];
+  }
+  return &fonts[0];
+}
+
+static const uint8_t* font_glyph(char c) {
+  if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+  if (c < FONT_FIRST || c > FONT_LAST) c = '?';
+  return font5x7[c - FONT_FIRST];
+}
+
+// One run per lit font pixel and scaled row, every pixel opaque
+uint8_t mf_render_character(const struct mf_font_s* font, int16_t x0, int16_t y0, mf_char character,
+                            mf_pixel_callback_t callback, void* state) {
+  const uint8_t* glyph = font_glyph(character);
+
+  for (uint8_t col = 0; col < 5; col++) {
+    for (uint8_t row = 0; row < FONT_HEIGHT; row++) {
+      if (!(glyph[col] & (1 << row))) continue;
+      for (uint8_t y = 0; y < font->scale_y; y++) {
+        callback(x0 + col * font->scale_x, y0 + font->top + row * font->scale_y + y, font->scale_x, 255, state);
+      }
+    }
+  }
+  return FONT_ADVANCE * font->scale_x;
+}
+
+int16_t mf_get_string_width(const struct mf_font_s* font, mf_str text, uint16_t count, bool kern) {
+  size_t length = strlen(text);
+
+  if (count && count < length) length = count;
+  return (int16_t)(length * FONT_ADVANCE * font->scale_x);
+}
+
+void mf_render_aligned(const struct mf_font_s* font, int16_t x0, int16_t y0, enum mf_align_t align,
+                       mf_str text, uint16_t count, mf_character_callback_t callback, void* state) {
+  int16_t width = mf_get_string_width(font, text, count, false);
+
+  if (align == MF_ALIGN_CENTER) x0 -= width / 2;
+  if (align == MF_ALIGN_RIGHT) x0 -= width;
+  for (uint16_t i = 0; text[i] && (!count || i < count); i++) {
+    x0 += callback(x0, y0, text[i], state);
+  }
+}
+
+/*
+ * Text the way gdisp draws it, one call per run of pixels
+ */
+
+typedef struct {
+  font_t font;
+  color_t color;
+} draw_string_t;
+
+static void draw_run(int16_t x, int16_t y, uint8_t count, uint8_t alpha, void* state) {
+  sim_lcd_stats.calls++;
+  for (; count; count--, x++) put_pixel(x, y, ((draw_string_t*)state)->color);
+}
+
+static uint8_t draw_character(int16_t x, int16_t y, mf_char character, void* state) {
+  return mf_render_character(((draw_string_t*)state)->font, x, y, character, draw_run, state);
+}
+
+void gdispGDrawString(GDisplay* g, coord_t x, coord_t y, const char* str, font_t font, color_t color) {
+  draw_string_t state = { font, color };
+
+  mf_render_aligned(font, x + font->baseline_x, y, MF_ALIGN_LEFT, str, 0, draw_character, &state);
+}
@@ -0,0 +1,23 @@
+// LCD model: a 128x32 framebuffer behind the uGFX calls of the visualizer,
+// the keyframe animation runner and a 5x7 font behind the uGFX fonts.
+#pragma once
+
+#include "sim.h"
+#include "visualizer.h"
+
+#define SIM_LCD_WIDTH  128
+#define SIM_LCD_HEIGHT 32
+
+extern color_t sim_lcd[SIM_LCD_HEIGHT][SIM_LCD_WIDTH];
+
+// gdisp calls and pixels written since the last sim_lcd_reset()
+typedef struct {
+  uint32_t calls;
+  uint32_t pixels;
+} sim_lcd_stats_t;
+
+extern sim_lcd_stats_t sim_lcd_stats;
+// Visualizer state handed to the frame functions
+extern visualizer_state_t* sim_visualizer_state;
+
+void sim_lcd_reset(void);
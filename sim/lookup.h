@@ -0,0 +1,12 @@
+// Keymap storage: the sparse layer packer and the lookup benchmark.
+#pragma once
+
+#include "sim.h"
+
+bool lookup_is_layout_position(uint8_t row, uint8_t col);
+uint16_t lookup_fill(uint8_t layer);
+
+// neo2sim pack-layers: print sparse_layers.h
+int pack_layers(int argc, char** argv);
+// neo2sim bench-lookup: compare sparse and dense keycode lookup
+int bench_lookup(int argc, char** argv);
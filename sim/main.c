@@ -0,0 +1,135 @@
+// neo2sim: command line driver for the host-side simulator.
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "bench.h"
+#include "lcd.h"
+#include "lookup.h"
+
+static void usage(void) {
+  fprintf(stderr,
+    "usage: neo2sim [--scan-us N] [--poll-us N] <command> [args]\n"
+    "\n"
+    "commands:\n"
+    "  replay <trace>...   replay press/release traces and print the event log\n"
+    "  bench-corpus [--max R] [--interval-ms N] [--top N] <text>...\n"
+    "                      type text files through the keymap, report HID reports\n"
+    "                      and emission time per character, fail above R reports\n"
+    "                      per character\n"
+    "  bench-lcd           compare the cost of drawing each layer label as text\n"
+    "                      with the pre-rendered label blit, and the status\n"
+    "                      screen redraws per status change\n"
+    "  bench-compose       check the glyph forms compose.c is built with against\n"
+    "                      the shortest ones of every host profile\n"
+    "  bench-repeat        hold glyph keys on every host profile and measure the\n"
+    "                      rate their auto-repeat reaches the host at\n"
+    "  bench-snippets      expand every snippet on every host profile, compare\n"
+    "                      matching through the trie with a scan of the triggers\n"
+    "  snippet-trie        print snippet_trie.h for the current keymap\n"
+    "  bench-recorder      record the corpora as a dynamic macro, replay it and\n"
+    "                      report bytes per event and replay throughput\n"
+    "  glyph-forms         print glyph_forms.h for the current keymap\n"
+    "  bench-lookup [--iterations N]\n"
+    "                      compare keycode lookup through the sparse layers with\n"
+    "                      the dense keymap, and the flash both take\n"
+    "  pack-layers         print sparse_layers.h for the current keymap\n"
+    "  latency <trace>...  replay traces back to back and print the key-to-report\n"
+    "                      latency histograms read over raw HID\n"
+    "  heatmap <trace|text>...\n"
+    "                      replay traces and type text files, print the key,\n"
+    "                      macro and layer usage counters read over raw HID\n"
+    "  fuzz [--seed N] [--runs N] [--events N]\n"
+    "                      play random interleavings of the modifier, layer and\n"
+    "                      glyph keys, check the layer and modifier state after\n"
+    "                      every event and shrink a failing run to a trace\n");
+}
+
+static int cmd_replay(int argc, char** argv) {
+  unsigned failed = 0;
+
+  if (argc < 1) {
+    usage();
+    return 2;
+  }
+
+  sim_config.log = stdout;
+  for (int i = 0; i < argc; i++) {
+    sim_trace_t trace = { 0 };
+
+    if (!sim_trace_load(&trace, argv[i])) {
+      return 1;
+    }
+    printf("# %s\n", argv[i]);
+    sim_reset();
+    failed += sim_trace_replay(&trace, 1000 * 1000);
+    printf("# %u events, %u reports, %u layer changes, %u LED calls, %u LCD updates, %u scans, blocked %u us\n",
+           sim_stats.events, sim_stats.reports, sim_stats.layer_changes, sim_stats.led_calls,
+           sim_stats.lcd_updates, sim_stats.scans, sim_stats.blocked_us);
+    printf("# report queue: %u queued, max depth %u, %u overflows\n",
+           report_queue_stats.queued, report_queue_stats.max_depth, report_queue_stats.overflows);
+    printf("# tap-hold: %u taps, %u holds (%u early), %u events replayed\n",
+           tap_hold_stats.taps, tap_hold_stats.holds, tap_hold_stats.early_holds, tap_hold_stats.replayed);
+    printf("# snippets: %u expanded, %u events held back, %u overflows\n",
+           snippet_stats.expansions, snippet_stats.held_back, snippet_stats.overflows);
+    printf("# recorder: %u events in %u bytes, %u replayed\n",
+           recorder_stats.events, recorder_stats.bytes, recorder_stats.replayed);
+    sim_trace_free(&trace);
+  }
+  if (failed) {
+    printf("FAIL: %u expectations not met\n", failed);
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  int i = 1;
+
+  for (; i + 1 < argc && strncmp(argv[i], "--", 2) == 0; i += 2) {
+    if (strcmp(argv[i], "--scan-us") == 0) {
+      sim_config.scan_us = atoi(argv[i + 1]);
+    } else if (strcmp(argv[i], "--poll-us") == 0) {
+      sim_config.poll_us = atoi(argv[i + 1]);
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (i >= argc || sim_config.scan_us == 0 || sim_config.poll_us == 0) {
+    usage();
+    return 2;
+  }
+
+  if (strcmp(argv[i], "replay") == 0) {
+    return cmd_replay(argc - i - 1, argv + i + 1);
+  } else if (strcmp(argv[i], "bench-corpus") == 0) {
+    return bench_corpus(argc - i - 1, argv + i + 1);
+  } else if (strcmp(argv[i], "bench-lcd") == 0) {
+    return bench_lcd(argc - i - 1, argv + i + 1);
+  } else if (strcmp(argv[i], "bench-compose") == 0) {
+    return bench_compose(argc - i - 1, argv + i + 1);
+  } else if (strcmp(argv[i], "bench-repeat") == 0) {
+    return bench_repeat(argc - i - 1, argv + i + 1);
+  } else if (strcmp(argv[i], "bench-snippets") == 0) {
+    return bench_snippets(argc - i - 1, argv + i + 1);
+  } else if (strcmp(argv[i], "fuzz") == 0) {
+    return fuzz(argc - i - 1, argv + i + 1);
+  } else if (strcmp(argv[i], "bench-recorder") == 0) {
+    return bench_recorder(argc - i - 1, argv + i + 1);
+  } else if (strcmp(argv[i], "snippet-trie") == 0) {
+    return print_snippet_trie(argc - i - 1, argv + i + 1);
+  } else if (strcmp(argv[i], "glyph-forms") == 0) {
+    return print_glyph_forms(argc - i - 1, argv + i + 1);
+  } else if (strcmp(argv[i], "bench-lookup") == 0) {
+    return bench_lookup(argc - i - 1, argv + i + 1);
+  } else if (strcmp(argv[i], "pack-layers") == 0) {
+    return pack_layers(argc - i - 1, argv + i + 1);
+  } else if (strcmp(argv[i], "latency") == 0) {
+    return latency(argc - i - 1, argv + i + 1);
+  } else if (strcmp(argv[i], "heatmap") == 0) {
+    return heatmap(argc - i - 1, argv + i + 1);
+  }
+
+  usage();
+  return 2;
+}
@@ -0,0 +1,117 @@
+// Layer packer: encodes the layers LAYER_IS_SPARSE() names as sparse layers
+// and prints sparse_layers.h. The simulator is built with
+// SPARSE_LAYERS_SOURCE, so keymaps[] still holds every layer in full.
+#include <stdlib.h>
+#include <string.h>
+#include "layers.h"
+#include "keymap_sparse.h"
+#include "lookup.h"
+
+extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
+
+#define LAYOUT_KEYS 76
+
+bool lookup_is_layout_position(uint8_t row, uint8_t col) {
+  keypos_t pos;
+
+  for (uint8_t index = 0; index < LAYOUT_KEYS; index++) {
+    if (sim_layout_position(index, &pos) && pos.row == row && pos.col == col) return true;
+  }
+  return false;
+}
+
+// Most common keycode among the positions of the layout
+uint16_t lookup_fill(uint8_t layer) {
+  uint16_t best = KC_NO;
+  uint8_t best_count = 0;
+  keypos_t pos, other;
+
+  for (uint8_t i = 0; i < LAYOUT_KEYS; i++) {
+    uint8_t count = 0;
+
+    sim_layout_position(i, &pos);
+    for (uint8_t j = 0; j < LAYOUT_KEYS; j++) {
+      sim_layout_position(j, &other);
+      if (keymaps[layer][other.row][other.col] == keymaps[layer][pos.row][pos.col]) count++;
+    }
+    if (count > best_count) {
+      best = keymaps[layer][pos.row][pos.col];
+      best_count = count;
+    }
+  }
+  return best;
+}
+
+// Keycodes of a layer that differ from its fill, row by row
+static uint8_t layer_keycodes(uint8_t layer, uint16_t fill, uint16_t* keycodes) {
+  uint8_t count = 0;
+
+  for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+      if (!lookup_is_layout_position(row, col) || keymaps[layer][row][col] == fill) continue;
+      keycodes[count++] = keymaps[layer][row][col];
+    }
+  }
+  return count;
+}
+
+int pack_layers(int argc, char** argv) {
+  static uint16_t packed[SPARSE_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS];
+  uint16_t keycodes[MATRIX_ROWS * MATRIX_COLS];
+  uint16_t base[LAYER_COUNT];
+  uint16_t length = 0;
+
+  printf("// Sparse encoding of the layers LAYER_IS_SPARSE() names, see keymap_sparse.h.\n");
+  printf("// Generated by `make -C sim layers` from keymaps[] in keymap.c.\n");
+  printf("#pragma once\n\n");
+
+  // A layer whose keycodes are already packed, as a whole or as the start
+  // or middle of another layer's, points its base there instead
+  printf("static const uint16_t PROGMEM sparse_keycodes[] = {");
+  for (uint8_t layer = 0; layer < LAYER_COUNT; layer++) {
+    if (!LAYER_IS_SPARSE(layer)) continue;
+
+    uint8_t count = layer_keycodes(layer, lookup_fill(layer), keycodes);
+
+    for (base[layer] = 0; base[layer] + count <= length; base[layer]++) {
+      if (memcmp(&packed[base[layer]], keycodes, count * sizeof(uint16_t)) == 0) break;
+    }
+    if (base[layer] + count <= length) continue;
+
+    base[layer] = length;
+    printf("\n  // layer %u", layer);
+    for (uint8_t i = 0; i < count; i++) {
+      printf("%s0x%04x,", i % 8 ? " " : "\n  ", keycodes[i]);
+      packed[length++] = keycodes[i];
+    }
+  }
+  printf("\n};\n\n");
+
+  printf("static const sparse_layer_t PROGMEM sparse_layers[SPARSE_LAYER_COUNT] = {\n");
+  for (uint8_t layer = 0; layer < LAYER_COUNT; layer++) {
+    if (!LAYER_IS_SPARSE(layer)) continue;
+
+    uint16_t fill = lookup_fill(layer);
+    uint8_t columns[MATRIX_ROWS] = { 0 };
+    uint8_t offsets[MATRIX_ROWS] = { 0 };
+    uint8_t count = 0;
+
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+      offsets[row] = count;
+      for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        if (!lookup_is_layout_position(row, col) || keymaps[layer][row][col] == fill) continue;
+        columns[row] |= 1 << col;
+        count++;
+      }
+    }
+
+    printf("  // layer %u: %u keycodes, the rest 0x%04x\n", layer, count, fill);
+    printf("  {\n    .fill = 0x%04x,\n    .base = %u,\n    .columns = {", fill, base[layer]);
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) printf("%s0x%02x", row ? ", " : " ", columns[row]);
+    printf(" },\n    .offsets = {");
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) printf("%s%u", row ? ", " : " ", offsets[row]);
+    printf(" },\n  },\n");
+  }
+  printf("};\n");
+  return 0;
+}
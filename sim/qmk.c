@@ -0,0 +1,490 @@
+// QMK core behaviour needed by the keymap: report state, modifiers, layers,
+// keycode lookup and action processing, timers and SEND_STRING.
+//
+// Only the paths the keymap exercises are modelled. Tap counting for TT()
+// follows action_tapping.c, but key presses are never held back while a
+// tapping key is undecided.
+#include <string.h>
+#include "sim.h"
+#include "raw_hid.h"
+
+extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
+
+static report_keyboard_t report;
+report_keyboard_t *keyboard_report = &report;
+
+static uint8_t real_mods;
+static uint8_t weak_mods;
+static uint8_t host_leds;
+static uint32_t endpoint_busy_until;
+// Time the host saw Caps Lock go down
+static uint32_t caps_press_us;
+
+report_keyboard_t sim_host_report;
+
+uint32_t default_layer_state;
+uint32_t layer_state;
+
+// Layer each pressed key was resolved on, so releases hit the same action
+#ifdef PREVENT_STUCK_MODIFIERS
+static uint8_t source_layers[MATRIX_ROWS][MATRIX_COLS];
+#endif
+
+// Tap state of the last TT() key
+static struct {
+  keypos_t key;
+  uint8_t  count;
+  bool     interrupted;
+  uint16_t press_time;
+  uint16_t release_time;
+} tapping;
+
+void sim_qmk_reset(void) {
+  memset(&report, 0, sizeof(report));
+  real_mods = 0;
+  weak_mods = 0;
+  host_leds = 0;
+  memset(&sim_host_report, 0, sizeof(sim_host_report));
+  endpoint_busy_until = 0;
+  caps_press_us = 0;
+  default_layer_state = 1;
+  layer_state = 0;
+#ifdef PREVENT_STUCK_MODIFIERS
+  memset(source_layers, 0, sizeof(source_layers));
+#endif
+  memset(&tapping, 0, sizeof(tapping));
+  tapping.key.row = 0xFF;
+}
+
+/*
+ * Host side
+ */
+
+// The interrupt endpoint holds one report. A report submitted while the
+// previous one has not been polled yet blocks the firmware until it has.
+void host_keyboard_send(report_keyboard_t *r) {
+  if (endpoint_busy_until > sim_now_us) {
+    sim_stats.blocked_us += endpoint_busy_until - sim_now_us;
+    sim_now_us = endpoint_busy_until;
+  }
+
+  uint32_t delivery = (sim_now_us / sim_config.poll_us + 1) * sim_config.poll_us;
+  endpoint_busy_until = delivery;
+  sim_stats.reports++;
+  sim_stats.last_delivery_us = delivery;
+
+  sim_log("report", "mods=%02x keys=%02x %02x %02x %02x %02x %02x host=%u.%03u",
+          r->mods, r->keys[0], r->keys[1], r->keys[2], r->keys[3], r->keys[4], r->keys[5],
+          delivery / 1000, delivery % 1000);
+  sim_host_receive(r, delivery);
+  if (sim_report_hook) {
+    sim_report_hook(delivery, r);
+  }
+}
+
+void host_consumer_send(uint16_t usage) {
+  sim_stats.consumer_reports++;
+  sim_log("consumer", "%04x", usage);
+}
+
+// The host toggles Caps Lock on each release of the key held for at least
+// SIM_CAPS_LOCK_DELAY_US, as macOS does. Shorter presses do nothing.
+void sim_host_receive(const report_keyboard_t *r, uint32_t time_us) {
+  bool caps = false;
+  bool was_caps = false;
+
+  for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+    if (r->keys[i] == KC_CAPSLOCK) caps = true;
+    if (sim_host_report.keys[i] == KC_CAPSLOCK) was_caps = true;
+  }
+  if (caps && !was_caps) {
+    caps_press_us = time_us;
+  }
+  if (!caps && was_caps && time_us - caps_press_us >= SIM_CAPS_LOCK_DELAY_US) {
+    host_leds ^= (1 << USB_LED_CAPS_LOCK);
+    sim_log("host", "leds=%02x", host_leds);
+  }
+  sim_host_report = *r;
+}
+
+uint8_t host_keyboard_leds(void) {
+  return host_leds;
+}
+
+/*
+ * action_util.c
+ */
+
+uint8_t get_mods(void) { return real_mods; }
+void add_mods(uint8_t mods) { real_mods |= mods; }
+void del_mods(uint8_t mods) { real_mods &= ~mods; }
+void set_mods(uint8_t mods) { real_mods = mods; }
+void clear_mods(void) { real_mods = 0; }
+
+uint8_t get_weak_mods(void) { return weak_mods; }
+void add_weak_mods(uint8_t mods) { weak_mods |= mods; }
+void del_weak_mods(uint8_t mods) { weak_mods &= ~mods; }
+void set_weak_mods(uint8_t mods) { weak_mods = mods; }
+void clear_weak_mods(void) { weak_mods = 0; }
+
+void add_key(uint8_t key) {
+  int8_t empty = -1;
+  for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+    if (report.keys[i] == key) return;
+    if (empty == -1 && report.keys[i] == 0) empty = i;
+  }
+  if (empty != -1) report.keys[empty] = key;
+}
+
+void del_key(uint8_t key) {
+  for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+    if (report.keys[i] == key) report.keys[i] = 0;
+  }
+}
+
+void clear_keys(void) {
+  memset(report.keys, 0, sizeof(report.keys));
+}
+
+void send_keyboard_report(void) {
+  report.mods = real_mods | weak_mods;
+  host_keyboard_send(&report);
+}
+
+/*
+ * action.c
+ */
+
+void register_code(uint8_t code) {
+  if (code == KC_NO) {
+    return;
+  } else if (code == KC_LOCKING_CAPS) {
+    // LOCKING_SUPPORT_ENABLE + LOCKING_RESYNC_ENABLE
+    if (host_keyboard_leds() & (1 << USB_LED_CAPS_LOCK)) return;
+    add_key(KC_CAPSLOCK);
+    send_keyboard_report();
+    wait_ms(100);
+    del_key(KC_CAPSLOCK);
+    send_keyboard_report();
+  } else if (IS_MOD(code)) {
+    add_mods(MOD_BIT(code));
+    send_keyboard_report();
+  } else if (IS_CONSUMER(code)) {
+    host_consumer_send(code);
+  } else {
+    add_key(code);
+    send_keyboard_report();
+  }
+}
+
+void unregister_code(uint8_t code) {
+  if (code == KC_NO) {
+    return;
+  } else if (code == KC_LOCKING_CAPS) {
+    if (!(host_keyboard_leds() & (1 << USB_LED_CAPS_LOCK))) return;
+    add_key(KC_CAPSLOCK);
+    send_keyboard_report();
+    wait_ms(100);
+    del_key(KC_CAPSLOCK);
+    send_keyboard_report();
+  } else if (IS_MOD(code)) {
+    del_mods(MOD_BIT(code));
+    send_keyboard_report();
+  } else if (IS_CONSUMER(code)) {
+    host_consumer_send(0);
+  } else {
+    del_key(code);
+    send_keyboard_report();
+  }
+}
+
+void clear_keyboard(void) {
+  clear_mods();
+  clear_weak_mods();
+  clear_keys();
+  send_keyboard_report();
+}
+
+// Five bit quantum modifier field to HID modifier bits
+static uint8_t mod_config_to_bits(uint8_t mods) {
+  return (mods & 0x10) ? (uint8_t)((mods & 0x0F) << 4) : (mods & 0x0F);
+}
+
+static void process_tap_toggle(uint8_t layer, keyrecord_t *record) {
+  keyevent_t event = record->event;
+  bool same_key = tapping.key.row == event.key.row && tapping.key.col == event.key.col;
+
+  if (event.pressed) {
+    if (same_key && !tapping.interrupted && tapping.count > 0 &&
+        (uint16_t)(event.time - tapping.release_time) < TAPPING_TERM) {
+      if (tapping.count < 15) tapping.count++;
+    } else {
+      tapping.count = 0;
+    }
+    tapping.key = event.key;
+    tapping.interrupted = false;
+    tapping.press_time = event.time;
+
+    if (tapping.count < TAPPING_TOGGLE) layer_invert(layer);
+  } else {
+    if (same_key && !tapping.interrupted && (uint16_t)(event.time - tapping.press_time) < TAPPING_TERM) {
+      if (tapping.count == 0) tapping.count = 1;
+    } else {
+      tapping.count = 0;
+    }
+    tapping.release_time = event.time;
+
+    if (tapping.count <= TAPPING_TOGGLE) layer_invert(layer);
+  }
+}
+
+static void process_action_keycode(uint16_t keycode, keyrecord_t *record) {
+  bool pressed = record->event.pressed;
+
+  if (keycode <= QK_TMK_MAX) {
+    if (pressed) {
+      register_code(keycode);
+    } else {
+      unregister_code(keycode);
+    }
+  } else if (keycode <= QK_MODS_MAX) {
+    uint8_t mods = mod_config_to_bits(keycode >> 8);
+    uint8_t code = keycode & 0xFF;
+
+    if (pressed) {
+      if (IS_MOD(code) || code == KC_NO) {
+        add_mods(mods);
+      } else {
+        add_weak_mods(mods);
+      }
+      send_keyboard_report();
+      register_code(code);
+    } else {
+      unregister_code(code);
+      if (IS_MOD(code) || code == KC_NO) {
+        del_mods(mods);
+      } else {
+        del_weak_mods(mods);
+      }
+      send_keyboard_report();
+    }
+  } else if (keycode >= QK_TO && keycode <= QK_TO_MAX) {
+    if (pressed) layer_move(keycode & 0xFF);
+  } else if (keycode >= QK_MOMENTARY && keycode <= QK_MOMENTARY_MAX) {
+    if (pressed) {
+      layer_on(keycode & 0xFF);
+    } else {
+      layer_off(keycode & 0xFF);
+    }
+  } else if (keycode >= QK_DEF_LAYER && keycode <= QK_DEF_LAYER_MAX) {
+    if (pressed) default_layer_state = 1UL << (keycode & 0xFF);
+  } else if (keycode >= QK_TOGGLE_LAYER && keycode <= QK_TOGGLE_LAYER_MAX) {
+    if (pressed) layer_invert(keycode & 0xFF);
+  } else if (keycode >= QK_LAYER_TAP_TOGGLE && keycode <= QK_LAYER_TAP_TOGGLE_MAX) {
+    process_tap_toggle(keycode & 0xFF, record);
+  }
+}
+
+void process_record(keyrecord_t *record) {
+  keypos_t key = record->event.key;
+  uint8_t layer;
+
+  if (record->event.pressed) {
+    layer = layer_switch_get_layer(key);
+#ifdef PREVENT_STUCK_MODIFIERS
+    update_source_layers_cache(key, layer);
+#endif
+
+    if (tapping.key.row != key.row || tapping.key.col != key.col) {
+      tapping.interrupted = true;
+    }
+  } else {
+#ifdef PREVENT_STUCK_MODIFIERS
+    layer = read_source_layers_cache(key);
+#else
+    layer = layer_switch_get_layer(key);
+#endif
+  }
+
+  uint16_t keycode = keymap_key_to_keycode(layer, key);
+  if (!process_record_user(keycode, record)) {
+    return;
+  }
+  process_action_keycode(keycode, record);
+}
+
+void process_action(keyrecord_t *record, action_t action) {
+  process_action_keycode(action.code, record);
+}
+
+action_t action_for_key(uint8_t layer, keypos_t key) {
+  return (action_t) { .code = keymap_key_to_keycode(layer, key) };
+}
+
+/*
+ * action_layer.c / keymap_common.c
+ */
+
+__attribute__ ((weak))
+uint32_t layer_state_set_user(uint32_t state) {
+  return state;
+}
+
+void layer_state_set(uint32_t state) {
+  state = layer_state_set_user(state);
+  if (state != layer_state) {
+    sim_stats.layer_changes++;
+    sim_log("layer", "%08x", state);
+  }
+  layer_state = state;
+}
+
+bool layer_state_is(uint8_t layer) {
+  return (layer_state & (1UL << layer)) != 0;
+}
+
+void layer_clear(void) { layer_state_set(0); }
+void layer_move(uint8_t layer) { layer_state_set(1UL << layer); }
+void layer_on(uint8_t layer) { layer_state_set(layer_state | (1UL << layer)); }
+void layer_off(uint8_t layer) { layer_state_set(layer_state & ~(1UL << layer)); }
+void layer_invert(uint8_t layer) { layer_state_set(layer_state ^ (1UL << layer)); }
+
+__attribute__ ((weak))
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
+  return pgm_read_word(&keymaps[layer][key.row][key.col]);
+}
+
+uint8_t layer_switch_get_layer(keypos_t key) {
+  uint32_t layers = layer_state | default_layer_state;
+
+  for (int8_t i = 31; i >= 0; i--) {
+    if (layers & (1UL << i)) {
+      if (keymap_key_to_keycode(i, key) != KC_TRNS) {
+        return i;
+      }
+    }
+  }
+  return 0;
+}
+
+#ifdef PREVENT_STUCK_MODIFIERS
+void update_source_layers_cache(keypos_t key, uint8_t layer) {
+  source_layers[key.row][key.col] = layer;
+}
+
+uint8_t read_source_layers_cache(keypos_t key) {
+  return source_layers[key.row][key.col];
+}
+#endif
+
+/*
+ * util.c / timer.c
+ */
+
+uint8_t biton32(uint32_t bits) {
+  uint8_t n = 0;
+  if (bits >> 16) { bits >>= 16; n += 16; }
+  if (bits >> 8) { bits >>= 8; n += 8; }
+  if (bits >> 4) { bits >>= 4; n += 4; }
+  if (bits >> 2) { bits >>= 2; n += 2; }
+  if (bits >> 1) { bits >>= 1; n += 1; }
+  return n;
+}
+
+uint32_t sim_eeprom_user;
+uint32_t sim_eeprom_writes;
+
+uint32_t eeconfig_read_user(void) { return sim_eeprom_user; }
+void eeconfig_update_user(uint32_t val) {
+  sim_eeprom_user = val;
+  sim_eeprom_writes++;
+}
+
+uint16_t timer_read(void) { return (uint16_t)(sim_now_us / 1000); }
+uint32_t timer_read32(void) { return sim_now_us / 1000; }
+uint16_t timer_elapsed(uint16_t last) { return (uint16_t)(timer_read() - last); }
+uint32_t timer_elapsed32(uint32_t last) { return timer_read32() - last; }
+
+// Busy wait: the clock moves on but nothing is scanned.
+void wait_ms(uint16_t ms) {
+  sim_now_us += (uint32_t)ms * 1000;
+}
+
+/*
+ * send_string
+ */
+
+// US ANSI: keycode and shift state for each printable ASCII character
+static const uint8_t ascii_to_keycode[128] = {
+  ['\b'] = KC_BSPACE, ['\t'] = KC_TAB, ['\n'] = KC_ENTER, [0x1B] = KC_ESCAPE,
+  [' '] = KC_SPACE, ['!'] = KC_1, ['"'] = KC_QUOTE, ['#'] = KC_3, ['$'] = KC_4,
+  ['%'] = KC_5, ['&'] = KC_7, ['\''] = KC_QUOTE, ['('] = KC_9, [')'] = KC_0,
+  ['*'] = KC_8, ['+'] = KC_EQUAL, [','] = KC_COMMA, ['-'] = KC_MINUS,
+  ['.'] = KC_DOT, ['/'] = KC_SLASH, ['0'] = KC_0, ['1'] = KC_1, ['2'] = KC_2,
+  ['3'] = KC_3, ['4'] = KC_4, ['5'] = KC_5, ['6'] = KC_6, ['7'] = KC_7,
+  ['8'] = KC_8, ['9'] = KC_9, [':'] = KC_SCOLON, [';'] = KC_SCOLON,
+  ['<'] = KC_COMMA, ['='] = KC_EQUAL, ['>'] = KC_DOT, ['?'] = KC_SLASH,
+  ['@'] = KC_2, ['['] = KC_LBRACKET, ['\\'] = KC_BSLASH, [']'] = KC_RBRACKET,
+  ['^'] = KC_6, ['_'] = KC_MINUS, ['`'] = KC_GRAVE, ['{'] = KC_LBRACKET,
+  ['|'] = KC_BSLASH, ['}'] = KC_RBRACKET, ['~'] = KC_GRAVE,
+};
+
+static bool ascii_shifted(char c) {
+  return (c >= 'A' && c <= 'Z') || strchr("!\"#$%&()*+:<>?@^_{|}~", c) != NULL;
+}
+
+void send_char(char ascii_code) {
+  uint8_t c = (uint8_t)ascii_code;
+  uint8_t keycode;
+
+  if (c >= 128) return;
+  if (c >= 'a' && c <= 'z') {
+    keycode = KC_A + (c - 'a');
+  } else if (c >= 'A' && c <= 'Z') {
+    keycode = KC_A + (c - 'A');
+  } else {
+    keycode = ascii_to_keycode[c];
+  }
+
+  if (ascii_shifted(ascii_code)) {
+    register_code(KC_LSFT);
+    register_code(keycode);
+    unregister_code(keycode);
+    unregister_code(KC_LSFT);
+  } else {
+    register_code(keycode);
+    unregister_code(keycode);
+  }
+}
+
+void send_string(const char *str) {
+  while (1) {
+    uint8_t ascii_code = pgm_read_byte(str);
+    if (!ascii_code) break;
+    if (ascii_code == SS_TAP_CODE) {
+      uint8_t keycode = pgm_read_byte(++str);
+      register_code(keycode);
+      unregister_code(keycode);
+    } else if (ascii_code == SS_DOWN_CODE) {
+      uint8_t keycode = pgm_read_byte(++str);
+      register_code(keycode);
+    } else if (ascii_code == SS_UP_CODE) {
+      uint8_t keycode = pgm_read_byte(++str);
+      unregister_code(keycode);
+    } else {
+      send_char(ascii_code);
+    }
+    ++str;
+  }
+}
+
+/*
+ * raw_hid.c
+ */
+
+uint8_t sim_raw_hid_reply[RAW_EPSIZE];
+
+void raw_hid_send(uint8_t *data, uint8_t length) {
+  memset(sim_raw_hid_reply, 0, sizeof(sim_raw_hid_reply));
+  memcpy(sim_raw_hid_reply, data, length < RAW_EPSIZE ? length : RAW_EPSIZE);
+}
@@ -0,0 +1,6 @@
+// Host-side stand-in for the QMK header of the same name.
+#pragma once
+
+#include "quantum.h"
+
+#define dprintf(...) do { } while (0)
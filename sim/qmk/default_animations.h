@@ -0,0 +1,7 @@
+// Host-side stand-in for quantum/visualizer/default_animations.h
+#pragma once
+
+#include "visualizer.h"
+
+extern keyframe_animation_t default_startup_animation;
+extern keyframe_animation_t default_suspend_animation;
@@ -0,0 +1,32 @@
+// Host-side stand-in for the parts of uGFX used by the visualizer. The
+// Infinity LCD is 128x32 pixels, one color_t per pixel (GDISP_PIXELFORMAT_MONO).
+#pragma once
+
+#include <stdint.h>
+
+typedef int16_t coord_t;
+typedef uint8_t color_t;
+typedef color_t pixel_t;
+typedef struct GDisplay GDisplay;
+typedef const struct mf_font_s* font_t;
+
+extern GDisplay* GDISP;
+
+#define Black 0
+#define White 1
+
+void gdispGClear(GDisplay* g, color_t color);
+void gdispGDrawPixel(GDisplay* g, coord_t x, coord_t y, color_t color);
+void gdispGFillArea(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
+void gdispGBlitArea(GDisplay* g, coord_t x, coord_t y, coord_t cx, coord_t cy,
+                    coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t* buffer);
+void gdispGDrawString(GDisplay* g, coord_t x, coord_t y, const char* str, font_t font, color_t color);
+font_t gdispOpenFont(const char* name);
+
+#define gdispClear(color)                       gdispGClear(GDISP, color)
+#define gdispDrawPixel(x, y, color)             gdispGDrawPixel(GDISP, x, y, color)
+#define gdispFillArea(x, y, cx, cy, color)      gdispGFillArea(GDISP, x, y, cx, cy, color)
+#define gdispBlitArea(x, y, cx, cy, buffer)     gdispGBlitArea(GDISP, x, y, cx, cy, 0, 0, cx, buffer)
+#define gdispDrawString(x, y, str, font, color) gdispGDrawString(GDISP, x, y, str, font, color)
+
+#define gfxMillisecondsToTicks(ms) (ms)
@@ -0,0 +1,6 @@
+// Host-side stand-in for quantum/visualizer/lcd_backlight.h
+#pragma once
+
+#include <stdint.h>
+
+void lcd_backlight_brightness(uint8_t b);
@@ -0,0 +1,7 @@
+// Host-side stand-in for quantum/visualizer/lcd_backlight_keyframes.h
+#pragma once
+
+#include "visualizer.h"
+
+bool keyframe_animate_backlight_color(keyframe_animation_t* animation, visualizer_state_t* state);
+bool keyframe_set_backlight_color(keyframe_animation_t* animation, visualizer_state_t* state);
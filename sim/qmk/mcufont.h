@@ -0,0 +1,35 @@
+// Host-side stand-in for the mcufont renderer behind uGFX text. The fonts
+// are the 5x7 font of sim/lcd.c, see gdispOpenFont() there.
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef char mf_char;
+typedef const char* mf_str;
+
+struct mf_font_s {
+  const char* short_name;
+  uint8_t height;
+  int16_t baseline_x;
+  int16_t baseline_y;
+  // Stand-in only: scale of the 5x7 glyphs and blank rows above them
+  uint8_t scale_x;
+  uint8_t scale_y;
+  uint8_t top;
+};
+
+enum mf_align_t {
+  MF_ALIGN_LEFT,
+  MF_ALIGN_CENTER,
+  MF_ALIGN_RIGHT
+};
+
+typedef void (*mf_pixel_callback_t)(int16_t x, int16_t y, uint8_t count, uint8_t alpha, void* state);
+typedef uint8_t (*mf_character_callback_t)(int16_t x0, int16_t y0, mf_char character, void* state);
+
+uint8_t mf_render_character(const struct mf_font_s* font, int16_t x0, int16_t y0, mf_char character,
+                            mf_pixel_callback_t callback, void* state);
+void mf_render_aligned(const struct mf_font_s* font, int16_t x0, int16_t y0, enum mf_align_t align,
+                       mf_str text, uint16_t count, mf_character_callback_t callback, void* state);
+int16_t mf_get_string_width(const struct mf_font_s* font, mf_str text, uint16_t count, bool kern);
@@ -0,0 +1,348 @@
+// Host-side stand-in for the parts of QMK that keymap.c and visualizer.c use.
+//
+// Keycode values, report layout and function signatures follow QMK so that the
+// keymap compiles unchanged. Behaviour is implemented in sim/qmk.c.
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// AVR/ARM flash access is a plain memory read on the host.
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+
+// HID keyboard/keypad usage page, plus the TMK internal codes used by keymaps.
+enum hid_keyboard_keypad_usage {
+  KC_NO = 0x00,
+  KC_ROLL_OVER,
+  KC_POST_FAIL,
+  KC_UNDEFINED,
+  KC_A, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K, KC_L, KC_M,
+  KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V, KC_W, KC_X, KC_Y, KC_Z,
+  KC_1, KC_2, KC_3, KC_4, KC_5, KC_6, KC_7, KC_8, KC_9, KC_0,
+  KC_ENTER, KC_ESCAPE, KC_BSPACE, KC_TAB, KC_SPACE, KC_MINUS, KC_EQUAL,
+  KC_LBRACKET, KC_RBRACKET, KC_BSLASH, KC_NONUS_HASH, KC_SCOLON, KC_QUOTE,
+  KC_GRAVE, KC_COMMA, KC_DOT, KC_SLASH, KC_CAPSLOCK,
+  KC_F1, KC_F2, KC_F3, KC_F4, KC_F5, KC_F6, KC_F7, KC_F8, KC_F9, KC_F10,
+  KC_F11, KC_F12,
+  KC_PSCREEN, KC_SCROLLLOCK, KC_PAUSE, KC_INSERT, KC_HOME, KC_PGUP, KC_DELETE,
+  KC_END, KC_PGDOWN, KC_RIGHT, KC_LEFT, KC_DOWN, KC_UP,
+  KC_NUMLOCK, KC_KP_SLASH, KC_KP_ASTERISK, KC_KP_MINUS, KC_KP_PLUS,
+  KC_KP_ENTER, KC_KP_1, KC_KP_2, KC_KP_3, KC_KP_4, KC_KP_5, KC_KP_6, KC_KP_7,
+  KC_KP_8, KC_KP_9, KC_KP_0, KC_KP_DOT,
+  KC_NONUS_BSLASH, KC_APPLICATION, KC_POWER, KC_KP_EQUAL,
+  KC_LOCKING_CAPS = 0x82,
+  KC_LOCKING_NUM,
+  KC_LOCKING_SCROLL,
+  KC_KP_COMMA,
+  KC_EXSEL = 0xA4,
+
+  // Consumer page keys, mapped into the TMK internal range.
+  KC_AUDIO_MUTE = 0xA8,
+  KC_AUDIO_VOL_UP,
+  KC_AUDIO_VOL_DOWN,
+  KC_MEDIA_NEXT_TRACK,
+  KC_MEDIA_PREV_TRACK,
+  KC_MEDIA_STOP,
+  KC_MEDIA_PLAY_PAUSE,
+  KC_MEDIA_SELECT,
+  KC_MEDIA_EJECT,
+  KC_MAIL,
+  KC_CALCULATOR,
+  KC_MY_COMPUTER,
+  KC_WWW_SEARCH,
+  KC_WWW_HOME,
+  KC_WWW_BACK,
+  KC_WWW_FORWARD,
+  KC_WWW_STOP,
+  KC_WWW_REFRESH,
+  KC_WWW_FAVORITES,
+  KC_MEDIA_FAST_FORWARD,
+  KC_MEDIA_REWIND,
+
+  KC_LCTRL = 0xE0,
+  KC_LSHIFT,
+  KC_LALT,
+  KC_LGUI,
+  KC_RCTRL,
+  KC_RSHIFT,
+  KC_RALT,
+  KC_RGUI,
+};
+
+#define KC_TRANSPARENT  0x01
+#define KC_TRNS         KC_TRANSPARENT
+#define KC_LCTL         KC_LCTRL
+#define KC_RCTL         KC_RCTRL
+#define KC_LSFT         KC_LSHIFT
+#define KC_RSFT         KC_RSHIFT
+#define KC_BSPC         KC_BSPACE
+#define KC_DEL          KC_DELETE
+#define KC_ESC          KC_ESCAPE
+#define KC_ENT          KC_ENTER
+#define KC_SPC          KC_SPACE
+#define KC_PGDN         KC_PGDOWN
+#define KC_CAPS         KC_CAPSLOCK
+
+#define IS_KEY(code)        (KC_A <= (code) && (code) <= KC_EXSEL)
+#define IS_MOD(code)        (KC_LCTRL <= (code) && (code) <= KC_RGUI)
+#define IS_CONSUMER(code)   (KC_AUDIO_MUTE <= (code) && (code) <= KC_MEDIA_REWIND)
+#define MOD_BIT(code)       (1 << ((code) & 0x07))
+
+// Quantum keycode ranges
+enum quantum_keycodes {
+  QK_TMK                = 0x0000,
+  QK_TMK_MAX            = 0x00FF,
+  QK_MODS               = 0x0100,
+  QK_LCTL               = 0x0100,
+  QK_LSFT               = 0x0200,
+  QK_LALT               = 0x0400,
+  QK_LGUI               = 0x0800,
+  QK_RMODS_MIN          = 0x1000,
+  QK_RCTL               = 0x1100,
+  QK_RSFT               = 0x1200,
+  QK_RALT               = 0x1400,
+  QK_RGUI               = 0x1800,
+  QK_MODS_MAX           = 0x1FFF,
+  QK_FUNCTION           = 0x2000,
+  QK_FUNCTION_MAX       = 0x2FFF,
+  QK_MACRO              = 0x3000,
+  QK_MACRO_MAX          = 0x3FFF,
+  QK_LAYER_TAP          = 0x4000,
+  QK_LAYER_TAP_MAX      = 0x4FFF,
+  QK_TO                 = 0x5000,
+  QK_TO_MAX             = 0x50FF,
+  QK_MOMENTARY          = 0x5100,
+  QK_MOMENTARY_MAX      = 0x51FF,
+  QK_DEF_LAYER          = 0x5200,
+  QK_DEF_LAYER_MAX      = 0x52FF,
+  QK_TOGGLE_LAYER       = 0x5300,
+  QK_TOGGLE_LAYER_MAX   = 0x53FF,
+  QK_LAYER_TAP_TOGGLE   = 0x5800,
+  QK_LAYER_TAP_TOGGLE_MAX = 0x58FF,
+  SAFE_RANGE            = 0x5D00,
+  QK_MOD_TAP            = 0x6000,
+  QK_MOD_TAP_MAX        = 0x7FFF,
+  QK_UNICODE            = 0x8000,
+  QK_UNICODE_MAX        = 0xFFFF,
+};
+
+#define LCTL(kc)    ((kc) | QK_LCTL)
+#define LSFT(kc)    ((kc) | QK_LSFT)
+#define LALT(kc)    ((kc) | QK_LALT)
+#define LGUI(kc)    ((kc) | QK_LGUI)
+#define RCTL(kc)    ((kc) | QK_RCTL)
+#define RSFT(kc)    ((kc) | QK_RSFT)
+#define RALT(kc)    ((kc) | QK_RALT)
+#define RGUI(kc)    ((kc) | QK_RGUI)
+
+#define KC_DOLLAR   LSFT(KC_4)
+
+#define TO(layer)   (QK_TO | ((layer) & 0xFF))
+#define MO(layer)   (QK_MOMENTARY | ((layer) & 0xFF))
+#define DF(layer)   (QK_DEF_LAYER | ((layer) & 0xFF))
+#define TG(layer)   (QK_TOGGLE_LAYER | ((layer) & 0xFF))
+#define TT(layer)   (QK_LAYER_TAP_TOGGLE | ((layer) & 0xFF))
+#define UC(c)       (QK_UNICODE | (c))
+
+#ifndef TAPPING_TERM
+#define TAPPING_TERM 200
+#endif
+#ifndef TAPPING_TOGGLE
+#define TAPPING_TOGGLE 5
+#endif
+
+// Host LED bits
+#define USB_LED_NUM_LOCK    0
+#define USB_LED_CAPS_LOCK   1
+#define USB_LED_SCROLL_LOCK 2
+
+// Key events
+typedef struct {
+  uint8_t col;
+  uint8_t row;
+} keypos_t;
+
+typedef struct {
+  keypos_t key;
+  bool     pressed;
+  uint16_t time;
+} keyevent_t;
+
+typedef struct {
+  bool    interrupted :1;
+  bool    reserved2   :1;
+  bool    reserved1   :1;
+  bool    reserved0   :1;
+  uint8_t count       :4;
+} tap_t;
+
+typedef struct {
+  keyevent_t event;
+  tap_t      tap;
+} keyrecord_t;
+
+// Keyboard report
+#define KEYBOARD_REPORT_KEYS 6
+
+typedef union {
+  uint8_t raw[2 + KEYBOARD_REPORT_KEYS];
+  struct {
+    uint8_t mods;
+    uint8_t reserved;
+    uint8_t keys[KEYBOARD_REPORT_KEYS];
+  };
+} __attribute__ ((packed)) report_keyboard_t;
+
+extern report_keyboard_t *keyboard_report;
+
+// action.h / action_util.h / keymap.h. Actions are modelled by the keycode
+// they come from.
+typedef union {
+  uint16_t code;
+} action_t;
+
+void process_record(keyrecord_t *record);
+void process_action(keyrecord_t *record, action_t action);
+action_t action_for_key(uint8_t layer, keypos_t key);
+void register_code(uint8_t code);
+void unregister_code(uint8_t code);
+void clear_keyboard(void);
+
+uint8_t get_mods(void);
+void add_mods(uint8_t mods);
+void del_mods(uint8_t mods);
+void set_mods(uint8_t mods);
+void clear_mods(void);
+uint8_t get_weak_mods(void);
+void add_weak_mods(uint8_t mods);
+void del_weak_mods(uint8_t mods);
+void set_weak_mods(uint8_t mods);
+void clear_weak_mods(void);
+void add_key(uint8_t key);
+void del_key(uint8_t key);
+void clear_keys(void);
+void send_keyboard_report(void);
+
+// host.h
+uint8_t host_keyboard_leds(void);
+void host_keyboard_send(report_keyboard_t *report);
+void host_consumer_send(uint16_t report);
+
+// action_layer.h
+extern uint32_t default_layer_state;
+extern uint32_t layer_state;
+void layer_state_set(uint32_t state);
+bool layer_state_is(uint8_t layer);
+void layer_clear(void);
+void layer_move(uint8_t layer);
+void layer_on(uint8_t layer);
+void layer_off(uint8_t layer);
+void layer_invert(uint8_t layer);
+uint8_t layer_switch_get_layer(keypos_t key);
+#ifdef PREVENT_STUCK_MODIFIERS
+void update_source_layers_cache(keypos_t key, uint8_t layer);
+uint8_t read_source_layers_cache(keypos_t key);
+#endif
+uint32_t layer_state_set_user(uint32_t state);
+
+// keymap.h
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key);
+
+// util.h
+uint8_t biton32(uint32_t bits);
+
+// eeconfig.h, the user word survives sim_power_cycle()
+uint32_t eeconfig_read_user(void);
+void eeconfig_update_user(uint32_t val);
+
+// timer.h
+uint16_t timer_read(void);
+uint32_t timer_read32(void);
+uint16_t timer_elapsed(uint16_t last);
+uint32_t timer_elapsed32(uint32_t last);
+void wait_ms(uint16_t ms);
+
+// send_string.h
+void send_string(const char *str);
+void send_char(char ascii_code);
+
+#define STRINGIZE(z) #z
+#define ADD_SLASH_X(y) STRINGIZE(\x ## y)
+#define SS_TAP_CODE 1
+#define SS_DOWN_CODE 2
+#define SS_UP_CODE 3
+#define SS_TAP(keycode) "\1" ADD_SLASH_X(keycode)
+#define SS_DOWN(keycode) "\2" ADD_SLASH_X(keycode)
+#define SS_UP(keycode) "\3" ADD_SLASH_X(keycode)
+#define SEND_STRING(str) send_string(PSTR(str))
+
+#define X_A 04
+#define X_B 05
+#define X_C 06
+#define X_D 07
+#define X_E 08
+#define X_F 09
+#define X_G 0a
+#define X_H 0b
+#define X_I 0c
+#define X_J 0d
+#define X_K 0e
+#define X_L 0f
+#define X_M 10
+#define X_N 11
+#define X_O 12
+#define X_P 13
+#define X_Q 14
+#define X_R 15
+#define X_S 16
+#define X_T 17
+#define X_U 18
+#define X_V 19
+#define X_W 1a
+#define X_X 1b
+#define X_Y 1c
+#define X_Z 1d
+#define X_1 1e
+#define X_2 1f
+#define X_3 20
+#define X_4 21
+#define X_5 22
+#define X_6 23
+#define X_7 24
+#define X_8 25
+#define X_9 26
+#define X_0 27
+#define X_ENTER 28
+#define X_ESCAPE 29
+#define X_BSPACE 2a
+#define X_TAB 2b
+#define X_SPACE 2c
+#define X_MINUS 2d
+#define X_EQUAL 2e
+#define X_LBRACKET 2f
+#define X_RBRACKET 30
+#define X_BSLASH 31
+#define X_SCOLON 33
+#define X_QUOTE 34
+#define X_GRAVE 35
+#define X_COMMA 36
+#define X_DOT 37
+#define X_SLASH 38
+#define X_LCTRL e0
+#define X_LSHIFT e1
+#define X_LALT e2
+#define X_LGUI e3
+#define X_RCTRL e4
+#define X_RSHIFT e5
+#define X_RALT e6
+#define X_RGUI e7
+
+// Hooks implemented by the keymap
+void matrix_init_user(void);
+void matrix_scan_user(void);
+bool process_record_user(uint16_t keycode, keyrecord_t *record);
@@ -0,0 +1,9 @@
+// Host-side stand-in for the QMK header of the same name.
+#pragma once
+
+#include "quantum.h"
+
+#define RAW_EPSIZE 32
+
+void raw_hid_receive(uint8_t *data, uint8_t length);
+void raw_hid_send(uint8_t *data, uint8_t length);
@@ -0,0 +1,4 @@
+// Host-side stand-in for the QMK header of the same name.
+#pragma once
+
+#include "quantum.h"
@@ -0,0 +1,59 @@
+// Host-side stand-in for quantum/visualizer/visualizer.h
+#pragma once
+
+#include "quantum.h"
+#include "gfx.h"
+
+#define LCD_COLOR(hue, saturation, intensity) (((uint32_t)(hue) << 16) | ((saturation) << 8) | (intensity))
+#define LCD_HUE(color) (((color) >> 16) & 0xFF)
+#define LCD_SAT(color) (((color) >> 8) & 0xFF)
+#define LCD_INT(color) ((color) & 0xFF)
+
+typedef struct {
+  uint32_t layer;
+  uint32_t default_layer;
+  uint8_t  mods;
+  uint32_t leds;
+  bool     suspended;
+#ifdef VISUALIZER_USER_DATA_SIZE
+  uint8_t  user_data[VISUALIZER_USER_DATA_SIZE];
+#endif
+} visualizer_keyboard_status_t;
+
+typedef struct visualizer_state_t {
+  visualizer_keyboard_status_t status;
+  uint32_t    current_lcd_color;
+  uint32_t    target_lcd_color;
+  const char* layer_text;
+  font_t      font_fixed5x8;
+  font_t      font_dejavusansbold12;
+} visualizer_state_t;
+
+#define MAX_VISUALIZER_KEY_FRAMES 16
+
+struct keyframe_animation_t;
+typedef bool (*frame_func)(struct keyframe_animation_t*, visualizer_state_t*);
+
+typedef struct keyframe_animation_t {
+  uint8_t num_frames;
+  bool loop;
+  int32_t frame_lengths[MAX_VISUALIZER_KEY_FRAMES];
+  frame_func frame_functions[MAX_VISUALIZER_KEY_FRAMES];
+} keyframe_animation_t;
+
+// The simulator runs every frame of an animation at once, when it is started.
+void start_keyframe_animation(keyframe_animation_t* animation);
+void stop_keyframe_animation(keyframe_animation_t* animation);
+
+#ifdef VISUALIZER_USER_DATA_SIZE
+// Copied into the status the visualizer compares for changes
+void visualizer_set_user_data(void* user_data);
+#endif
+
+void initialize_user_visualizer(visualizer_state_t* state);
+void update_user_visualizer_state(visualizer_state_t* state, visualizer_keyboard_status_t* prev_status);
+void user_visualizer_suspend(visualizer_state_t* state);
+void user_visualizer_resume(visualizer_state_t* state);
+
+// Recorded by the simulator instead of driving the LCD backlight
+void sim_lcd_color(uint32_t color);
@@ -0,0 +1,6 @@
+// Host-side stand-in for quantum/visualizer/visualizer_keyframes.h
+#pragma once
+
+#include "visualizer.h"
+
+bool keyframe_no_operation(keyframe_animation_t* animation, visualizer_state_t* state);
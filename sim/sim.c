@@ -0,0 +1,439 @@
+// Simulator core: virtual clock, scan loop, event log and trace replay.
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "lcd.h"
+#include "host.h"
+
+sim_config_t sim_config = {
+  .scan_us = 250,
+  .poll_us = 1000,
+  .log = NULL,
+  .visualizer = true,
+};
+
+sim_stats_t sim_stats;
+uint32_t sim_now_us;
+sim_report_hook_t sim_report_hook;
+
+static const uint8_t layout_index[MATRIX_ROWS][MATRIX_COLS];
+static visualizer_state_t visualizer_state;
+static uint8_t leds;
+static uint8_t logged_leds;
+
+void sim_log(const char* kind, const char* fmt, ...) {
+  if (!sim_config.log) return;
+
+  va_list args;
+  fprintf(sim_config.log, "%6u.%03u  %-9s ", sim_now_us / 1000, sim_now_us % 1000, kind);
+  va_start(args, fmt);
+  vfprintf(sim_config.log, fmt, args);
+  va_end(args);
+  fputc('\n', sim_config.log);
+}
+
+/*
+ * LEDs and LCD
+ */
+
+static void set_led(uint8_t led, bool on) {
+  sim_stats.led_calls++;
+  leds = on ? (leds | (1 << led)) : (leds & ~(1 << led));
+}
+
+// LEDs are logged by their state at the end of a scan or event, so that
+// turning one off and on again within the same pass is not reported.
+static void log_leds(void) {
+  static const char* const names[] = { "board", "right_1", "right_2", "right_3" };
+
+  for (uint8_t led = 0; led < 4; led++) {
+    if ((leds ^ logged_leds) & (1 << led)) {
+      sim_log("led", "%s %s", names[led], (leds & (1 << led)) ? "on" : "off");
+    }
+  }
+  logged_leds = leds;
+}
+
+void ergodox_board_led_on(void) { set_led(0, true); }
+void ergodox_right_led_1_on(void) { set_led(1, true); }
+void ergodox_right_led_2_on(void) { set_led(2, true); }
+void ergodox_right_led_3_on(void) { set_led(3, true); }
+void ergodox_board_led_off(void) { set_led(0, false); }
+void ergodox_right_led_1_off(void) { set_led(1, false); }
+void ergodox_right_led_2_off(void) { set_led(2, false); }
+void ergodox_right_led_3_off(void) { set_led(3, false); }
+
+void sim_lcd_color(uint32_t color) {
+  sim_stats.lcd_updates++;
+  sim_log("lcd", "color=%06x", color);
+}
+
+static uint8_t visualizer_user_data[VISUALIZER_USER_DATA_SIZE];
+
+void visualizer_set_user_data(void* user_data) {
+  memcpy(visualizer_user_data, user_data, VISUALIZER_USER_DATA_SIZE);
+}
+
+// Same trigger as visualizer_update(): run the user hook when the
+// keyboard status seen by the visualizer changes.
+static void visualizer_update(void) {
+  visualizer_keyboard_status_t status = {
+    .layer = layer_state,
+    .default_layer = default_layer_state,
+    .mods = get_mods(),
+    .leds = host_keyboard_leds(),
+    .suspended = false,
+  };
+
+  memcpy(status.user_data, visualizer_user_data, VISUALIZER_USER_DATA_SIZE);
+
+  if (memcmp(&status, &visualizer_state.status, sizeof(status)) != 0) {
+    visualizer_keyboard_status_t prev = visualizer_state.status;
+    visualizer_state.status = status;
+    update_user_visualizer_state(&visualizer_state, &prev);
+  }
+}
+
+/*
+ * Scan loop
+ */
+
+void sim_reset(void) {
+  sim_eeprom_user = 0;
+  sim_eeprom_writes = 0;
+  sim_power_cycle();
+}
+
+void sim_power_cycle(void) {
+  sim_now_us = 0;
+  memset(&sim_stats, 0, sizeof(sim_stats));
+  leds = 0;
+  logged_leds = 0;
+  sim_qmk_reset();
+  memset(&report_queue_stats, 0, sizeof(report_queue_stats));
+  memset(&tap_hold_stats, 0, sizeof(tap_hold_stats));
+  memset(&key_repeat_stats, 0, sizeof(key_repeat_stats));
+  latency_reset();
+  usage_reset();
+  snippet_reset();
+  recorder_reset();
+  layer_hold_reset();
+
+  memset(&visualizer_state, 0, sizeof(visualizer_state));
+  memset(visualizer_user_data, 0, sizeof(visualizer_user_data));
+  sim_visualizer_state = &visualizer_state;
+  // Without the visualizer the LCD is left as it is, rendering the labels
+  // would be most of the cost of a reset
+  if (sim_config.visualizer) {
+    // Opened by the QMK visualizer before it initializes the keymap's
+    visualizer_state.font_fixed5x8 = gdispOpenFont("fixed_5x8");
+    visualizer_state.font_dejavusansbold12 = gdispOpenFont("DejaVuSansBold12");
+    sim_lcd_reset();
+    initialize_user_visualizer(&visualizer_state);
+  }
+  matrix_init_user();
+  if (sim_config.visualizer) {
+    update_user_visualizer_state(&visualizer_state, &visualizer_state.status);
+  }
+}
+
+void sim_event(uint8_t row, uint8_t col, bool pressed) {
+  keyrecord_t record = {
+    .event = {
+      .key = { .col = col, .row = row },
+      .pressed = pressed,
+      .time = timer_read() | 1,
+    },
+  };
+
+  sim_stats.events++;
+  sim_log("key", "%s k%d (%u,%u)", pressed ? "down" : "up", layout_index[row][col] - 1, row, col);
+  process_record(&record);
+  log_leds();
+  if (sim_config.visualizer) visualizer_update();
+}
+
+void sim_scan(void) {
+  sim_stats.scans++;
+  matrix_scan_user();
+  log_leds();
+  if (sim_config.visualizer) visualizer_update();
+}
+
+void sim_run_until(uint32_t time_us) {
+  while (sim_now_us < time_us) {
+    uint32_t next = (sim_now_us / sim_config.scan_us + 1) * sim_config.scan_us;
+    sim_now_us = next < time_us ? next : time_us;
+    if (sim_now_us % sim_config.scan_us == 0) {
+      sim_scan();
+    }
+  }
+}
+
+/*
+ * Layout positions
+ */
+
+#define L(n) ((n) + 1)
+static const uint8_t layout_index[MATRIX_ROWS][MATRIX_COLS] = LAYOUT_ergodox(
+  L(0),  L(1),  L(2),  L(3),  L(4),  L(5),  L(6),
+  L(7),  L(8),  L(9),  L(10), L(11), L(12), L(13),
+  L(14), L(15), L(16), L(17), L(18), L(19),
+  L(20), L(21), L(22), L(23), L(24), L(25), L(26),
+  L(27), L(28), L(29), L(30), L(31),
+  L(32), L(33),
+  L(34),
+  L(35), L(36), L(37),
+
+  L(38), L(39), L(40), L(41), L(42), L(43), L(44),
+  L(45), L(46), L(47), L(48), L(49), L(50), L(51),
+  L(52), L(53), L(54), L(55), L(56), L(57),
+  L(58), L(59), L(60), L(61), L(62), L(63), L(64),
+  L(65), L(66), L(67), L(68), L(69),
+  L(70), L(71),
+  L(72),
+  L(73), L(74), L(75)
+);
+#undef L
+
+bool sim_layout_position(uint8_t index, keypos_t* pos) {
+  for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+      if (layout_index[row][col] == index + 1) {
+        pos->row = row;
+        pos->col = col;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/*
+ * Traces
+ *
+ * One event per line: "<time in ms> down|up <key>", where <key> is either
+ * "k<n>" (index in LAYOUT_ergodox() order) or "<row>,<col>". Everything after
+ * '#' is ignored.
+ */
+
+void sim_trace_add(sim_trace_t* trace, uint32_t time_us, keypos_t key, bool pressed) {
+  if (trace->count == trace->capacity) {
+    trace->capacity = trace->capacity ? trace->capacity * 2 : 64;
+    trace->events = realloc(trace->events, trace->capacity * sizeof(*trace->events));
+  }
+  trace->events[trace->count++] = (sim_trace_event_t) {
+    .time_us = time_us,
+    .key = key,
+    .pressed = pressed,
+  };
+}
+
+// The text of a quoted string with \n, \t, \" and \\ escapes
+static char* parse_quoted(const char* text) {
+  char* copy;
+  size_t length = 0;
+
+  text += strspn(text, " \t");
+  if (*text++ != '"') return NULL;
+  copy = malloc(strlen(text) + 1);
+  for (; *text && *text != '"'; text++) {
+    if (*text == '\\' && text[1]) {
+      text++;
+      copy[length++] = *text == 'n' ? '\n' : *text == 't' ? '\t' : *text;
+    } else {
+      copy[length++] = *text;
+    }
+  }
+  if (*text != '"') {
+    free(copy);
+    return NULL;
+  }
+  copy[length] = '\0';
+  return copy;
+}
+
+// "report <mods> [<keys>]" in hex, "caps on|off" or "text \"<text>\""
+static bool parse_expect(sim_trace_t* trace, uint32_t time_us, const char* text, unsigned line) {
+  sim_trace_expect_t expect = { .time_us = time_us, .line = line };
+  char word[16];
+  unsigned value;
+  int length;
+
+  if (sscanf(text, "%15s%n", word, &length) != 1) return false;
+  text += length;
+  if (strcmp(word, "report") == 0) {
+    expect.kind = EXPECT_REPORT;
+    if (sscanf(text, "%x%n", &value, &length) != 1) return false;
+    expect.mods = value;
+    text += length;
+    for (uint8_t i = 0; sscanf(text, "%x%n", &value, &length) == 1; i++) {
+      if (i == KEYBOARD_REPORT_KEYS) return false;
+      expect.keys[i] = value;
+      text += length;
+    }
+  } else if (strcmp(word, "caps") == 0) {
+    expect.kind = EXPECT_CAPS;
+    if (sscanf(text, "%15s", word) != 1 || (strcmp(word, "on") != 0 && strcmp(word, "off") != 0)) return false;
+    expect.on = strcmp(word, "on") == 0;
+  } else if (strcmp(word, "text") == 0) {
+    expect.kind = EXPECT_TEXT;
+    expect.text = parse_quoted(text);
+    if (!expect.text) return false;
+  } else {
+    return false;
+  }
+
+  trace->expects = realloc(trace->expects, (trace->expect_count + 1) * sizeof(*trace->expects));
+  trace->expects[trace->expect_count++] = expect;
+  return true;
+}
+
+bool sim_trace_load(sim_trace_t* trace, const char* path) {
+  FILE* file = fopen(path, "r");
+  char line[256];
+  unsigned line_number = 0;
+
+  if (!file) {
+    perror(path);
+    return false;
+  }
+
+  while (fgets(line, sizeof(line), file)) {
+    char action[16], key[16];
+    double time_ms;
+    keypos_t pos;
+    unsigned row, col, index;
+    int length = 0;
+    char* comment = strchr(line, '#');
+
+    line_number++;
+    if (comment) *comment = '\0';
+    if (strspn(line, " \t\r\n") == strlen(line)) continue;
+
+    if (sscanf(line, "%lf expect%n", &time_ms, &length) == 1 && length > 0) {
+      if (!parse_expect(trace, (uint32_t)(time_ms * 1000), line + length, line_number)) {
+        fprintf(stderr, "%s:%u: expected \"<ms> expect report <mods> [<keys>] | caps on|off | text \\\"<text>\\\"\"\n",
+                path, line_number);
+        fclose(file);
+        return false;
+      }
+      continue;
+    }
+    if (sscanf(line, "%lf %15s %15s", &time_ms, action, key) != 3 ||
+        (strcmp(action, "down") != 0 && strcmp(action, "up") != 0)) {
+      fprintf(stderr, "%s:%u: expected \"<ms> down|up <key>\"\n", path, line_number);
+      fclose(file);
+      return false;
+    }
+
+    if (sscanf(key, "k%u", &index) == 1 && index < 76) {
+      sim_layout_position(index, &pos);
+    } else if (sscanf(key, "%u,%u", &row, &col) == 2 && row < MATRIX_ROWS && col < MATRIX_COLS) {
+      pos.row = row;
+      pos.col = col;
+    } else {
+      fprintf(stderr, "%s:%u: unknown key \"%s\"\n", path, line_number, key);
+      fclose(file);
+      return false;
+    }
+
+    sim_trace_add(trace, (uint32_t)(time_ms * 1000), pos, action[0] == 'd');
+  }
+
+  fclose(file);
+  return true;
+}
+
+void sim_trace_free(sim_trace_t* trace) {
+  for (size_t i = 0; i < trace->expect_count; i++) {
+    free(trace->expects[i].text);
+  }
+  free(trace->events);
+  free(trace->expects);
+  memset(trace, 0, sizeof(*trace));
+}
+
+// Events are picked up by the first scan at or after their timestamp,
+// including those that came in while the firmware was blocked.
+uint32_t sim_event_at(uint32_t time_us, keypos_t key, bool pressed) {
+  uint32_t due = time_us < sim_now_us ? sim_now_us : time_us;
+
+  due = (due + sim_config.scan_us - 1) / sim_config.scan_us * sim_config.scan_us;
+  sim_run_until(due);
+  due = sim_now_us;
+  sim_event(key.row, key.col, pressed);
+  return due;
+}
+
+static bool report_has(const report_keyboard_t* report, uint8_t key) {
+  for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+    if (report->keys[i] == key) return true;
+  }
+  return false;
+}
+
+// Check an expectation against the host, logging the outcome
+static bool check_expect(const sim_trace_expect_t* expect) {
+  const report_keyboard_t* host = &sim_host_report;
+  bool caps = host_keyboard_leds() & (1 << USB_LED_CAPS_LOCK);
+  bool ok = true;
+
+  if (expect->kind == EXPECT_REPORT) {
+    ok = host->mods == expect->mods;
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+      if (host->keys[i] && memchr(expect->keys, host->keys[i], sizeof(expect->keys)) == NULL) ok = false;
+      if (expect->keys[i] && !report_has(host, expect->keys[i])) ok = false;
+    }
+    sim_log("expect", "line %u: report mods=%02x keys=%02x %02x %02x %02x %02x %02x: %s", expect->line,
+            host->mods, host->keys[0], host->keys[1], host->keys[2], host->keys[3], host->keys[4], host->keys[5],
+            ok ? "ok" : "FAIL");
+  } else if (expect->kind == EXPECT_CAPS) {
+    ok = caps == expect->on;
+    sim_log("expect", "line %u: caps %s: %s", expect->line, caps ? "on" : "off", ok ? "ok" : "FAIL");
+  } else {
+    char typed[256];
+    size_t length = 0;
+
+    ok = host_output.length == strlen(expect->text) && memcmp(host_output.text, expect->text, host_output.length) == 0;
+    for (size_t i = 0; i < host_output.length && length + 2 < sizeof(typed); i++) {
+      if (host_output.text[i] == '\n') typed[length++] = '\\';
+      typed[length++] = host_output.text[i] == '\n' ? 'n' : host_output.text[i];
+    }
+    typed[length] = '\0';
+    sim_log("expect", "line %u: text \"%s\": %s", expect->line, typed, ok ? "ok" : "FAIL");
+  }
+  return ok;
+}
+
+unsigned sim_trace_replay(const sim_trace_t* trace, uint32_t settle_us) {
+  uint32_t start = sim_now_us;
+  size_t next_expect = 0;
+  unsigned failed = 0;
+  sim_report_hook_t hook = sim_report_hook;
+
+  // Text expectations read what the macOS host model typed
+  for (size_t i = 0; i < trace->expect_count && !hook; i++) {
+    if (trace->expects[i].kind == EXPECT_TEXT) {
+      host_macos_reset();
+      sim_report_hook = host_macos_report;
+      break;
+    }
+  }
+
+  for (size_t i = 0; i <= trace->count; i++) {
+    uint32_t time_us = i < trace->count ? trace->events[i].time_us : UINT32_MAX;
+
+    while (next_expect < trace->expect_count && trace->expects[next_expect].time_us < time_us) {
+      sim_run_until(start + trace->expects[next_expect].time_us);
+      failed += !check_expect(&trace->expects[next_expect++]);
+    }
+    if (i < trace->count) {
+      sim_event_at(start + time_us, trace->events[i].key, trace->events[i].pressed);
+    }
+  }
+  sim_run_until(sim_now_us + settle_us);
+  sim_report_hook = hook;
+  return failed;
+}
@@ -0,0 +1,120 @@
+// Host-side simulator for the Neo 2 keymap.
+//
+// Runs keymap.c and visualizer.c against the QMK stand-ins in sim/qmk on a
+// virtual clock. Matrix events are fed in from timestamped traces, the scan
+// loop calls matrix_scan_user() and every HID report, layer change, LED and
+// LCD call is recorded.
+#pragma once
+
+#include <stdio.h>
+#include "ergodox_infinity.h"
+#include "report_stream.h"
+#include "tap_hold.h"
+#include "layer_hold.h"
+#include "key_repeat.h"
+#include "snippets.h"
+#include "recorder.h"
+#include "latency_stats.h"
+#include "usage_stats.h"
+
+// Timing model
+typedef struct {
+  uint32_t scan_us;         // matrix scan period
+  uint32_t poll_us;         // USB interrupt endpoint poll interval
+  FILE*    log;             // event log, NULL to disable
+  bool     visualizer;      // run the visualizer after each scan and event
+} sim_config_t;
+
+// Counters collected since the last sim_reset()
+typedef struct {
+  uint32_t scans;
+  uint32_t events;
+  uint32_t reports;
+  uint32_t consumer_reports;
+  uint32_t layer_changes;
+  uint32_t led_calls;
+  uint32_t lcd_updates;
+  uint32_t blocked_us;      // time the firmware spent waiting on the USB endpoint
+  uint32_t last_delivery_us;
+} sim_stats_t;
+
+extern sim_config_t sim_config;
+extern sim_stats_t sim_stats;
+
+// Virtual clock in microseconds
+extern uint32_t sim_now_us;
+
+// Called with every keyboard report when the host receives it
+typedef void (*sim_report_hook_t)(uint32_t time_us, const report_keyboard_t* report);
+extern sim_report_hook_t sim_report_hook;
+
+// Start over from a blank board. sim_power_cycle() keeps the EEPROM.
+void sim_reset(void);
+void sim_power_cycle(void);
+extern uint32_t sim_eeprom_user;
+extern uint32_t sim_eeprom_writes;
+void sim_log(const char* kind, const char* fmt, ...) __attribute__ ((format (printf, 2, 3)));
+
+// Feed one matrix event at the current time.
+void sim_event(uint8_t row, uint8_t col, bool pressed);
+// Run one matrix scan.
+void sim_scan(void);
+// Feed one matrix event with the first scan at or after time_us. Returns
+// the time the event was picked up.
+uint32_t sim_event_at(uint32_t time_us, keypos_t key, bool pressed);
+// Run scans until the virtual clock reaches time_us.
+void sim_run_until(uint32_t time_us);
+
+// Matrix position of the key at index in LAYOUT_ergodox() argument order.
+bool sim_layout_position(uint8_t index, keypos_t* pos);
+
+// Timestamped press/release traces
+typedef struct {
+  uint32_t time_us;
+  keypos_t key;
+  bool     pressed;
+} sim_trace_event_t;
+
+// What the host has at a point of a trace, checked by the replay
+enum sim_expect_kinds {
+  EXPECT_REPORT,            // the last report, modifiers and the set of keys
+  EXPECT_CAPS,              // Caps Lock on or off
+  EXPECT_TEXT,              // what the macOS host model typed since the start
+};
+
+typedef struct {
+  uint32_t time_us;
+  uint8_t  kind;
+  uint8_t  mods;            // EXPECT_REPORT
+  uint8_t  keys[KEYBOARD_REPORT_KEYS];
+  bool     on;              // EXPECT_CAPS
+  char*    text;            // EXPECT_TEXT, UTF-8
+  unsigned line;
+} sim_trace_expect_t;
+
+typedef struct {
+  sim_trace_event_t* events;
+  size_t count;
+  size_t capacity;
+  sim_trace_expect_t* expects;
+  size_t expect_count;
+} sim_trace_t;
+
+bool sim_trace_load(sim_trace_t* trace, const char* path);
+void sim_trace_add(sim_trace_t* trace, uint32_t time_us, keypos_t key, bool pressed);
+void sim_trace_free(sim_trace_t* trace);
+// Replay a trace from the current clock and let it settle for settle_us.
+// Returns the number of expectations that failed.
+unsigned sim_trace_replay(const sim_trace_t* trace, uint32_t settle_us);
+
+// macOS takes a Caps Lock press only once the key was held this long, the
+// sim host and the macOS model toggle Caps Lock on the release of such a press
+#define SIM_CAPS_LOCK_DELAY_US    (80 * 1000)
+
+// Hooks into sim/qmk.c
+void sim_qmk_reset(void);
+void sim_host_receive(const report_keyboard_t* report, uint32_t time_us);
+// Last keyboard report the host received
+extern report_keyboard_t sim_host_report;
+// Last reply the firmware sent over raw HID
+extern uint8_t sim_raw_hid_reply[32];
@@ -0,0 +1,102 @@
+// Typist: learns chords by trying every key under every combination of the
+// Shift, MOD3 and MOD4 keys from a clean state and keeping the combinations
+// that make the host produce exactly one character. Fewer keys win.
+#include <stdlib.h>
+#include "typist.h"
+#include "host.h"
+
+typist_timing_t typist_timing = {
+  .key_gap_us = 20 * 1000,
+  .tap_us = 30 * 1000,
+};
+
+// LSHIFT, NEO2_LMOD3 and NEO2_LMOD4 on the left hand
+static const uint8_t modifier_keys[] = { 20, 14, 37 };
+#define MODIFIER_COUNT (sizeof(modifier_keys) / sizeof(modifier_keys[0]))
+#define LAYOUT_KEYS 76
+
+static typist_chord_t* chords;
+static size_t chord_count;
+
+static bool is_modifier(uint8_t key) {
+  for (size_t i = 0; i < MODIFIER_COUNT; i++) {
+    if (modifier_keys[i] == key) return true;
+  }
+  return false;
+}
+
+uint32_t typist_type(const typist_chord_t* chord, uint32_t start_us, uint32_t* trigger_us) {
+  uint32_t time = start_us;
+  keypos_t pos;
+
+  for (uint8_t i = 0; i < chord->count; i++) {
+    if (time < sim_now_us) time = sim_now_us;
+    sim_layout_position(chord->keys[i], &pos);
+    uint32_t picked_up = sim_event_at(time, pos, true);
+    if (i + 1 == chord->count && trigger_us) *trigger_us = picked_up;
+    time += (i + 1 == chord->count) ? typist_timing.tap_us : typist_timing.key_gap_us;
+  }
+  for (int8_t i = chord->count - 1; i >= 0; i--) {
+    if (time < sim_now_us) time = sim_now_us;
+    sim_layout_position(chord->keys[i], &pos);
+    sim_event_at(time, pos, false);
+    time += typist_timing.key_gap_us;
+  }
+  return time;
+}
+
+void typist_learn(sim_report_hook_t host, typist_host_reset_t host_reset) {
+  FILE* log = sim_config.log;
+  sim_report_hook_t hook = sim_report_hook;
+
+  sim_config.log = NULL;
+  sim_report_hook = host;
+  chord_count = 0;
+
+  // Subsets of the modifier keys, smallest first
+  for (uint8_t size = 0; size <= MODIFIER_COUNT; size++) {
+    for (uint8_t mask = 0; mask < (1 << MODIFIER_COUNT); mask++) {
+      if (__builtin_popcount(mask) != size) continue;
+
+      for (uint8_t key = 0; key < LAYOUT_KEYS; key++) {
+        typist_chord_t chord = { .count = 0 };
+
+        if (is_modifier(key)) continue;
+        for (uint8_t i = 0; i < MODIFIER_COUNT; i++) {
+          if (mask & (1 << i)) chord.keys[chord.count++] = modifier_keys[i];
+        }
+        chord.keys[chord.count++] = key;
+
+        sim_reset();
+        host_reset();
+        sim_run_until(typist_type(&chord, 0, NULL) + 300 * 1000);
+
+        if (host_output.glyphs != 1) continue;
+        const char* text = host_output.text;
+        chord.codepoint = utf8_next(&text);
+        if (typist_find(chord.codepoint)) continue;
+
+        chords = realloc(chords, (chord_count + 1) * sizeof(*chords));
+        chords[chord_count++] = chord;
+      }
+    }
+  }
+
+  sim_config.log = log;
+  sim_report_hook = hook;
+}
+
+size_t typist_chord_count(void) {
+  return chord_count;
+}
+
+const typist_chord_t* typist_chord(size_t index) {
+  return index < chord_count ? &chords[index] : NULL;
+}
+
+const typist_chord_t* typist_find(uint32_t codepoint) {
+  for (size_t i = 0; i < chord_count; i++) {
+    if (chords[i].codepoint == codepoint) return &chords[i];
+  }
+  return NULL;
+}
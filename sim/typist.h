@@ -0,0 +1,33 @@
+// Typist: learns from the keymap which keys type each character and plays
+// them back into the simulator.
+#pragma once
+
+#include "sim.h"
+
+#define TYPIST_MAX_KEYS 4
+
+// Keys are held in order and released in reverse; the last one is tapped.
+typedef struct {
+  uint32_t codepoint;
+  uint8_t  count;
+  uint8_t  keys[TYPIST_MAX_KEYS];   // LAYOUT_ergodox() indices
+} typist_chord_t;
+
+typedef struct {
+  uint32_t key_gap_us;      // between consecutive events of one chord
+  uint32_t tap_us;          // how long the last key is held
+} typist_timing_t;
+
+extern typist_timing_t typist_timing;
+
+// Explore every modifier/layer combination on a host model that turns
+// reports into text. Call before typing; it resets the simulator.
+typedef void (*typist_host_reset_t)(void);
+void typist_learn(sim_report_hook_t host, typist_host_reset_t host_reset);
+size_t typist_chord_count(void);
+const typist_chord_t* typist_chord(size_t index);
+const typist_chord_t* typist_find(uint32_t codepoint);
+
+// Type one chord starting at start_us. Returns the time the tapped key went
+// down in *trigger_us (if not NULL) and the time the chord is finished.
+uint32_t typist_type(const typist_chord_t* chord, uint32_t start_us, uint32_t* trigger_us);
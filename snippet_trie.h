@@ -0,0 +1,85 @@
+// Trie of the snippet triggers in keymap.c, see snippets.h.
+// Generated by `make -C sim snippets` from snippets[].
+#pragma once
+
+#define SNIPPET_CELLS 65
+
+// Symbol of each character that is in a trigger, 0 for the others
+static const uint8_t PROGMEM snippet_symbols[128] = {
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  3,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+   0,  6,  7, 12,  4,  2,  8,  1, 16, 13,  0,  0, 19,  5, 14,  9,
+   0, 17, 10, 15, 18, 11, 20, 21,  0,  0, 22,  0,  0,  0,  0,  0,
+};
+
+static const snippet_cell_t PROGMEM snippet_trie[SNIPPET_CELLS] = {
+  {   1, 0xffff,  0 },  //   0: root
+  {   0, 0xffff,  0 },  //   1: free
+  {   0, 0x0015,  2 },  //   2: "vg", snippet 1
+  {  15, 0x0000,  0 },  //   3: "e"
+  {  19, 0x0000,  0 },  //   4: ";"
+  {   8, 0x0000,  0 },  //   5: "d"
+  {   7, 0x0000,  0 },  //   6: "m"
+  {   3, 0x0000,  0 },  //   7: "a"
+  {  15, 0x0000,  0 },  //   8: "b"
+  {   2, 0x0000,  0 },  //   9: "f"
+  {  44, 0x0005,  0 },  //  10: "de"
+  {  38, 0x0009,  0 },  //  11: "fo"
+  {  43, 0x0009,  0 },  //  12: "fr"
+  {  39, 0x0006,  0 },  //  13: "ma"
+  {  19, 0x0000,  0 },  //  14: "i"
+  {  52, 0x0006,  0 },  //  15: "mf"
+  {  27, 0x0000,  0 },  //  16: "s"
+  {  43, 0x0008, 22 },  //  17: "be", snippet 21
+  {  16, 0x0000,  0 },  //  18: "q"
+  {  25, 0x0000,  0 },  //  19: "t"
+  {  38, 0x0004,  0 },  //  20: ";g"
+  {   1, 0x0000,  0 },  //  21: "v"
+  {   0, 0x0007, 21 },  //  22: "al", snippet 20
+  {  20, 0x0004,  0 },  //  23: ";d"
+  {  32, 0x0004,  0 },  //  24: ";m"
+  {   0, 0x0008,  3 },  //  25: "br", snippet 2
+  {  37, 0x0003,  0 },  //  26: "eu"
+  {  45, 0x0012,  0 },  //  27: "qu"
+  {  51, 0x0010,  0 },  //  28: "sg"
+  {  42, 0x0003,  0 },  //  29: "en"
+  {  27, 0x0004,  0 },  //  30: ";u"
+  {  29, 0x0004,  0 },  //  31: ";c"
+  {   0, 0x0003, 19 },  //  32: "eq", snippet 18
+  {  38, 0x000e,  0 },  //  33: "in"
+  {  53, 0x0013,  0 },  //  34: "to"
+  {   0, 0x001f,  8 },  //  35: ";ca", snippet 7
+  {   0, 0x0017,  6 },  //  36: ";dh", snippet 5
+  {  49, 0x000e,  0 },  //  37: "it"
+  {  51, 0x0010,  0 },  //  38: "su"
+  {   0, 0x0014,  9 },  //  39: ";gg", snippet 8
+  {  57, 0x0018,  0 },  //  40: ";mf"
+  {  36, 0x0004,  0 },  //  41: ";z"
+  {  38, 0x001e,  0 },  //  42: ";us"
+  {   0, 0x0029,  5 },  //  43: ";zb", snippet 4
+  {   0, 0x0011, 15 },  //  44: "beg", snippet 14
+  {   0, 0x000a, 24 },  //  45: "deg", snippet 23
+  {   0, 0x001d, 16 },  //  46: "end", snippet 15
+  {   0, 0x001a, 23 },  //  47: "eur", snippet 22
+  {   0, 0x000b, 13 },  //  48: "for", snippet 12
+  {  48, 0x000c,  0 },  //  49: "fra"
+  {   0, 0x0021, 11 },  //  50: "inc", snippet 10
+  {  56, 0x0025,  0 },  //  51: "ite"
+  {  48, 0x000d,  0 },  //  52: "mai"
+  {   0, 0x000f,  1 },  //  53: "mfg", snippet 0
+  {   0, 0x001b, 25 },  //  54: "quo", snippet 24
+  {  47, 0x001c,  0 },  //  55: "sgd"
+  {   0, 0x0026, 18 },  //  56: "sum", snippet 17
+  {  55, 0x0022,  0 },  //  57: "tod"
+  {   0, 0x0028, 10 },  //  58: ";mfg", snippet 9
+  {   0, 0x002a,  7 },  //  59: ";usw", snippet 6
+  {   0, 0x0031, 17 },  //  60: "frac", snippet 16
+  {   0, 0x0033, 20 },  //  61: "item", snippet 19
+  {   0, 0x0034, 12 },  //  62: "main", snippet 11
+  {   0, 0x0037,  4 },  //  63: "sgdh", snippet 3
+  {   0, 0x0039, 14 },  //  64: "todo", snippet 13
+};
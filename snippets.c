@@ -0,0 +1,308 @@
+#include <string.h>
+#include "snippets.h"
+#include "snippet_trie.h"
+#include "report_stream.h"
+#include "compose.h"
+#include "debug.h"
+
+// Modifiers held on the keyboard are kept out of the Backspaces and the
+// text, so they type as they would without them
+#define SNIPPET_HIDDEN_MODIFIERS (GLYPH_HIDDEN_MODIFIERS | \
+  MOD_BIT(KC_LCTRL) | MOD_BIT(KC_RCTRL) | MOD_BIT(KC_LALT) | MOD_BIT(KC_RALT) | MOD_BIT(KC_LGUI) | MOD_BIT(KC_RGUI))
+
+// Flash is memory-mapped where the platform has no pgm_read_ptr
+#ifndef pgm_read_ptr
+#define pgm_read_ptr(address) (*(const void * const *)(address))
+#endif
+
+snippet_stats_t snippet_stats;
+
+// Base and Shift level of the U.S. layout from KC_A to KC_SLASH, 0 where a
+// key types no character
+static const char PROGMEM us_chars[2][KC_SLASH - KC_A + 1] = {
+  {
+    'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm',
+    'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
+    '1', '2', '3', '4', '5', '6', '7', '8', '9', '0',
+    '\n', 0, '\b', '\t', ' ', '-', '=', '[', ']', '\\', 0, ';', '\'', '`', ',', '.', '/',
+  },
+  {
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
+    'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+    '!', '@', '#', '$', '%', '^', '&', '*', '(', ')',
+    '\n', 0, '\b', '\t', ' ', '_', '+', '{', '}', '|', 0, ':', '"', '~', '<', '>', '?',
+  },
+};
+
+// The match: states from the root to the characters typed so far
+static uint16_t path[SNIPPET_DEPTH + 1];
+static uint8_t depth;
+// Characters typed since the match was lost, until the word ends
+static uint8_t unmatched;
+
+static bool leader;
+static uint16_t leader_timer;
+// Keys whose press the leader sequence consumed, so is their release
+static keypos_t consumed[SNIPPET_DEPTH];
+static uint8_t consumed_count;
+
+// The text being typed, NULL once it is done
+static const char *text;
+// Backspaces still to type before it
+static uint8_t erase;
+
+// Events that came in while it is typed, in order
+static keyrecord_t buffer[SNIPPET_BUFFER_SIZE];
+static uint8_t buffer_length;
+
+uint16_t snippet_next(uint16_t state, uint8_t character) {
+  uint8_t symbol = character < sizeof(snippet_symbols) ? pgm_read_byte(&snippet_symbols[character]) : 0;
+  uint16_t next;
+
+  if (!symbol || state >= SNIPPET_CELLS) {
+    return SNIPPET_NO_STATE;
+  }
+  next = pgm_read_word(&snippet_trie[state].base) + symbol;
+  if (next >= SNIPPET_CELLS || pgm_read_word(&snippet_trie[next].check) != state) {
+    return SNIPPET_NO_STATE;
+  }
+  return next;
+}
+
+uint8_t snippet_keycode_char(uint16_t keycode, bool shifted) {
+  if ((keycode & 0xFF00) == QK_LSFT || (keycode & 0xFF00) == QK_RSFT) {
+    shifted = true;
+    keycode &= 0xFF;
+  }
+  if (keycode < KC_A || keycode > KC_SLASH) {
+    return SNIPPET_NO_CHAR;
+  }
+  return pgm_read_byte(&us_chars[shifted ? 1 : 0][keycode - KC_A]);
+}
+
+// Decode the next UTF-8 character of the text and advance it
+static uint16_t text_next(void) {
+  uint8_t byte = pgm_read_byte(text++);
+  uint16_t codepoint;
+  uint8_t more;
+
+  if (byte < 0x80) return byte;
+  if ((byte & 0xE0) == 0xC0) {
+    codepoint = byte & 0x1F;
+    more = 1;
+  } else {
+    codepoint = byte & 0x0F;
+    more = 2;
+  }
+  while (more--) {
+    codepoint = (codepoint << 6) | (pgm_read_byte(text++) & 0x3F);
+  }
+  return codepoint;
+}
+
+// Queue one character the way the keymap types it: a glyph if there is
+// one, so dead keys and digits come out right, or else a U.S. key
+static void type_char(uint16_t codepoint) {
+  report_stream_t stream = { .length = 0 };
+
+  for (uint8_t glyph = 0; glyph < glyph_count && !stream.length; glyph++) {
+    for (uint8_t upper = 0; upper < 2; upper++) {
+      if (pgm_read_word(&glyph_codepoints[glyph][upper]) == codepoint) {
+        glyph_stream(glyph, upper, &stream);
+        break;
+      }
+    }
+  }
+  for (uint8_t i = 0; i < 2 * (KC_SLASH - KC_A + 1) && !stream.length && codepoint < 0x80; i++) {
+    if (pgm_read_byte(&us_chars[0][0] + i) != codepoint) continue;
+    stream.reports[0][0] = i > KC_SLASH - KC_A ? MOD_BIT(KC_LSHIFT) : 0;
+    stream.reports[0][1] = KC_A + i % (KC_SLASH - KC_A + 1);
+    stream.reports[1][0] = 0;
+    stream.reports[1][1] = KC_NO;
+    stream.length = 2;
+  }
+  if (!stream.length) {
+    dprintf("snippet: no key for U+%04X\n", codepoint);
+    return;
+  }
+  send_report_stream_ram(&stream, SNIPPET_HIDDEN_MODIFIERS);
+}
+
+static void match_reset(void) {
+  depth = 0;
+  unmatched = 0;
+  leader = false;
+}
+
+static void expand(uint8_t snippet, uint8_t typed) {
+  text = (const char *)pgm_read_ptr(&snippets[snippet].text);
+  erase = typed;
+  snippet_stats.expansions++;
+  match_reset();
+}
+
+void snippet_leader(void) {
+  match_reset();
+  leader = true;
+  leader_timer = timer_read();
+}
+
+static bool is_word_end(uint8_t character) {
+  return character == ' ' || character == '\t' || character == '\n';
+}
+
+static void hold_back(keyrecord_t *record) {
+  buffer[buffer_length++] = *record;
+  snippet_stats.held_back++;
+}
+
+// Returns true for the release of a key whose press was consumed
+static bool release_consumed(keypos_t key) {
+  for (uint8_t i = 0; i < consumed_count; i++) {
+    if (consumed[i].row == key.row && consumed[i].col == key.col) {
+      consumed[i] = consumed[--consumed_count];
+      return true;
+    }
+  }
+  return false;
+}
+
+// Type the rest of the text and process the events held back right now,
+// blocking on the endpoint, so that none of them is processed out of order
+static void finish_text(void) {
+  while (text) {
+    report_queue_flush();
+    snippet_task();
+  }
+}
+
+static bool process_leader(uint8_t character, keyrecord_t *record) {
+  uint16_t state = path[depth];
+  uint8_t snippet;
+
+  if (character == SNIPPET_NO_CHAR) {
+    // A shortcut gives up and goes through
+    match_reset();
+    return true;
+  }
+  if (consumed_count < SNIPPET_DEPTH) {
+    consumed[consumed_count++] = record->event.key;
+  }
+  leader_timer = timer_read();
+
+  if (character == '\b') {
+    if (depth > 0) depth--;
+    else match_reset();
+    return false;
+  }
+  snippet = pgm_read_byte(&snippet_trie[state].snippet);
+  if (is_word_end(character)) {
+    // Ends a trigger that is the start of a longer one, or gives up
+    if (snippet) expand(snippet - 1, 0);
+    else match_reset();
+    return false;
+  }
+
+  state = depth < SNIPPET_DEPTH ? snippet_next(state, character) : SNIPPET_NO_STATE;
+  if (state == SNIPPET_NO_STATE) {
+    match_reset();
+    return false;
+  }
+  path[++depth] = state;
+  snippet = pgm_read_byte(&snippet_trie[state].snippet);
+  if (snippet && pgm_read_word(&snippet_trie[state].base) == 0) {
+    expand(snippet - 1, 0);
+  }
+  return false;
+}
+
+bool process_snippets(uint8_t character, keyrecord_t *record) {
+  if (text) {
+    hold_back(record);
+    if (buffer_length == SNIPPET_BUFFER_SIZE) {
+      snippet_stats.overflows++;
+      dprintf("snippet buffer full\n");
+      finish_text();
+    }
+    return false;
+  }
+  if (!record->event.pressed) {
+    return !release_consumed(record->event.key);
+  }
+  if (character == SNIPPET_MODIFIER) {
+    return true;
+  }
+  if (leader) {
+    return process_leader(character, record);
+  }
+
+  if (character == SNIPPET_NO_CHAR) {
+    depth = 0;
+    unmatched = 0;
+  } else if (character == '\b') {
+    if (unmatched > 0) unmatched--;
+    else if (depth > 0) depth--;
+  } else if (is_word_end(character)) {
+    uint8_t snippet = pgm_read_byte(&snippet_trie[path[depth]].snippet);
+
+    if (!unmatched && snippet &&
+        (pgm_read_byte(&snippets[snippet - 1].flags) & SNIPPET_TYPED)) {
+      // The key that ended the trigger is typed after the text
+      expand(snippet - 1, depth);
+      hold_back(record);
+      return false;
+    }
+    depth = 0;
+    unmatched = 0;
+  } else if (unmatched || depth == SNIPPET_DEPTH) {
+    if (unmatched < 0xFF) unmatched++;
+  } else {
+    uint16_t state = snippet_next(path[depth], character);
+
+    if (state == SNIPPET_NO_STATE) unmatched = 1;
+    else path[++depth] = state;
+  }
+  return true;
+}
+
+void snippet_task(void) {
+  if (leader && timer_elapsed(leader_timer) > SNIPPET_LEADER_TIMEOUT) {
+    match_reset();
+  }
+  if (!text || report_queue_busy()) {
+    return;
+  }
+
+  if (erase > 0) {
+    report_stream_t backspace = REPORT_STREAM(RS_TAP(KC_BSPACE));
+
+    erase--;
+    send_report_stream_ram(&backspace, SNIPPET_HIDDEN_MODIFIERS);
+    return;
+  }
+  uint16_t codepoint = text_next();
+  if (codepoint) {
+    type_char(codepoint);
+    return;
+  }
+
+  // Done, process what came in meanwhile. One of the events may start
+  // another text, the rest waits for that one.
+  text = NULL;
+  while (buffer_length > 0 && !text) {
+    keyrecord_t record = buffer[0];
+
+    buffer_length--;
+    memmove(&buffer[0], &buffer[1], buffer_length * sizeof(keyrecord_t));
+    process_record(&record);
+  }
+}
+
+void snippet_reset(void) {
+  match_reset();
+  consumed_count = 0;
+  text = NULL;
+  erase = 0;
+  buffer_length = 0;
+  memset(&snippet_stats, 0, sizeof(snippet_stats));
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "quantum.h"
+
+// Text expansion: short triggers that type longer texts.
+//
+// The keymap lists its snippets in snippets[], a trigger of printable ASCII
+// and the text, in UTF-8. `make -C sim snippets` compiles the triggers into
+// a trie in snippet_trie.h, stored as a double array: the child of a state
+// for a character is the cell at the state's base plus the character's
+// symbol, if that cell names the state as its parent. Every key press
+// advances the match by one cell read, however many snippets there are.
+//
+// A snippet is expanded after the leader key and its trigger, or, with
+// SNIPPET_TYPED, when its trigger is typed as a word of its own and the
+// word is ended by Space, Tab or Enter. The typed trigger is erased first.
+// Each character of the text is typed like the keymap types it: ASCII as a
+// U.S. key, everything else as a glyph (compose.h) for the host profile.
+// The text is played from matrix_scan_user as the report queue drains;
+// keys pressed meanwhile are held back and processed after it. Once the
+// buffer fills up, the rest of the text is typed right away, blocking on
+// the endpoint, and the events held back follow it in order.
+#ifndef SNIPPET_DEPTH
+#define SNIPPET_DEPTH 12            // longest trigger
+#endif
+#ifndef SNIPPET_BUFFER_SIZE
+#define SNIPPET_BUFFER_SIZE 8       // key events held back during a text
+#endif
+#ifndef SNIPPET_LEADER_TIMEOUT
+#define SNIPPET_LEADER_TIMEOUT 2000 // ms between the keys of a leader sequence
+#endif
+
+#define SNIPPET_TYPED       (1 << 0)
+
+typedef struct {
+  const char *trigger;
+  const char *text;
+  uint8_t flags;
+} snippet_t;
+
+// Defined by the keymap, in PROGMEM
+extern const snippet_t snippets[];
+extern const uint8_t snippet_count;
+
+// Trie cell: children at base + symbol, the parent state in check
+typedef struct {
+  uint16_t base;              // 0 without children
+  uint16_t check;
+  uint8_t snippet;            // index + 1 of the snippet whose trigger ends here
+} snippet_cell_t;
+
+#define SNIPPET_ROOT        0
+#define SNIPPET_NO_STATE    0xFFFF
+
+// Characters given to process_snippets for keys that type none
+#define SNIPPET_NO_CHAR     0x00    // drops the match, e.g. arrows, Escape, shortcuts
+#define SNIPPET_OTHER_CHAR  0x80    // a character no trigger has, e.g. a glyph
+#define SNIPPET_MODIFIER    0xFF    // modifiers and layer keys, ignored
+
+typedef struct {
+  uint16_t expansions;
+  uint16_t held_back;         // key events processed after a text
+  uint16_t overflows;         // texts finished blocking with the buffer full
+} snippet_stats_t;
+
+extern snippet_stats_t snippet_stats;
+
+// State after typing character in state, SNIPPET_NO_STATE if no trigger
+// continues that way
+uint16_t snippet_next(uint16_t state, uint8_t character);
+// ASCII character of a basic or Shift-wrapped keycode on the U.S. layout,
+// Backspace as '\b'. SNIPPET_NO_CHAR for other keys.
+uint8_t snippet_keycode_char(uint16_t keycode, bool shifted);
+
+// Start a leader sequence
+void snippet_leader(void);
+// Run first in process_record_user for every key event, with the character
+// the key types. Returns false for events it consumes or holds back.
+bool process_snippets(uint8_t character, keyrecord_t *record);
+// Play the text being expanded, from matrix_scan_user
+void snippet_task(void);
+// Drop the match, a leader sequence, the text being typed and the events
+// held back, and clear the statistics
+void snippet_reset(void);
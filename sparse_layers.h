@@ -0,0 +1,48 @@
+// Sparse encoding of the layers LAYER_IS_SPARSE() names, see keymap_sparse.h.
+// Generated by `make -C sim layers` from keymaps[] in keymap.c.
+#pragma once
+
+static const uint16_t PROGMEM sparse_keycodes[] = {
+  // layer 3
+  0x5d50, 0x5d4b, 0x5d46, 0x5d41, 0x5d4e, 0x5d49, 0x5d44, 0x5d3f,
+  0x5d4d, 0x5d48, 0x5d43, 0x5d3e, 0x5d4f, 0x5d4a, 0x5d45, 0x5d40,
+  0x5d51, 0x5d4c, 0x5d47, 0x5d42, 0x0000, 0x0000, 0x0000, 0x5d57,
+  0x5d58, 0x0000, 0x0000, 0x5d5a, 0x5d54, 0x0000, 0x0000, 0x5d59,
+  0x5d53, 0x0000, 0x0000, 0x5d56, 0x5d55, 0x0000, 0x0000, 0x5d52,
+  0x0000, 0x0000, 0x0000, 0x0000,
+  // layer 4
+  0x5d5f, 0x0000, 0x5d6e, 0x5d78, 0x5d5e, 0x5d66, 0x5d6d, 0x5d77,
+  0x5d5d, 0x0000, 0x5d6c, 0x5d76, 0x5d5c, 0x5d65, 0x5d6b, 0x5d75,
+  0x5d5b, 0x0000, 0x5d6a, 0x5d74, 0x0000, 0x0000, 0x5d60, 0x5d67,
+  0x5d6f, 0x5d79, 0x5d61, 0x0000, 0x5d70, 0x5d7a, 0x5d62, 0x0000,
+  0x5d71, 0x5d7b, 0x5d63, 0x0000, 0x5d72, 0x5d7c, 0x5d64, 0x5d68,
+  0x5d73, 0x5d7d, 0x0000, 0x5d69,
+  // layer 6
+  0x0044, 0x003e, 0x003d, 0x5d81, 0x003c, 0x5d80, 0x003b, 0x5d7f,
+  0x5d84, 0x003a, 0x5d7e, 0x5d83, 0x00bc, 0x00ae, 0x00bb, 0x0045,
+  0x003f, 0x0040, 0x0041, 0x0042, 0x0043, 0x00a9, 0x00aa, 0x00a8,
+};
+
+static const sparse_layer_t PROGMEM sparse_layers[SPARSE_LAYER_COUNT] = {
+  // layer 3: 44 keycodes, the rest 0x0001
+  {
+    .fill = 0x0001,
+    .base = 0,
+    .columns = { 0x00, 0x00, 0x00, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x03, 0x00, 0x00, 0x00, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x03 },
+    .offsets = { 0, 0, 0, 0, 4, 8, 12, 16, 20, 22, 22, 22, 22, 26, 30, 34, 38, 42 },
+  },
+  // layer 4: 44 keycodes, the rest 0x0001
+  {
+    .fill = 0x0001,
+    .base = 44,
+    .columns = { 0x00, 0x00, 0x00, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x03, 0x00, 0x00, 0x00, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x03 },
+    .offsets = { 0, 0, 0, 0, 4, 8, 12, 16, 20, 22, 22, 22, 22, 26, 30, 34, 38, 42 },
+  },
+  // layer 6: 24 keycodes, the rest 0x0001
+  {
+    .fill = 0x0001,
+    .base = 88,
+    .columns = { 0x00, 0x00, 0x01, 0x01, 0x03, 0x03, 0x07, 0x07, 0x07, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x07 },
+    .offsets = { 0, 0, 0, 1, 2, 4, 6, 9, 12, 15, 15, 15, 16, 17, 18, 19, 20, 21 },
+  },
+};
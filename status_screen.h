@@ -0,0 +1,49 @@
+#pragma once
+
+#include "layers.h"
+#include "host_profile.h"
+
+// Layout of the LCD, 128x32 pixels. The label of the top layer fills the
+// upper half, the two status lines below are made of cells:
+//
+//   +--------------------------------+
+//   | NEO: 4                         |   layer label, 16 rows
+//   |                                |
+//   | 1  3  4  QW 5  6  FN           |   layer stack, active ones inverted
+//   | C S A G   CAPS    LINUX        |   held modifiers inverted, Caps Lock
+//   +--------------------------------+   and the host profile
+//
+// visualizer.c redraws a region only when what it shows changes. It renders
+// the labels and cells into RAM once at startup, with the DejaVu Sans Bold 12
+// and fixed 5x8 fonts the visualizer opens, and blits them from there.
+
+#define LAYER_LABEL_WIDTH       128
+#define LAYER_LABEL_HEIGHT      16
+#define LAYER_LABEL_Y           0
+
+#define STATUS_CELL_HEIGHT      8
+#define STATUS_CELL_WIDTH_LAYER 18
+#define STATUS_CELL_WIDTH_MOD   10
+#define STATUS_CELL_WIDTH_CAPS  28
+#define STATUS_CELL_WIDTH_HOST  56
+#define STATUS_CELL_WIDTH_MAX   STATUS_CELL_WIDTH_HOST
+// Columns of all cells together
+#define STATUS_CELL_COLUMNS     (LAYER_COUNT * STATUS_CELL_WIDTH_LAYER + 4 * STATUS_CELL_WIDTH_MOD + \
+                                 STATUS_CELL_WIDTH_CAPS + HOST_PROFILES * STATUS_CELL_WIDTH_HOST)
+
+enum status_cells {
+  CELL_LAYER,                             // one per layer, by layer ID
+  CELL_MODS = CELL_LAYER + LAYER_COUNT,   // Ctrl, Shift, Alt and GUI, by mod bit
+  CELL_CAPS = CELL_MODS + 4,
+  CELL_HOST,                              // one per host profile
+  STATUS_CELLS = CELL_HOST + HOST_PROFILES
+};
+
+typedef struct {
+  uint8_t x;
+  uint8_t y;
+  uint8_t width;
+  const char* text;                       // centered in the cell
+} status_cell_t;
+
+extern const status_cell_t status_cells[STATUS_CELLS];
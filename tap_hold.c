@@ -0,0 +1,201 @@
+#include <string.h>
+#include "tap_hold.h"
+#include "report_stream.h"
+#include "latency_stats.h"
+#include "usage_stats.h"
+#include "recorder.h"
+#include "layer_hold.h"
+#include "debug.h"
+
+tap_hold_stats_t tap_hold_stats;
+
+#define NO_SOURCE_LAYER 0xFF
+
+// The dual-role key waiting for a decision, with its press
+static struct {
+  bool active;
+  uint8_t index;
+  keyrecord_t record;
+} pending;
+
+// Events that came in after the pending press, in order. The release of a
+// key pressed before keeps the layer its press came from, a press of the
+// same key buffered behind it overwrites the source layer cache.
+static struct {
+  keyrecord_t record;
+  uint8_t layer;            // NO_SOURCE_LAYER if the press is buffered too
+} buffer[TAP_HOLD_BUFFER_SIZE];
+static uint8_t buffer_length;
+// Set while the press of a key decided as hold is replayed
+static bool replaying_hold;
+
+static void decide(void);
+
+static bool same_key(keypos_t a, keypos_t b) {
+  return a.row == b.row && a.col == b.col;
+}
+
+static int8_t find_tap_hold_key(uint16_t keycode) {
+  for (uint8_t i = 0; i < tap_hold_key_count; i++) {
+    if (pgm_read_word(&tap_hold_keys[i].keycode) == keycode) return i;
+  }
+  return -1;
+}
+
+// Whether the first count buffered events press the key
+static bool buffered_press(keypos_t key, uint8_t count) {
+  for (uint8_t i = 0; i < count; i++) {
+    if (buffer[i].record.event.pressed && same_key(buffer[i].record.event.key, key)) return true;
+  }
+  return false;
+}
+
+static void buffer_remove(uint8_t index) {
+  buffer_length--;
+  memmove(&buffer[index], &buffer[index + 1], (buffer_length - index) * sizeof(buffer[0]));
+}
+
+// Process the buffered events until they are used up or one of them is the
+// press of another dual-role key, which then decides on the rest.
+static void replay(void) {
+  while (buffer_length > 0 && !pending.active) {
+    keyrecord_t record = buffer[0].record;
+
+    if (buffer[0].layer != NO_SOURCE_LAYER) {
+      update_source_layers_cache(record.event.key, buffer[0].layer);
+    }
+    buffer_remove(0);
+    tap_hold_stats.replayed++;
+    process_record(&record);
+  }
+  if (pending.active) {
+    decide();
+  }
+}
+
+static void resolve_hold(void) {
+  pending.active = false;
+  tap_hold_stats.holds++;
+
+  replaying_hold = true;
+  process_record(&pending.record);
+  replaying_hold = false;
+  replay();
+}
+
+// The release of the key at release in the buffer ends the tap, neither
+// its press nor its release reach the keymap.
+static void send_tap(uint8_t index) {
+  const tap_hold_key_t *key = &tap_hold_keys[index];
+  bool layer_on = layer_state_is(pgm_read_byte(&key->layer));
+
+  send_keycode_tap(pgm_read_word(layer_on ? &key->layer_tap : &key->tap));
+}
+
+static void resolve_tap(uint8_t release) {
+  pending.active = false;
+  tap_hold_stats.taps++;
+  latency_event(LATENCY_TAP_HOLD, pending.record.event.time);
+  usage_key_press(layer_switch_get_layer(pending.record.event.key), pending.record.event.key);
+  recorder_tap(pending.record.event.key);
+  layer_hold_interrupt();
+
+  send_tap(pending.index);
+  buffer_remove(release);
+  replay();
+}
+
+static void decide(void) {
+  const tap_hold_key_t *key = &tap_hold_keys[pending.index];
+  uint8_t term = pgm_read_byte(&key->term);
+  bool permissive = pgm_read_byte(&key->flags) & TAP_HOLD_PERMISSIVE;
+
+  for (uint8_t i = 0; i < buffer_length; i++) {
+    const keyevent_t *event = &buffer[i].record.event;
+
+    if ((uint16_t)(event->time - pending.record.event.time) > term) {
+      resolve_hold();
+      return;
+    }
+    if (event->pressed) {
+      continue;
+    }
+    if (same_key(event->key, pending.record.event.key)) {
+      resolve_tap(i);
+      return;
+    }
+    // Releases of keys that went down before the dual-role key only wait
+    // in the buffer to keep their order
+    if (permissive && buffered_press(event->key, i)) {
+      tap_hold_stats.early_holds++;
+      resolve_hold();
+      return;
+    }
+  }
+}
+
+bool process_tap_hold(uint16_t keycode, keyrecord_t *record) {
+  if (!pending.active) {
+    if (!record->event.pressed) {
+      return true;
+    }
+    if (replaying_hold) {
+      replaying_hold = false;
+      return true;
+    }
+
+    int8_t index = find_tap_hold_key(keycode);
+    if (index < 0) {
+      return true;
+    }
+    pending.active = true;
+    pending.index = index;
+    pending.record = *record;
+    return false;
+  }
+
+  // Keys that went down before the dual-role key do not take part, their
+  // releases only queue up behind events held back already
+  if (!record->event.pressed && !same_key(record->event.key, pending.record.event.key) &&
+      buffer_length == 0) {
+    return true;
+  }
+
+  if (buffer_length == TAP_HOLD_BUFFER_SIZE) {
+    dprintf("tap-hold buffer full\n");
+    resolve_hold();
+  }
+  buffer[buffer_length].record = *record;
+  buffer[buffer_length].layer = record->event.pressed || buffered_press(record->event.key, buffer_length)
+                                ? NO_SOURCE_LAYER : read_source_layers_cache(record->event.key);
+  buffer_length++;
+  if (pending.active) {
+    decide();
+  } else {
+    replay();
+  }
+  return false;
+}
+
+void tap_hold_task(void) {
+  // Event times have their lowest bit set, so that 0 means no event
+  uint16_t elapsed = (timer_read() | 1) - pending.record.event.time;
+
+  if (pending.active && elapsed > pgm_read_byte(&tap_hold_keys[pending.index].term)) {
+    resolve_hold();
+  }
+}
+
+bool tap_hold_tap(uint16_t keycode) {
+  int8_t index = find_tap_hold_key(keycode);
+
+  if (index < 0) {
+    return false;
+  }
+  send_tap(index);
+  return true;
+}
+
+bool tap_hold_pending(void) {
+  return pending.active;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "quantum.h"
+
+// Dual-role keys: a tap sends a keycode, a hold is the key's own keycode,
+// processed by the keymap as usual once the engine has decided.
+//
+// From the press of a dual-role key until the decision, the events of keys
+// pressed after it are held back in a small buffer. The key is a hold once
+// it is down longer than its tapping term or, with TAP_HOLD_PERMISSIVE, as
+// soon as another key is pressed and released while it is down. It is a tap
+// when it is released before that. The buffered events are then replayed
+// through process_record(), so they resolve on the layers the decision left.
+#ifndef TAP_HOLD_BUFFER_SIZE
+#define TAP_HOLD_BUFFER_SIZE 8
+#endif
+
+#define TAP_HOLD_PERMISSIVE   (1 << 0)
+
+typedef struct {
+  uint16_t keycode;     // dual-role keycode as used in keymaps[]
+  uint16_t tap;         // basic or mod-wrapped keycode sent on tap
+  uint16_t layer_tap;   // sent on tap instead while layer is already on
+  uint8_t layer;
+  uint8_t term;         // ms
+  uint8_t flags;
+} tap_hold_key_t;
+
+// Defined by the keymap, in PROGMEM
+extern const tap_hold_key_t tap_hold_keys[];
+extern const uint8_t tap_hold_key_count;
+
+typedef struct {
+  uint16_t taps;
+  uint16_t holds;
+  uint16_t early_holds;   // decided by TAP_HOLD_PERMISSIVE before the term
+  uint16_t replayed;      // events held back and replayed
+} tap_hold_stats_t;
+
+extern tap_hold_stats_t tap_hold_stats;
+
+// Run first in process_record_user. Returns false for events the engine
+// holds back or consumes.
+bool process_tap_hold(uint16_t keycode, keyrecord_t *record);
+// Decide keys held past their tapping term, from matrix_scan_user.
+void tap_hold_task(void);
+// Whether a dual-role key waits for its decision, holding events back
+bool tap_hold_pending(void);
+// Send what a tap of the dual-role keycode sends with the current layers,
+// as for a key decided as tap. Returns false if it is not a dual-role key.
+bool tap_hold_tap(uint16_t keycode);
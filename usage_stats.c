@@ -0,0 +1,58 @@
+#include <string.h>
+#include "usage_stats.h"
+
+uint16_t usage_keys[LAYER_COUNT][MATRIX_ROWS][MATRIX_COLS];
+uint16_t usage_macros[USAGE_MACROS];
+usage_layer_t usage_layers[LAYER_COUNT];
+
+static uint32_t usage_state;
+static uint32_t layer_since[LAYER_COUNT];
+
+#define SATURATING_INCREMENT(counter) do { if ((counter) < 0xFFFF) (counter)++; } while (0)
+
+void usage_key_press(uint8_t layer, keypos_t key) {
+  if (layer < LAYER_COUNT) {
+    SATURATING_INCREMENT(usage_keys[layer][key.row][key.col]);
+  }
+}
+
+void usage_macro(uint8_t index) {
+  if (index < USAGE_MACROS) {
+    SATURATING_INCREMENT(usage_macros[index]);
+  }
+}
+
+void usage_layer_state(uint32_t state) {
+  uint32_t changed = state ^ usage_state;
+  uint32_t now = timer_read32();
+
+  for (uint8_t layer = 0; layer < LAYER_COUNT; layer++) {
+    if (!(changed & (1UL << layer))) continue;
+
+    if (state & (1UL << layer)) {
+      SATURATING_INCREMENT(usage_layers[layer].activations);
+      layer_since[layer] = now;
+    } else {
+      usage_layers[layer].dwell_ms += now - layer_since[layer];
+    }
+  }
+  usage_state = state;
+}
+
+uint32_t usage_layer_dwell(uint8_t layer) {
+  uint32_t dwell = usage_layers[layer].dwell_ms;
+
+  if (usage_state & (1UL << layer)) {
+    dwell += timer_read32() - layer_since[layer];
+  }
+  return dwell;
+}
+
+void usage_reset(void) {
+  memset(usage_keys, 0, sizeof(usage_keys));
+  memset(usage_macros, 0, sizeof(usage_macros));
+  memset(usage_layers, 0, sizeof(usage_layers));
+  for (uint8_t layer = 0; layer < LAYER_COUNT; layer++) {
+    layer_since[layer] = timer_read32();
+  }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include QMK_KEYBOARD_H
+#include "layers.h"
+
+// Usage counters, built with USAGE_STATS_ENABLE (see rules.mk) and read out
+// over raw HID (hid_commands.h). All counters saturate instead of wrapping.
+//
+// Key presses are counted per matrix position and the layer they resolved
+// on, macros per index given by the keymap, layers by how often they were
+// turned on and how long they stayed on.
+#ifndef USAGE_MACROS
+#define USAGE_MACROS 208   // two per glyph of the keymap
+#endif
+
+typedef struct {
+  uint16_t activations;
+  uint32_t dwell_ms;    // time spent on, until the last time it turned off
+} usage_layer_t;
+
+extern uint16_t usage_keys[LAYER_COUNT][MATRIX_ROWS][MATRIX_COLS];
+extern uint16_t usage_macros[USAGE_MACROS];
+extern usage_layer_t usage_layers[LAYER_COUNT];
+
+#ifdef USAGE_STATS_ENABLE
+void usage_key_press(uint8_t layer, keypos_t key);
+void usage_macro(uint8_t index);
+// Call on every layer_state change with the new state.
+void usage_layer_state(uint32_t state);
+// Dwell time including the current stretch if the layer is on
+uint32_t usage_layer_dwell(uint8_t layer);
+void usage_reset(void);
+#else
+#define usage_key_press(layer, key)
+#define usage_macro(index)
+#define usage_layer_state(state)
+#endif
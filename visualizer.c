@@ -1,47 +1,336 @@
-#include "simple_visualizer.h"
+#include "visualizer.h"
+#include "visualizer_keyframes.h"
+#include "lcd_backlight_keyframes.h"
+#include "lcd_backlight.h"
+#include "default_animations.h"
 #include "layers.h"
+#include "status_screen.h"
+#include "mcufont.h"
 #include "util.h"
 
+typedef struct {
+  const char* text;
+  uint32_t color;
+} layer_presentation_t;
+
+// Text and LCD color for each layer, indexed by the IDs in layers.h
+static const layer_presentation_t layer_presentations[LAYER_COUNT] = {
+  // #EEEEEE / hsv(0%, 0%, 93%)
+  [NEO_1] = { "NEO: 1", LCD_COLOR(0, 0, 255) },
+  // #93D2F4 / hsv(55.84%, 39.75%, 95.69%)
+  [NEO_3] = { "NEO: 3", LCD_COLOR(143, 102, 245) },
+  // #8EEBC9 / hsv(43.91%, 39.57%, 92.16%)
+  [NEO_4] = { "NEO: 4", LCD_COLOR(112, 101, 189) },
+  // #C6F493 / hsv(24.57%, 39.75%, 95.69%)
+  [NEO_5] = { "NEO: 5", LCD_COLOR(63, 102, 245) },
+  // #F4E393 / hsv(13.75%, 39.75%, 95.69%)
+  [NEO_6] = { "NEO: 6", LCD_COLOR(35, 102, 245) },
+  // #F4B993 / hsv(6.53%, 39.75%, 95.69%)
+  [US_1]  = { "QWERTY", LCD_COLOR(17, 102, 245) },
+  // #F4AEDC / hsv(89.05%, 28.69%, 95.69%)
+  [FKEYS] = { "FUNCTION KEYS", LCD_COLOR(228, 73, 245) },
+};
+
+// Cells of the status lines, see status_screen.h
+const status_cell_t status_cells[STATUS_CELLS] = {
+  [CELL_LAYER + NEO_1]          = {   0, 16, STATUS_CELL_WIDTH_LAYER, "1" },
+  [CELL_LAYER + NEO_3]          = {  18, 16, STATUS_CELL_WIDTH_LAYER, "3" },
+  [CELL_LAYER + NEO_4]          = {  36, 16, STATUS_CELL_WIDTH_LAYER, "4" },
+  [CELL_LAYER + US_1]           = {  54, 16, STATUS_CELL_WIDTH_LAYER, "QW" },
+  [CELL_LAYER + NEO_5]          = {  72, 16, STATUS_CELL_WIDTH_LAYER, "5" },
+  [CELL_LAYER + NEO_6]          = {  90, 16, STATUS_CELL_WIDTH_LAYER, "6" },
+  [CELL_LAYER + FKEYS]          = { 108, 16, STATUS_CELL_WIDTH_LAYER, "FN" },
+  [CELL_MODS + 0]               = {   0, 24, STATUS_CELL_WIDTH_MOD, "C" },
+  [CELL_MODS + 1]               = {  10, 24, STATUS_CELL_WIDTH_MOD, "S" },
+  [CELL_MODS + 2]               = {  20, 24, STATUS_CELL_WIDTH_MOD, "A" },
+  [CELL_MODS + 3]               = {  30, 24, STATUS_CELL_WIDTH_MOD, "G" },
+  [CELL_CAPS]                   = {  44, 24, STATUS_CELL_WIDTH_CAPS, "CAPS" },
+  [CELL_HOST + HOST_MACOS]      = {  72, 24, STATUS_CELL_WIDTH_HOST, "MACOS" },
+  [CELL_HOST + HOST_MACOS_HEX]  = {  72, 24, STATUS_CELL_WIDTH_HOST, "MAC HEX" },
+  [CELL_HOST + HOST_LINUX]      = {  72, 24, STATUS_CELL_WIDTH_HOST, "LINUX" },
+  [CELL_HOST + HOST_WINDOWS]    = {  72, 24, STATUS_CELL_WIDTH_HOST, "WINDOWS" },
+};
+
+enum status_regions {
+  REGION_LABEL,
+  REGION_LAYERS,
+  REGION_MODS,
+  REGION_CAPS,
+  REGION_HOST,
+  STATUS_REGIONS
+};
+
+enum cell_styles {
+  CELL_PLAIN,
+  CELL_INVERTED,
+  CELL_BLANK,
+};
+
+static const uint32_t initial_color = LCD_COLOR(0, 0, 0);
+
+static bool initial_update = true;
+
+// Layer whose text and color were applied last
+static uint8_t applied_layer;
+
+// What each region showed when it was drawn last, and the regions to draw
+// whatever they show
+static uint32_t drawn[STATUS_REGIONS];
+static uint8_t stale_regions;
+
+// Labels, one bit per pixel, most significant bit left, and the cells, one
+// byte per column, least significant bit on top. Rendered once by
+// render_labels(), 2.2 kB of RAM.
+static uint8_t layer_labels[LAYER_COUNT][LAYER_LABEL_HEIGHT][LAYER_LABEL_WIDTH / 8];
+static uint8_t status_cell_columns[STATUS_CELL_COLUMNS];
+static uint16_t status_cell_offsets[STATUS_CELLS];
+static bool labels_rendered;
+
+static pixel_t cell_pixels[STATUS_CELL_WIDTH_MAX * STATUS_CELL_HEIGHT];
+
+// Where render_text() puts the pixels of the font renderer
+typedef struct {
+  font_t font;
+  uint8_t* bits;
+  coord_t width;
+  coord_t height;
+  bool columns;             // one byte per column rather than per 8 pixels of a row
+} text_target_t;
+
+static void render_run(int16_t x, int16_t y, uint8_t count, uint8_t alpha, void* state) {
+  text_target_t* target = state;
+
+  // gdisp draws text without anti-aliasing, only opaque pixels
+  if (alpha != 255 || y < 0 || y >= target->height) {
+    return;
+  }
+  for (; count; count--, x++) {
+    if (x < 0 || x >= target->width) {
+      continue;
+    }
+    if (target->columns) {
+      target->bits[x] |= 1 << y;
+    } else {
+      target->bits[y * (target->width / 8) + x / 8] |= 0x80 >> (x % 8);
+    }
+  }
+}
+
+static uint8_t render_character(int16_t x, int16_t y, mf_char character, void* state) {
+  return mf_render_character(((text_target_t*)state)->font, x, y, character, render_run, state);
+}
+
+// Render text the way gdispDrawString() draws it at x, y
+static void render_text(text_target_t* target, coord_t x, coord_t y, const char* text) {
+  mf_render_aligned(target->font, x + target->font->baseline_x, y, MF_ALIGN_LEFT, text, 0,
+                    render_character, target);
+}
+
+// Render the layer texts, vertically centered, and the cell texts, centered
+// in their cells, with the fonts of the old text path
+static void render_labels(visualizer_state_t* state) {
+  uint16_t offset = 0;
+
+  for (uint8_t layer = 0; layer < LAYER_COUNT; layer++) {
+    text_target_t target = {
+      state->font_dejavusansbold12, layer_labels[layer][0], LAYER_LABEL_WIDTH, LAYER_LABEL_HEIGHT, false
+    };
+
+    render_text(&target, 0, (LAYER_LABEL_HEIGHT - target.font->height) / 2, layer_presentations[layer].text);
+  }
+  for (uint8_t cell = 0; cell < STATUS_CELLS; cell++) {
+    const status_cell_t* c = &status_cells[cell];
+    text_target_t target = {
+      state->font_fixed5x8, &status_cell_columns[offset], c->width, STATUS_CELL_HEIGHT, true
+    };
+
+    render_text(&target, (c->width - mf_get_string_width(target.font, c->text, 0, false)) / 2,
+                (STATUS_CELL_HEIGHT - target.font->height) / 2, c->text);
+    status_cell_offsets[cell] = offset;
+    offset += c->width;
+  }
+  labels_rendered = true;
+}
+
+// Blit the label of the applied layer, one row at a time. The label covers
+// its band completely.
+static void draw_label(void) {
+  pixel_t row[LAYER_LABEL_WIDTH];
+
+  for (uint8_t y = 0; y < LAYER_LABEL_HEIGHT; y++) {
+    const uint8_t* bits = layer_labels[applied_layer][y];
+
+    for (uint8_t x = 0; x < LAYER_LABEL_WIDTH; x++) {
+      row[x] = (bits[x / 8] & (0x80 >> (x % 8))) ? Black : White;
+    }
+    gdispBlitArea(0, LAYER_LABEL_Y + y, LAYER_LABEL_WIDTH, 1, row);
+  }
+}
+
+// Blit a cell in one call, or clear it
+static void draw_cell(uint8_t cell, uint8_t style) {
+  const status_cell_t* c = &status_cells[cell];
+  const uint8_t* columns = &status_cell_columns[status_cell_offsets[cell]];
+
+  if (style == CELL_BLANK) {
+    gdispFillArea(c->x, c->y, c->width, STATUS_CELL_HEIGHT, White);
+    return;
+  }
+  for (uint8_t x = 0; x < c->width; x++) {
+    uint8_t bits = columns[x];
+
+    if (style == CELL_INVERTED) {
+      bits = ~bits;
+    }
+    for (uint8_t y = 0; y < STATUS_CELL_HEIGHT; y++) {
+      cell_pixels[y * c->width + x] = (bits & (1 << y)) ? Black : White;
+    }
+  }
+  gdispBlitArea(c->x, c->y, c->width, STATUS_CELL_HEIGHT, cell_pixels);
+}
+
+// Draw the cells of a region whose bits changed, inverted where set
+static void draw_cells(uint8_t first, uint8_t count, uint32_t shown, uint32_t changed) {
+  for (uint8_t i = 0; i < count; i++) {
+    if (changed & (1UL << i)) {
+      draw_cell(first + i, (shown & (1UL << i)) ? CELL_INVERTED : CELL_PLAIN);
+    }
+  }
+}
+
+// What a region shows for the state. Left and right modifiers share a cell.
+static uint32_t region_input(uint8_t region, visualizer_state_t* state) {
+  switch (region) {
+    case REGION_LABEL:
+      return applied_layer;
+    case REGION_LAYERS:
+      return state->status.layer & ((1UL << LAYER_COUNT) - 1);
+    case REGION_MODS:
+      return (state->status.mods | state->status.mods >> 4) & 0x0F;
+    case REGION_CAPS:
+      return (state->status.leds >> USB_LED_CAPS_LOCK) & 1;
+    case REGION_HOST:
+      return state->status.user_data[0] < HOST_PROFILES ? state->status.user_data[0] : HOST_MACOS;
+  }
+  return 0;
+}
+
+// Redraw the regions whose input changed since they were drawn. Holding
+// MOD3 over a locked NEO_4 blits one cell of the layer stack, the label of
+// the top layer stays.
+static bool keyframe_display_status(keyframe_animation_t* animation, visualizer_state_t* state) {
+  (void)animation;
+
+  for (uint8_t region = 0; region < STATUS_REGIONS; region++) {
+    uint32_t shown = region_input(region, state);
+    uint32_t changed = (stale_regions & (1 << region)) ? UINT32_MAX : shown ^ drawn[region];
+
+    if (!changed) {
+      continue;
+    }
+    switch (region) {
+      case REGION_LABEL:
+        draw_label();
+        break;
+      case REGION_LAYERS:
+        draw_cells(CELL_LAYER, LAYER_COUNT, shown, changed);
+        break;
+      case REGION_MODS:
+        draw_cells(CELL_MODS, 4, shown, changed);
+        break;
+      case REGION_CAPS:
+        draw_cell(CELL_CAPS, shown ? CELL_INVERTED : CELL_BLANK);
+        break;
+      case REGION_HOST:
+        draw_cell(CELL_HOST + shown, CELL_PLAIN);
+        break;
+    }
+    drawn[region] = shown;
+  }
+  stale_regions = 0;
+  return false;
+}
+
+static keyframe_animation_t lcd_status_display = {
+  .num_frames = 1,
+  .loop = false,
+  .frame_lengths = {gfxMillisecondsToTicks(0)},
+  .frame_functions = {keyframe_display_status},
+};
+
+// The color animation animates the LCD color when you change layers. The
+// 200 ms no-operation frame keeps the color from changing when a layer is
+// only activated momentarily.
+static keyframe_animation_t color_animation = {
+  .num_frames = 2,
+  .loop = false,
+  .frame_lengths = {gfxMillisecondsToTicks(200), gfxMillisecondsToTicks(500)},
+  .frame_functions = {keyframe_no_operation, keyframe_animate_backlight_color},
+};
+
 static void get_visualizer_layer_and_color(visualizer_state_t* state) {
   uint8_t layer = biton32(state->status.layer);
 
-  // Go from highest to lowest layer to get the right text/color combination.
-  switch(layer) {
-    // #AEB2F4 / hsv(65.71%, 28.69%, 95.69%)
-    case FKEYS:
-      // #F4AEDC / hsv(89.05%, 28.69%, 95.69%)
-      state->layer_text = "FUNCTION KEYS";
-      state->target_lcd_color = LCD_COLOR(228, 73, 245);
-      break;
-    case US_1:
-      // #F4B993 / hsv(6.53%, 39.75%, 95.69%)
-      state->layer_text = "QWERTY";
-      state->target_lcd_color = LCD_COLOR(17, 102, 245);
-      break;
-    case NEO_6:
-      // #F4E393 / hsv(13.75%, 39.75%, 95.69%)
-      state->layer_text = "NEO: 6";
-      state->target_lcd_color = LCD_COLOR(35, 102, 245);
-      break;
-    case NEO_5:
-      // #C6F493 / hsv(24.57%, 39.75%, 95.69%)
-      state->layer_text = "NEO: 5";
-      state->target_lcd_color = LCD_COLOR(63, 102, 245);
-      break;
-    case NEO_4:
-      // #8EEBC9 / hsv(43.91%, 39.57%, 92.16%)
-      state->layer_text = "NEO: 4";
-      state->target_lcd_color = LCD_COLOR(112, 101, 189);
-      break;
-    case NEO_3:
-      // #93D2F4 / hsv(55.84%, 39.75%, 95.69%)
-      state->layer_text = "NEO: 3";
-      state->target_lcd_color = LCD_COLOR(143, 102, 245);
-      break;
-    default:
-      // #EEEEEE / hsv(0%, 0%, 93%)
-      state->layer_text = "NEO: 1";
-      state->target_lcd_color = LCD_COLOR(0, 0, 255);
-      break;
+  if (layer >= LAYER_COUNT) {
+    layer = NEO_1;
   }
+
+  // Nothing to do while the layer stays the same. A freshly initialized
+  // state has no text yet and always gets one.
+  if (layer == applied_layer && state->layer_text) {
+    return;
+  }
+
+  applied_layer = layer;
+  state->layer_text = layer_presentations[layer].text;
+  state->target_lcd_color = layer_presentations[layer].color;
+}
+
+void initialize_user_visualizer(visualizer_state_t* state) {
+  if (!labels_rendered) {
+    render_labels(state);
+  }
+  lcd_backlight_brightness(130);
+  state->current_lcd_color = initial_color;
+  state->target_lcd_color = LCD_COLOR(0x00, 0x00, 0xFF);
+  initial_update = true;
+  start_keyframe_animation(&default_startup_animation);
+}
+
+void update_user_visualizer_state(visualizer_state_t* state, visualizer_keyboard_status_t* prev_status) {
+  (void)prev_status;
+  uint32_t prev_color = state->target_lcd_color;
+  const char* prev_layer_text = state->layer_text;
+
+  get_visualizer_layer_and_color(state);
+
+  if (initial_update || prev_color != state->target_lcd_color) {
+    start_keyframe_animation(&color_animation);
+  }
+
+  if (initial_update) {
+    stale_regions = 0xFF;
+  } else if (prev_layer_text != state->layer_text) {
+    stale_regions |= 1 << REGION_LABEL;
+  }
+  // Every status change may concern the screen, the frame only draws the
+  // regions it changed
+  start_keyframe_animation(&lcd_status_display);
+
+  initial_update = false;
+}
+
+void user_visualizer_suspend(visualizer_state_t* state) {
+  state->layer_text = "Suspending...";
+  uint8_t hue = LCD_HUE(state->current_lcd_color);
+  uint8_t sat = LCD_SAT(state->current_lcd_color);
+  state->target_lcd_color = LCD_COLOR(hue, sat, 0);
+  start_keyframe_animation(&default_suspend_animation);
+}
+
+void user_visualizer_resume(visualizer_state_t* state) {
+  state->current_lcd_color = initial_color;
+  state->target_lcd_color = LCD_COLOR(0x00, 0x00, 0xFF);
+  initial_update = true;
+  start_keyframe_animation(&default_startup_animation);
 }